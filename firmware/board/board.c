@@ -220,7 +220,8 @@ bool sdc_lld_is_card_inserted(SDCDriver *sdcp) {
     static bool last_status = false;
 
     if (blkIsTransferring(sdcp)) return last_status;
-    return last_status = (bool)palReadPad(GPIOC, GPIOC_SD_D3);
+    /* The card detect switch closes to ground, against the pull-up.*/
+    return last_status = (palReadPad(GPIOD, GPIOD_SDIO_CD) == PAL_LOW);
 }
 
 /**
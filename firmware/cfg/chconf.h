@@ -805,9 +805,18 @@
  * @details This hook is invoked in case to a system halting error before
  *          the system is halted.
  */
+#if defined(TRACE_ENABLE) && (TRACE_ENABLE == TRUE)
+#define CH_CFG_SYSTEM_HALT_HOOK(reason)                                                                                \
+    {                                                                                                                  \
+        /* Keep the most recent trace events in backup SRAM, for inspection after the reset. */                        \
+        extern void trace_save_post_mortem(const char* p_reason);                                                      \
+        trace_save_post_mortem(reason);                                                                                \
+    }
+#else
 #define CH_CFG_SYSTEM_HALT_HOOK(reason)                                                                                \
     { /* System halt code here.*/                                                                                      \
     }
+#endif
 
 /**
  * @brief   Trace hook.
@@ -41,6 +41,76 @@
 /* Fixed settings mandated by the ChibiOS integration.*/
 #include "static_lwipopts.h"
 
+/*
+   ---------------------------------------
+   ---------- Network profiles -----------
+   ---------------------------------------
+*/
+
+/**
+ * NETWORK_PROFILE_BULK==1: Size windows, buffers and pools for sustained bulk
+ * transfers (memory dumps, trace streaming), instead of for low memory use.
+ * Selected with USE_NETWORK_PROFILE=bulk in the Makefile.
+ *
+ * The pools stay in CCM (see LWIP_DECLARE_MEMORY_ALIGNED), where the pbuf
+ * pool can only grow by a few buffers next to the stacks and the trace ring
+ * (check with "make memory_report"). The heap, which holds the copies of sent
+ * data (TCP_SND_BUF), moves to SRAM (see g_network_lwip_heap in network.c).
+ *
+ * The sizes follow the lwIP sizing rules, and are not validated by throughput
+ * measurements yet - compare both profiles with the TCP benchmark service
+ * (NETWORK_BENCHMARK_TCP_PORT) first.
+ */
+#ifndef NETWORK_PROFILE_BULK
+#define NETWORK_PROFILE_BULK 0
+#endif
+
+#if NETWORK_PROFILE_BULK
+#define TCP_WND               (8 * TCP_MSS)
+#define TCP_SND_BUF           (8 * TCP_MSS)
+#define MEM_SIZE              (TCP_SND_BUF + 4096)
+#define PBUF_POOL_SIZE        18
+#define MEMP_NUM_TCP_SEG      32 /* At least TCP_SND_QUEUELEN. */
+#define MEMP_NUM_NETBUF       8
+#define LWIP_RAM_HEAP_POINTER g_network_lwip_heap
+
+/* The heap size, including the two struct mem headers that lwIP adds. */
+#define NETWORK_LWIP_HEAP_SIZE (MEM_SIZE + 64)
+extern unsigned char g_network_lwip_heap[];
+#endif
+
+/*
+   ---------------------------------------
+   ---------- mDNS responder -------------
+   ---------------------------------------
+*/
+
+/**
+ * LWIP_MDNS_RESPONDER==1: Announce the probe and its services with mDNS and
+ * DNS-SD (see network_mdns.c). Requires IGMP, and a netif client data slot.
+ */
+#ifndef LWIP_MDNS_RESPONDER
+#define LWIP_MDNS_RESPONDER 1
+#endif
+
+#define MDNS_MAX_SERVICES          5 /* GDB, trace, telemetry, power profile and recorder. */
+#define LWIP_NUM_NETIF_CLIENT_DATA 1
+
+/*
+   ---------------------------------------
+   ---------- ChibiOS bindings -----------
+   ---------------------------------------
+*/
+
+/**
+ * LWIP_LINK_POLL_INTERVAL: The interval, in which the lwIP thread polls the
+ * PHY for link changes. The address startup (see network_startup.c) only
+ * begins with link up, so the ChibiOS default of 5 s delays every boot.
+ */
+#ifndef LWIP_LINK_POLL_INTERVAL
+#define LWIP_LINK_POLL_INTERVAL TIME_MS2I(100)
+#endif
+
 /*
    -----------------------------------------------
    ---------- Platform specific locking ----------
@@ -128,6 +198,17 @@
 #define MEM_SIZE 1600
 #endif
 
+/**
+ * LWIP_DECLARE_MEMORY_ALIGNED: Place the heap and the pools in CCM. The CPU
+ * is the only one to access them, as the ChibiOS MAC driver copies frames
+ * between pbufs and its own DMA buffers (MAC_USE_ZERO_COPY == FALSE).
+ */
+#ifndef LWIP_DECLARE_MEMORY_ALIGNED
+#include "common/memory.h"
+#define LWIP_DECLARE_MEMORY_ALIGNED(variable_name, size) \
+    u8_t variable_name[LWIP_MEM_ALIGN_BUFFER(size)] MEMORY_CCM_NOINIT
+#endif
+
 /**
  * MEMP_SEPARATE_POOLS: if defined to 1, each pool is placed in its own array.
  * This can be used to individually change the location of each pool.
@@ -244,7 +325,7 @@
  * (requires the LWIP_TCP option)
  */
 #ifndef MEMP_NUM_TCP_PCB
-#define MEMP_NUM_TCP_PCB 5
+#define MEMP_NUM_TCP_PCB 7
 #endif
 
 /**
@@ -307,7 +388,7 @@
  * (only needed if you use the sequential API, like api_lib.c)
  */
 #ifndef MEMP_NUM_NETBUF
-#define MEMP_NUM_NETBUF 2
+#define MEMP_NUM_NETBUF 4 /* Received datagrams wait in netbufs, next to the replies of telemetry and GDB UDP. */
 #endif
 
 /**
@@ -315,7 +396,9 @@
  * (only needed if you use the sequential API, like api_lib.c)
  */
 #ifndef MEMP_NUM_NETCONN
-#define MEMP_NUM_NETCONN 4
+/* GDB (listener, connection, UDP), telemetry, and listener and connection of trace, benchmark, power profile and
+ * recorder. */
+#define MEMP_NUM_NETCONN 12
 #endif
 
 /**
@@ -336,6 +419,14 @@
 #define MEMP_NUM_TCPIP_MSG_INPKT 8
 #endif
 
+/**
+ * MEMP_NUM_SYS_TIMEOUT: the number of simultaneously active timeouts. One
+ * more than lwIP needs itself, for the DHCP fallback (see network_startup.c).
+ */
+#ifndef MEMP_NUM_SYS_TIMEOUT
+#define MEMP_NUM_SYS_TIMEOUT (LWIP_NUM_SYS_TIMEOUT_INTERNAL + 1)
+#endif
+
 /**
  * MEMP_NUM_SNMP_NODE: the number of leafs in the SNMP tree.
  */
@@ -683,7 +774,7 @@
  * LWIP_AUTOIP==1: Enable AUTOIP module.
  */
 #ifndef LWIP_AUTOIP
-#define LWIP_AUTOIP 0
+#define LWIP_AUTOIP 1
 #endif
 
 /**
@@ -787,7 +878,7 @@
  * LWIP_IGMP==1: Turn on IGMP module.
  */
 #ifndef LWIP_IGMP
-#define LWIP_IGMP 0
+#define LWIP_IGMP 1
 #endif
 
 /*
@@ -1119,7 +1210,7 @@
  * changes its up/down status (i.e., due to DHCP IP acquistion)
  */
 #ifndef LWIP_NETIF_STATUS_CALLBACK
-#define LWIP_NETIF_STATUS_CALLBACK 0
+#define LWIP_NETIF_STATUS_CALLBACK 1
 #endif
 
 /**
@@ -1589,6 +1680,13 @@
 #define SYS_STATS (NO_SYS == 0)
 #endif
 
+/**
+ * MIB2_STATS==1: Stats for SNMP MIB2. Provides the TCP retransmission counter.
+ */
+#ifndef MIB2_STATS
+#define MIB2_STATS 1
+#endif
+
 #else
 
 #define LINK_STATS         0
@@ -1601,6 +1699,7 @@
 #define MEM_STATS          0
 #define MEMP_STATS         0
 #define SYS_STATS          0
+#define MIB2_STATS         0
 #define LWIP_STATS_DISPLAY 0
 
 #endif /* LWIP_STATS */
@@ -1774,53 +1873,62 @@
    ---------- Checksum options ----------
    --------------------------------------
 */
+/**
+ * NETWORK_CHECKSUM_OFFLOAD==1: The Ethernet MAC generates and checks all
+ * checksums (see STM32_MAC_IP_CHECKSUM_OFFLOAD in mcuconf.h), so lwIP skips
+ * them. Selected with USE_CHECKSUM_OFFLOAD in the Makefile.
+ */
+#ifndef NETWORK_CHECKSUM_OFFLOAD
+#define NETWORK_CHECKSUM_OFFLOAD 0
+#endif
+
 /**
  * CHECKSUM_GEN_IP==1: Generate checksums in software for outgoing IP packets.
  */
 #ifndef CHECKSUM_GEN_IP
-#define CHECKSUM_GEN_IP 1
+#define CHECKSUM_GEN_IP (NETWORK_CHECKSUM_OFFLOAD == 0)
 #endif
 
 /**
  * CHECKSUM_GEN_UDP==1: Generate checksums in software for outgoing UDP packets.
  */
 #ifndef CHECKSUM_GEN_UDP
-#define CHECKSUM_GEN_UDP 1
+#define CHECKSUM_GEN_UDP (NETWORK_CHECKSUM_OFFLOAD == 0)
 #endif
 
 /**
  * CHECKSUM_GEN_TCP==1: Generate checksums in software for outgoing TCP packets.
  */
 #ifndef CHECKSUM_GEN_TCP
-#define CHECKSUM_GEN_TCP 1
+#define CHECKSUM_GEN_TCP (NETWORK_CHECKSUM_OFFLOAD == 0)
 #endif
 
 /**
  * CHECKSUM_GEN_ICMP==1: Generate checksums in software for outgoing ICMP packets.
  */
 #ifndef CHECKSUM_GEN_ICMP
-#define CHECKSUM_GEN_ICMP 1
+#define CHECKSUM_GEN_ICMP (NETWORK_CHECKSUM_OFFLOAD == 0)
 #endif
 
 /**
  * CHECKSUM_CHECK_IP==1: Check checksums in software for incoming IP packets.
  */
 #ifndef CHECKSUM_CHECK_IP
-#define CHECKSUM_CHECK_IP 1
+#define CHECKSUM_CHECK_IP (NETWORK_CHECKSUM_OFFLOAD == 0)
 #endif
 
 /**
  * CHECKSUM_CHECK_UDP==1: Check checksums in software for incoming UDP packets.
  */
 #ifndef CHECKSUM_CHECK_UDP
-#define CHECKSUM_CHECK_UDP 1
+#define CHECKSUM_CHECK_UDP (NETWORK_CHECKSUM_OFFLOAD == 0)
 #endif
 
 /**
  * CHECKSUM_CHECK_TCP==1: Check checksums in software for incoming TCP packets.
  */
 #ifndef CHECKSUM_CHECK_TCP
-#define CHECKSUM_CHECK_TCP 1
+#define CHECKSUM_CHECK_TCP (NETWORK_CHECKSUM_OFFLOAD == 0)
 #endif
 
 /**
@@ -40,7 +40,7 @@
 #define STM32_NO_INIT          FALSE
 #define STM32_PVD_ENABLE       FALSE
 #define STM32_PLS              STM32_PLS_LEV0
-#define STM32_BKPRAM_ENABLE    FALSE
+#define STM32_BKPRAM_ENABLE    TRUE
 #define STM32_HSI_ENABLED      TRUE
 #define STM32_LSI_ENABLED      TRUE
 #define STM32_HSE_ENABLED      TRUE
@@ -109,8 +109,8 @@
  * ADC driver system settings.
  */
 #define STM32_ADC_ADCPRE                ADC_CCR_ADCPRE_DIV4
-#define STM32_ADC_USE_ADC1              FALSE
-#define STM32_ADC_USE_ADC2              FALSE
+#define STM32_ADC_USE_ADC1              TRUE
+#define STM32_ADC_USE_ADC2              TRUE
 #define STM32_ADC_USE_ADC3              FALSE
 #define STM32_ADC_ADC1_DMA_STREAM       STM32_DMA_STREAM_ID(2, 4)
 #define STM32_ADC_ADC2_DMA_STREAM       STM32_DMA_STREAM_ID(2, 2)
@@ -149,7 +149,7 @@
  */
 #define STM32_GPT_USE_TIM1  FALSE
 #define STM32_GPT_USE_TIM2  FALSE
-#define STM32_GPT_USE_TIM3  FALSE
+#define STM32_GPT_USE_TIM3  TRUE
 #define STM32_GPT_USE_TIM4  FALSE
 #define STM32_GPT_USE_TIM5  FALSE
 #define STM32_GPT_USE_TIM6  FALSE
@@ -223,7 +223,21 @@
 #define STM32_MAC_PHY_TIMEOUT           100
 #define STM32_MAC_ETH1_CHANGE_PHY_STATE TRUE
 #define STM32_MAC_ETH1_IRQ_PRIORITY     13
-#define STM32_MAC_IP_CHECKSUM_OFFLOAD   0
+
+/*
+ * Checksum offload (mode 3): the MAC inserts the IP header checksum, and the
+ * TCP/UDP/ICMP checksum including the pseudo-header. Selected with
+ * USE_CHECKSUM_OFFLOAD in the Makefile.
+ */
+#if !defined(NETWORK_CHECKSUM_OFFLOAD)
+#define NETWORK_CHECKSUM_OFFLOAD 0
+#endif
+
+#if NETWORK_CHECKSUM_OFFLOAD != 0
+#define STM32_MAC_IP_CHECKSUM_OFFLOAD 3
+#else
+#define STM32_MAC_IP_CHECKSUM_OFFLOAD 0
+#endif
 
 /*
  * PWM driver system settings.
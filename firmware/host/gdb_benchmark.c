@@ -0,0 +1,295 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Throughput benchmarks for the host-built GDB core.
+ * @details Measures packet parsing, command dispatch (through the full session, including reply generation) and hex
+ * conversion. Each benchmark checks the results of its first iteration, such that a broken core cannot produce
+ * numbers. This is the baseline for performance changes to the GDB core.
+ *
+ * @addtogroup host
+ * @{
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common/common.h"
+#include "common/hex.h"
+#include "gdb/gdb.h"
+#include "gdb/gdb_packet.h"
+#include "gdb/gdb_session.h"
+
+/**
+ * @brief The length of binary/hex blocks that are converted or transferred per iteration.
+ */
+#define GDB_BENCHMARK_BLOCK_LENGTH 1024u
+
+/**
+ * @brief The minimum run time of a benchmark in nanoseconds.
+ */
+#define GDB_BENCHMARK_MIN_DURATION_NS 200000000ull
+
+/**
+ * @brief Input data and counters of a benchmark.
+ */
+struct gdb_benchmark_context {
+    char   stream[GDB_PACKET_MAX_BUFFER_LENGTH * 4u];  ///< The input stream to feed.
+    size_t stream_length;                              ///< The length of the input stream.
+
+    uint8_t hex[GDB_BENCHMARK_BLOCK_LENGTH * 2u];  ///< Hex characters for conversion.
+    char    binary[GDB_BENCHMARK_BLOCK_LENGTH];    ///< Binary characters for conversion (without NUL).
+    char    string[GDB_BENCHMARK_BLOCK_LENGTH + 1u];
+
+    size_t reply_length;  ///< The accumulated length of all replies.
+    size_t reply_count;   ///< The number of replies.
+};
+
+/**
+ * @brief A benchmark definition.
+ */
+struct gdb_benchmark {
+    const char* p_name;                              ///< The name of the benchmark.
+    void (*p_setup)(struct gdb_benchmark_context*);  ///< Prepares the context.
+    size_t (*p_run)(struct gdb_benchmark_context*);  ///< Runs one iteration, returns the number of processed bytes.
+    bool (*p_check)(struct gdb_benchmark_context*);  ///< Checks the result of the first iteration.
+};
+
+static struct gdb_benchmark_context g_context;
+
+/**
+ * @brief Get a monotonic time stamp.
+ *
+ * @return uint64_t The time stamp in nanoseconds.
+ */
+static uint64_t gdb_benchmark_get_time_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Append a framed packet ("$payload#checksum") to the input stream of the context.
+ *
+ * @param p_context A pointer to the benchmark context.
+ * @param p_payload A pointer to the NUL-terminated payload.
+ */
+static void gdb_benchmark_append_packet(struct gdb_benchmark_context* p_context, const char* p_payload) {
+    uint8_t checksum = 0u;
+
+    for (const char* p_character = p_payload; *p_character != '\0'; p_character++) {
+        checksum += (uint8_t)*p_character;
+    }
+
+    size_t free_length = sizeof(p_context->stream) - p_context->stream_length;
+    int    length = snprintf(&p_context->stream[p_context->stream_length], free_length, "$%s#%02X", p_payload, checksum);
+
+    ASSERT_VERBOSE((length > 0) && ((size_t)length < free_length), "Benchmark stream overflow.");
+    p_context->stream_length += (size_t)length;
+}
+
+/**
+ * @brief Write callback of the benchmark session - counts the reply bytes.
+ *
+ * @param p_buffer A pointer to the reply buffer.
+ * @param length The length of the reply.
+ * @param b_more True, if more output follows right away (unused).
+ * @return bool Always true.
+ */
+static bool gdb_benchmark_write_cb(char* p_buffer, size_t length, bool b_more) {
+    (void)p_buffer;
+    (void)b_more;
+
+    g_context.reply_length += length;
+    g_context.reply_count++;
+    return true;
+}
+
+/**
+ * @brief Feed the complete input stream into the GDB session.
+ *
+ * @param p_context A pointer to the benchmark context.
+ * @return size_t The number of bytes fed.
+ */
+static size_t gdb_benchmark_feed_session(struct gdb_benchmark_context* p_context) {
+    size_t offset = 0u;
+
+    while (offset < p_context->stream_length) {
+        offset += gdb_session_handle(&p_context->stream[offset], p_context->stream_length - offset);
+    }
+
+    return p_context->stream_length;
+}
+
+static void gdb_benchmark_setup_parse_read(struct gdb_benchmark_context* p_context) {
+    gdb_benchmark_append_packet(p_context, "m20000000,400");
+}
+
+static void gdb_benchmark_setup_parse_write(struct gdb_benchmark_context* p_context) {
+    char payload[GDB_BENCHMARK_BLOCK_LENGTH + 32u];
+    int  prefix_length = snprintf(payload, sizeof(payload), "X20000000,%x:", GDB_BENCHMARK_BLOCK_LENGTH);
+
+    for (size_t index = 0u; index < GDB_BENCHMARK_BLOCK_LENGTH; index++) {
+        // Printable characters only, avoiding all that are special to the packet framing.
+        payload[(size_t)prefix_length + index] = (char)('0' + (index % 43u));
+    }
+    payload[(size_t)prefix_length + GDB_BENCHMARK_BLOCK_LENGTH] = '\0';
+
+    gdb_benchmark_append_packet(p_context, payload);
+}
+
+static size_t gdb_benchmark_run_parse(struct gdb_benchmark_context* p_context) {
+    static struct gdb_packet packet;
+    size_t                   consumed_length = 0u;
+
+    enum gdb_packet_result result =
+        gdb_packet_read_stream(&packet, p_context->stream, p_context->stream_length, &consumed_length);
+
+    p_context->reply_count += (result == GDB_PACKET_RESULT_OK) ? 1u : 0u;
+    return consumed_length;
+}
+
+static bool gdb_benchmark_check_parse(struct gdb_benchmark_context* p_context) {
+    return p_context->reply_count == 1u;
+}
+
+static void gdb_benchmark_setup_dispatch_mixed(struct gdb_benchmark_context* p_context) {
+    gdb_benchmark_append_packet(p_context, "qSupported:multiprocess+;swbreak+;hwbreak+");
+    gdb_benchmark_append_packet(p_context, "Hg0");
+    gdb_benchmark_append_packet(p_context, "qC");
+    gdb_benchmark_append_packet(p_context, "qfThreadInfo");
+    gdb_benchmark_append_packet(p_context, "qsThreadInfo");
+    gdb_benchmark_append_packet(p_context, "?");
+    gdb_benchmark_append_packet(p_context, "m20000000,400");
+    gdb_benchmark_append_packet(p_context, "vMustReplyEmpty");
+}
+
+static void gdb_benchmark_setup_dispatch_monitor(struct gdb_benchmark_context* p_context) {
+    // "help", hex-encoded.
+    gdb_benchmark_append_packet(p_context, "qRcmd,68656c70");
+}
+
+static size_t gdb_benchmark_run_dispatch(struct gdb_benchmark_context* p_context) {
+    return gdb_benchmark_feed_session(p_context);
+}
+
+static bool gdb_benchmark_check_dispatch_mixed(struct gdb_benchmark_context* p_context) {
+    // Every packet is acknowledged, and answered.
+    return p_context->reply_count == 2u * 8u;
+}
+
+static bool gdb_benchmark_check_dispatch_monitor(struct gdb_benchmark_context* p_context) {
+    return (p_context->reply_count == 2u) && (p_context->reply_length > 64u);
+}
+
+static void gdb_benchmark_setup_hex(struct gdb_benchmark_context* p_context) {
+    for (size_t index = 0u; index < GDB_BENCHMARK_BLOCK_LENGTH; index++) {
+        p_context->binary[index] = (char)(index * 7u);
+    }
+
+    hex_from_str(p_context->binary, GDB_BENCHMARK_BLOCK_LENGTH, p_context->hex, sizeof(p_context->hex));
+}
+
+static size_t gdb_benchmark_run_hex_encode(struct gdb_benchmark_context* p_context) {
+    hex_from_str(p_context->binary, GDB_BENCHMARK_BLOCK_LENGTH, p_context->hex, sizeof(p_context->hex));
+    return GDB_BENCHMARK_BLOCK_LENGTH;
+}
+
+static size_t gdb_benchmark_run_hex_decode(struct gdb_benchmark_context* p_context) {
+    str_from_hex(p_context->hex, sizeof(p_context->hex), p_context->string, sizeof(p_context->string));
+    return sizeof(p_context->hex);
+}
+
+static bool gdb_benchmark_check_hex_encode(struct gdb_benchmark_context* p_context) {
+    // 0x07 * 0x25 = 0x103, truncated to 0x03.
+    return (p_context->hex[0] == '0') && (p_context->hex[1] == '0') && (p_context->hex[2 * 0x25] == '0') &&
+           (p_context->hex[2 * 0x25 + 1] == '3');
+}
+
+static bool gdb_benchmark_check_hex_decode(struct gdb_benchmark_context* p_context) {
+    return 0 == memcmp(p_context->string, p_context->binary, GDB_BENCHMARK_BLOCK_LENGTH);
+}
+
+/**
+ * @brief All benchmarks.
+ */
+static const struct gdb_benchmark G_BENCHMARKS[] = {
+    {"parse 'm' packet", gdb_benchmark_setup_parse_read, gdb_benchmark_run_parse, gdb_benchmark_check_parse},
+    {"parse 1k 'X' packet", gdb_benchmark_setup_parse_write, gdb_benchmark_run_parse, gdb_benchmark_check_parse},
+    {"dispatch mixed session", gdb_benchmark_setup_dispatch_mixed, gdb_benchmark_run_dispatch,
+     gdb_benchmark_check_dispatch_mixed},
+    {"dispatch 'monitor help'", gdb_benchmark_setup_dispatch_monitor, gdb_benchmark_run_dispatch,
+     gdb_benchmark_check_dispatch_monitor},
+    {"hex encode 1k", gdb_benchmark_setup_hex, gdb_benchmark_run_hex_encode, gdb_benchmark_check_hex_encode},
+    {"hex decode 1k", gdb_benchmark_setup_hex, gdb_benchmark_run_hex_decode, gdb_benchmark_check_hex_decode},
+};
+
+/**
+ * @brief Run a single benchmark, and print its results.
+ *
+ * @param p_benchmark A pointer to the benchmark.
+ * @return bool True, if the result check passed.
+ */
+static bool gdb_benchmark_run(const struct gdb_benchmark* p_benchmark) {
+    struct gdb_benchmark_context* p_context = &g_context;
+
+    memset(p_context, 0, sizeof(*p_context));
+    p_benchmark->p_setup(p_context);
+
+    p_benchmark->p_run(p_context);
+
+    if (!p_benchmark->p_check(p_context)) {
+        printf("%-28s FAILED\n", p_benchmark->p_name);
+        return false;
+    }
+
+    uint64_t iterations = 0u;
+    uint64_t bytes      = 0u;
+    uint64_t start_ns   = gdb_benchmark_get_time_ns();
+    uint64_t elapsed_ns = 0u;
+
+    do {
+        for (size_t batch_index = 0u; batch_index < 1000u; batch_index++) {
+            bytes += p_benchmark->p_run(p_context);
+        }
+
+        iterations += 1000u;
+        elapsed_ns = gdb_benchmark_get_time_ns() - start_ns;
+    } while (elapsed_ns < GDB_BENCHMARK_MIN_DURATION_NS);
+
+    double ns_per_iteration = (double)elapsed_ns / (double)iterations;
+    double mib_per_second   = ((double)bytes / (1024.0 * 1024.0)) / ((double)elapsed_ns / 1e9);
+
+    printf("%-28s %12" PRIu64 " %12.1f %12.1f\n", p_benchmark->p_name, iterations, ns_per_iteration, mib_per_second);
+    return true;
+}
+
+int main(void) {
+    gdb_session_init();
+
+    if (!gdb_session_lock(GDB_SESSION_TRANSPORT_TCP_IP, gdb_benchmark_write_cb)) {
+        fprintf(stderr, "Failed to lock the GDB session.\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%-28s %12s %12s %12s\n", "benchmark", "iterations", "ns/iter", "MiB/s");
+
+    bool b_success = true;
+
+    for (size_t benchmark_index = 0u; benchmark_index < ARRAY_LENGTH(G_BENCHMARKS); benchmark_index++) {
+        b_success &= gdb_benchmark_run(&G_BENCHMARKS[benchmark_index]);
+    }
+
+    gdb_session_release();
+
+    return b_success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @}
+ */
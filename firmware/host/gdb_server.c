@@ -0,0 +1,408 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   A Linux TCP or UDP front end for the host-built GDB core, serving the simulated target.
+ * @details Serves one GDB client at a time, just like the network module on the probe. Connect with
+ * "target extended-remote localhost:2000", followed by "attach 1".
+ *
+ * With -u, the session is served over UDP like on the probe (see network_gdb_udp.c) - connect through
+ * tools/gdb_udp_relay.py. Datagram loss in both directions is emulated with -l.
+ *
+ * @addtogroup host
+ * @{
+ */
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common/common.h"
+#include "gdb/gdb_session.h"
+#include "perf/perf.h"
+#include "sim_target.h"
+
+#define GDB_SERVER_DEFAULT_PORT   2000u
+#define GDB_SERVER_RECEIVE_LENGTH 4096u
+
+/**
+ * @brief The time without datagrams from the UDP client, after which the session is released (as on the probe).
+ */
+#define GDB_SERVER_UDP_IDLE_TIMEOUT_MS 5000u
+
+/**
+ * @brief The socket of the connected client.
+ */
+static int g_gdb_server_client_socket = -1;
+
+/**
+ * @brief The state of the UDP transport.
+ */
+static struct {
+    int                socket;            ///< The UDP socket.
+    bool               b_active;          ///< True, if a client owns the session.
+    struct sockaddr_in peer;              ///< The address of the client that owns the session.
+    uint64_t           last_receive_ms;   ///< The time of the last datagram from the client.
+    unsigned int       loss_percent;      ///< The emulated datagram loss in percent.
+    uint64_t           dropped_count;     ///< The number of datagrams that were dropped for the loss emulation.
+    size_t             datagram_length;   ///< The length of the pending outgoing datagram.
+    char               datagram[GDB_PACKET_MAX_BUFFER_LENGTH + 1u];  ///< The pending outgoing datagram.
+} g_gdb_server_udp = {.socket = -1};
+
+/**
+ * @brief Write a reply to the connected client.
+ *
+ * @param p_data A pointer to the data to write.
+ * @param length The length of the data.
+ * @param b_more True, if more data follows right away - it is then corked, like on the probe.
+ * @return bool True, if all data was written.
+ */
+static bool gdb_server_write_cb(char* p_data, size_t length, bool b_more) {
+    const int FLAGS = MSG_NOSIGNAL | (b_more ? MSG_MORE : 0);
+
+    while (length > 0u) {
+        ssize_t written = -1;
+        PERF_TRANSMIT(written = send(g_gdb_server_client_socket, p_data, length, FLAGS));
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return false;
+        }
+
+        p_data += written;
+        length -= (size_t)written;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Serve a connected client, until it disconnects.
+ */
+static void gdb_server_serve(void) {
+    char buffer[GDB_SERVER_RECEIVE_LENGTH];
+
+    struct pollfd poll_descriptor = {.fd = g_gdb_server_client_socket, .events = POLLIN};
+
+    while (gdb_session_get_state() == GDB_SESSION_STATE_ACTIVE) {
+        int ready = poll(&poll_descriptor, 1, GDB_SESSION_POLL_INTERVAL_MS);
+
+        if (ready == 0) {
+            gdb_session_poll();
+            continue;
+        }
+
+        if ((ready < 0) && (errno == EINTR)) {
+            continue;
+        }
+
+        ssize_t received = (ready > 0) ? recv(g_gdb_server_client_socket, buffer, sizeof(buffer), 0) : -1;
+
+        if (received <= 0) {
+            return;
+        }
+
+        PERF_MARK(PERF_MARK_RECEIVED);
+
+        size_t total_consumed_length = 0u;
+
+        while ((total_consumed_length < (size_t)received) &&
+               (gdb_session_get_state() == GDB_SESSION_STATE_ACTIVE)) {
+            total_consumed_length +=
+                gdb_session_handle(&buffer[total_consumed_length], (size_t)received - total_consumed_length);
+        }
+    }
+}
+
+/**
+ * @brief Get the monotonic time.
+ *
+ * @return uint64_t The time in milliseconds.
+ */
+static uint64_t gdb_server_get_time_ms(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000ull) + ((uint64_t)now.tv_nsec / 1000000ull);
+}
+
+/**
+ * @brief Decide, if a datagram is lost, for the loss emulation.
+ *
+ * @return bool True, if the datagram is to be dropped.
+ */
+static bool gdb_server_udp_is_lost(void) {
+    if ((g_gdb_server_udp.loss_percent == 0u) || ((unsigned int)(rand() % 100) >= g_gdb_server_udp.loss_percent)) {
+        return false;
+    }
+
+    g_gdb_server_udp.dropped_count++;
+    return true;
+}
+
+/**
+ * @brief Send the pending outgoing datagram to the UDP client.
+ *
+ * @return bool True, if the datagram was sent (or dropped by the loss emulation).
+ */
+static bool gdb_server_udp_send(void) {
+    ssize_t sent = (ssize_t)g_gdb_server_udp.datagram_length;
+
+    if (!gdb_server_udp_is_lost()) {
+        PERF_TRANSMIT(sent = sendto(g_gdb_server_udp.socket, g_gdb_server_udp.datagram,
+                                    g_gdb_server_udp.datagram_length, 0, (struct sockaddr*)&g_gdb_server_udp.peer,
+                                    sizeof(g_gdb_server_udp.peer)));
+    }
+
+    g_gdb_server_udp.datagram_length = 0u;
+    return sent >= 0;
+}
+
+/**
+ * @brief Write a reply to the UDP client. Data that is followed by more right away shares a datagram with it.
+ *
+ * @param p_data A pointer to the data to write.
+ * @param length The length of the data.
+ * @param b_more True, if more data follows right away.
+ * @return bool True, if the data was written.
+ */
+static bool gdb_server_udp_write_cb(char* p_data, size_t length, bool b_more) {
+    bool b_success = true;
+
+    if ((g_gdb_server_udp.datagram_length + length) > sizeof(g_gdb_server_udp.datagram)) {
+        b_success = gdb_server_udp_send();
+    }
+
+    memcpy(&g_gdb_server_udp.datagram[g_gdb_server_udp.datagram_length], p_data, length);
+    g_gdb_server_udp.datagram_length += length;
+
+    if (b_more) {
+        return b_success;
+    }
+
+    return gdb_server_udp_send() && b_success;
+}
+
+/**
+ * @brief Release the session of the UDP client.
+ */
+static void gdb_server_udp_release(void) {
+    if (!g_gdb_server_udp.b_active) {
+        return;
+    }
+
+    gdb_session_release();
+    g_gdb_server_udp.b_active = false;
+
+    printf("UDP session released (%llu datagrams dropped).\n", (unsigned long long)g_gdb_server_udp.dropped_count);
+    fflush(stdout);
+}
+
+/**
+ * @brief Serve a received datagram. The first client locks the session.
+ *
+ * @param p_data A pointer to the datagram.
+ * @param length The length of the datagram.
+ * @param p_peer A pointer to the address of the sender.
+ */
+static void gdb_server_udp_handle(char* p_data, size_t length, const struct sockaddr_in* p_peer) {
+    if (!g_gdb_server_udp.b_active) {
+        if (!gdb_session_lock(GDB_SESSION_TRANSPORT_UDP_IP, gdb_server_udp_write_cb)) {
+            return;
+        }
+
+        g_gdb_server_udp.peer            = *p_peer;
+        g_gdb_server_udp.datagram_length = 0u;
+        g_gdb_server_udp.dropped_count   = 0u;
+        g_gdb_server_udp.b_active        = true;
+    } else if ((p_peer->sin_addr.s_addr != g_gdb_server_udp.peer.sin_addr.s_addr) ||
+               (p_peer->sin_port != g_gdb_server_udp.peer.sin_port)) {
+        return;
+    }
+
+    g_gdb_server_udp.last_receive_ms = gdb_server_get_time_ms();
+    PERF_MARK(PERF_MARK_RECEIVED);
+
+    if ((length == 1u) && (p_data[0u] == GDB_PACKET_CHAR_EOT)) {
+        gdb_server_udp_release();
+        return;
+    }
+
+    size_t total_consumed_length = 0u;
+
+    while ((total_consumed_length < length) && (gdb_session_get_state() == GDB_SESSION_STATE_ACTIVE)) {
+        total_consumed_length += gdb_session_handle(&p_data[total_consumed_length], length - total_consumed_length);
+    }
+
+    if (g_gdb_server_udp.datagram_length > 0u) {
+        // An acknowledgement without a reply yet (e.g. when resuming the target) must not wait for one.
+        (void)gdb_server_udp_send();
+    }
+}
+
+/**
+ * @brief Serve UDP clients, one session at a time.
+ */
+static void gdb_server_serve_udp(void) {
+    char buffer[GDB_SERVER_RECEIVE_LENGTH];
+
+    struct pollfd poll_descriptor = {.fd = g_gdb_server_udp.socket, .events = POLLIN};
+
+    while (true) {
+        int ready = poll(&poll_descriptor, 1, GDB_SESSION_POLL_INTERVAL_MS);
+
+        if ((ready < 0) && (errno == EINTR)) {
+            continue;
+        }
+
+        if (ready <= 0) {
+            if (!g_gdb_server_udp.b_active) {
+                continue;
+            }
+
+            gdb_session_poll();
+
+            if ((gdb_session_get_state() != GDB_SESSION_STATE_ACTIVE) ||
+                ((gdb_server_get_time_ms() - g_gdb_server_udp.last_receive_ms) >= GDB_SERVER_UDP_IDLE_TIMEOUT_MS)) {
+                gdb_server_udp_release();
+            }
+            continue;
+        }
+
+        struct sockaddr_in peer        = {0};
+        socklen_t          peer_length = sizeof(peer);
+        ssize_t received = recvfrom(g_gdb_server_udp.socket, buffer, sizeof(buffer), 0, (struct sockaddr*)&peer,
+                                    &peer_length);
+
+        if ((received < 0) || gdb_server_udp_is_lost()) {
+            continue;
+        }
+
+        gdb_server_udp_handle(buffer, (size_t)received, &peer);
+    }
+}
+
+/**
+ * @brief Print the usage information.
+ *
+ * @param p_name A pointer to the program name.
+ */
+static void gdb_server_print_usage(const char* p_name) {
+    fprintf(stderr,
+            "Usage: %s [-p port] [-a access_latency_us] [-w word_latency_ns] [-e erase_latency_us]\n"
+            "          [-f flash_write_latency_ns] [-r run_time_ms] [-u] [-l loss_percent]\n",
+            p_name);
+}
+
+int main(int argc, char* argv[]) {
+    struct sim_target_config config = {0};
+    uint16_t                 port   = GDB_SERVER_DEFAULT_PORT;
+    bool                     b_udp  = false;
+    int                      option = 0;
+
+    while ((option = getopt(argc, argv, "p:a:w:e:f:r:ul:h")) != -1) {
+        switch (option) {
+            case 'p':
+                port = (uint16_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'a':
+                config.access_latency_us = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'w':
+                config.word_latency_ns = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'e':
+                config.flash_erase_latency_us = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'f':
+                config.flash_write_latency_ns = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                config.run_time_ms = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'u':
+                b_udp = true;
+                break;
+            case 'l':
+                g_gdb_server_udp.loss_percent = (unsigned int)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                gdb_server_print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    sim_target_init(&config);
+    gdb_session_init();
+
+    if (b_udp) {
+        struct sockaddr_in address = {
+            .sin_family      = AF_INET,
+            .sin_port        = htons(port),
+            .sin_addr.s_addr = htonl(INADDR_ANY),
+        };
+
+        g_gdb_server_udp.socket = socket(AF_INET, SOCK_DGRAM, 0);
+
+        if ((g_gdb_server_udp.socket < 0) ||
+            (bind(g_gdb_server_udp.socket, (struct sockaddr*)&address, sizeof(address)) != 0)) {
+            perror("Failed to set up the server socket");
+            return EXIT_FAILURE;
+        }
+
+        printf("Serving the simulated target on UDP port %u (%u %% loss).\n", port, g_gdb_server_udp.loss_percent);
+        fflush(stdout);
+        gdb_server_serve_udp();
+    }
+
+    int server_socket = socket(AF_INET, SOCK_STREAM, 0);
+    int enable        = 1;
+
+    struct sockaddr_in address = {
+        .sin_family      = AF_INET,
+        .sin_port        = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+
+    if ((server_socket < 0) || (setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) != 0) ||
+        (bind(server_socket, (struct sockaddr*)&address, sizeof(address)) != 0) || (listen(server_socket, 1) != 0)) {
+        perror("Failed to set up the server socket");
+        return EXIT_FAILURE;
+    }
+
+    printf("Serving the simulated target on port %u.\n", port);
+
+    while (true) {
+        g_gdb_server_client_socket = accept(server_socket, NULL, NULL);
+
+        if (g_gdb_server_client_socket < 0) {
+            continue;
+        }
+
+        setsockopt(g_gdb_server_client_socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        if (gdb_session_lock(GDB_SESSION_TRANSPORT_TCP_IP, gdb_server_write_cb)) {
+            gdb_server_serve();
+            gdb_session_release();
+        }
+
+        close(g_gdb_server_client_socket);
+        g_gdb_server_client_socket = -1;
+    }
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,500 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Unit tests for the host-built GDB core.
+ * @details Covers the packet framing (checksums, escaping, packet boundaries), the hex conversion helpers and the
+ * command dispatch through the full session, against the simulated target. Each test returns on its first failed
+ * expectation, and the process exits with a failure, if any test failed.
+ *
+ * @addtogroup host
+ * @{
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/common.h"
+#include "common/hex.h"
+#include "gdb/gdb.h"
+#include "gdb/gdb_packet.h"
+#include "gdb/gdb_session.h"
+#include "sim_target.h"
+
+/**
+ * @brief Check an expectation, and fail the running test, if it does not hold.
+ */
+#define GDB_TEST_EXPECT(_condition)                                                                                    \
+    do {                                                                                                               \
+        if (!(_condition)) {                                                                                           \
+            printf("    %s:%d: expected %s\n", __FILE__, __LINE__, #_condition);                                       \
+            return false;                                                                                              \
+        }                                                                                                              \
+    } while (false)
+
+/**
+ * @brief The maximum length of the session output that is captured per request.
+ */
+#define GDB_TEST_OUTPUT_MAX_LENGTH (GDB_PACKET_MAX_BUFFER_LENGTH * 4u)
+
+/**
+ * @brief A test definition.
+ */
+struct gdb_test {
+    const char* p_name;   ///< The name of the test.
+    bool (*p_run)(void);  ///< Runs the test, returns true, if it passed.
+};
+
+/**
+ * @brief The output of the session, as written to the transport.
+ */
+static struct {
+    char   buffer[GDB_TEST_OUTPUT_MAX_LENGTH + 1u];  ///< The output, NUL-terminated.
+    size_t length;                                   ///< The length of the output.
+} g_gdb_test_output;
+
+/**
+ * @brief Frame a payload as a packet ("$payload#checksum"), with a lower case checksum, as GDB sends it.
+ *
+ * @param p_payload A pointer to the NUL-terminated payload.
+ * @param p_frame A pointer to the buffer for the packet.
+ * @param frame_length The length of the buffer.
+ * @return size_t The length of the packet.
+ */
+static size_t gdb_test_frame(const char* p_payload, char* p_frame, size_t frame_length) {
+    uint8_t checksum = 0u;
+
+    for (const char* p_character = p_payload; *p_character != '\0'; p_character++) {
+        checksum += (uint8_t)*p_character;
+    }
+
+    int length = snprintf(p_frame, frame_length, "$%s#%02x", p_payload, checksum);
+
+    ASSERT_VERBOSE((length > 0) && ((size_t)length < frame_length), "Test frame overflow.");
+    return (size_t)length;
+}
+
+/**
+ * @brief Write callback of the test session - captures the output.
+ *
+ * @param p_buffer A pointer to the output buffer.
+ * @param length The length of the output.
+ * @param b_more True, if more output follows right away (unused).
+ * @return bool Always true.
+ */
+static bool gdb_test_write_cb(char* p_buffer, size_t length, bool b_more) {
+    (void)b_more;
+
+    ASSERT_VERBOSE((g_gdb_test_output.length + length) <= GDB_TEST_OUTPUT_MAX_LENGTH, "Test output overflow.");
+
+    memcpy(&g_gdb_test_output.buffer[g_gdb_test_output.length], p_buffer, length);
+    g_gdb_test_output.length += length;
+    g_gdb_test_output.buffer[g_gdb_test_output.length] = '\0';
+    return true;
+}
+
+/**
+ * @brief Feed raw characters into the session, and capture its output.
+ *
+ * @param p_input A pointer to the characters.
+ * @param input_length The number of characters.
+ * @return const char* The NUL-terminated output of the session.
+ */
+static const char* gdb_test_feed(const char* p_input, size_t input_length) {
+    g_gdb_test_output.length    = 0u;
+    g_gdb_test_output.buffer[0] = '\0';
+
+    size_t offset = 0u;
+
+    while ((offset < input_length) && (gdb_session_get_state() == GDB_SESSION_STATE_ACTIVE)) {
+        offset += gdb_session_handle(&p_input[offset], input_length - offset);
+    }
+
+    return g_gdb_test_output.buffer;
+}
+
+/**
+ * @brief Send a request to the session, and capture its output. The previous reply is acknowledged first.
+ *
+ * @param p_payload A pointer to the NUL-terminated request payload.
+ * @return const char* The NUL-terminated output of the session.
+ */
+static const char* gdb_test_request(const char* p_payload) {
+    static char stream[GDB_PACKET_MAX_BUFFER_LENGTH];
+
+    stream[0] = GDB_PACKET_CHAR_ACK;
+    size_t length = 1u + gdb_test_frame(p_payload, &stream[1], sizeof(stream) - 1u);
+
+    return gdb_test_feed(stream, length);
+}
+
+/**
+ * @brief Check, if the session output is the acknowledgement, followed by a single reply.
+ *
+ * @param p_output A pointer to the session output.
+ * @param p_reply A pointer to the expected reply payload.
+ * @return bool True, if the output matches.
+ */
+static bool gdb_test_is_reply(const char* p_output, const char* p_reply) {
+    char expected[GDB_PACKET_MAX_BUFFER_LENGTH];
+
+    expected[0] = GDB_PACKET_CHAR_ACK;
+    gdb_test_frame(p_reply, &expected[1], sizeof(expected) - 1u);
+
+    // The probe sends upper case checksums.
+    for (char* p_character = strchr(expected, GDB_PACKET_CHAR_STOP); *p_character != '\0'; p_character++) {
+        if ((*p_character >= 'a') && (*p_character <= 'f')) {
+            *p_character -= 'a' - 'A';
+        }
+    }
+
+    return 0 == strcmp(p_output, expected);
+}
+
+/**
+ * @brief Read a whole stream into a fresh packet.
+ *
+ * @param p_packet A pointer to the packet.
+ * @param p_stream A pointer to the NUL-terminated stream.
+ * @param p_consumed_length A pointer to the number of consumed characters.
+ * @return enum gdb_packet_result The packet result.
+ */
+static enum gdb_packet_result gdb_test_read(struct gdb_packet* p_packet, const char* p_stream,
+                                            size_t* p_consumed_length) {
+    gdb_packet_init(p_packet, GDB_PACKET_TYPE_INBOUND);
+    return gdb_packet_read_stream(p_packet, p_stream, strlen(p_stream), p_consumed_length);
+}
+
+static bool gdb_test_packet_read(void) {
+    static struct gdb_packet packet;
+    size_t                   consumed_length = 0u;
+
+    GDB_TEST_EXPECT(gdb_test_read(&packet, "$m20000000,4#4f+", &consumed_length) == GDB_PACKET_RESULT_OK);
+    GDB_TEST_EXPECT(consumed_length == 15u);
+    GDB_TEST_EXPECT(gdb_packet_get_payload_length(&packet) == 11u);
+    GDB_TEST_EXPECT(0 == strcmp(gdb_packet_get_buffer_payload(&packet), "m20000000,4#4f"));
+    GDB_TEST_EXPECT(gdb_packet_get_command(&packet) == 'm');
+
+    // Upper case checksums are accepted as well.
+    GDB_TEST_EXPECT(gdb_test_read(&packet, "$m20000000,4#4F", &consumed_length) == GDB_PACKET_RESULT_OK);
+    return true;
+}
+
+static bool gdb_test_packet_read_split(void) {
+    static struct gdb_packet packet;
+    size_t                   consumed_length = 0u;
+
+    GDB_TEST_EXPECT(gdb_test_read(&packet, "$qC", &consumed_length) == GDB_PACKET_RESULT_COLLECTING);
+    GDB_TEST_EXPECT(consumed_length == 3u);
+    GDB_TEST_EXPECT(gdb_packet_read_stream(&packet, "#b", 2u, &consumed_length) == GDB_PACKET_RESULT_COLLECTING);
+    GDB_TEST_EXPECT(gdb_packet_read_stream(&packet, "4", 1u, &consumed_length) == GDB_PACKET_RESULT_OK);
+    GDB_TEST_EXPECT(0 == strncmp(gdb_packet_get_buffer_payload(&packet), "qC", 2u));
+
+    // A start character within a packet starts over - the rest of the previous packet was lost.
+    GDB_TEST_EXPECT(gdb_test_read(&packet, "$m2000$qC#b4", &consumed_length) == GDB_PACKET_RESULT_OK);
+    GDB_TEST_EXPECT(gdb_packet_get_payload_length(&packet) == 2u);
+    return true;
+}
+
+static bool gdb_test_packet_read_checksum_error(void) {
+    static struct gdb_packet packet;
+    size_t                   consumed_length = 0u;
+
+    GDB_TEST_EXPECT(gdb_test_read(&packet, "$qC#b5$qC#b4", &consumed_length) == GDB_PACKET_RESULT_CHECKSUM_ERROR);
+    GDB_TEST_EXPECT(consumed_length == 6u);
+
+    // The next packet is read independently.
+    GDB_TEST_EXPECT(gdb_test_read(&packet, "$qC#b4", &consumed_length) == GDB_PACKET_RESULT_OK);
+    return true;
+}
+
+static bool gdb_test_packet_read_between_packets(void) {
+    static struct gdb_packet packet;
+    size_t                   consumed_length = 0u;
+
+    // Junk between packets is dropped.
+    GDB_TEST_EXPECT(gdb_test_read(&packet, "xyz#00", &consumed_length) == GDB_PACKET_RESULT_COLLECTING);
+    GDB_TEST_EXPECT(consumed_length == 6u);
+
+    GDB_TEST_EXPECT(gdb_test_read(&packet, "+$qC#b4", &consumed_length) == GDB_PACKET_RESULT_ACK);
+    GDB_TEST_EXPECT(consumed_length == 1u);
+    GDB_TEST_EXPECT(gdb_test_read(&packet, "-", &consumed_length) == GDB_PACKET_RESULT_NACK);
+    GDB_TEST_EXPECT(gdb_test_read(&packet, "\x03", &consumed_length) == GDB_PACKET_RESULT_INTERRUPT);
+
+    // Within a packet, the same characters are payload.
+    GDB_TEST_EXPECT(gdb_test_read(&packet, "$X0,1:\x03-+#7a", &consumed_length) == GDB_PACKET_RESULT_OK);
+    GDB_TEST_EXPECT(gdb_packet_get_payload_length(&packet) == 8u);
+    return true;
+}
+
+static bool gdb_test_packet_write(void) {
+    static struct gdb_packet packet;
+
+    gdb_packet_init(&packet, GDB_PACKET_TYPE_OUTBOUND);
+    GDB_TEST_EXPECT(gdb_packet_write(&packet, "OK") == GDB_PACKET_RESULT_OK);
+    GDB_TEST_EXPECT(gdb_packet_get_length(&packet) == 6u);
+    GDB_TEST_EXPECT(0 == strcmp(gdb_packet_get_buffer(&packet), "$OK#9A"));
+
+    gdb_packet_init(&packet, GDB_PACKET_TYPE_OUTBOUND);
+    GDB_TEST_EXPECT(gdb_packet_write(&packet, GDB_REPLY_EMPTY) == GDB_PACKET_RESULT_OK);
+    GDB_TEST_EXPECT(0 == strcmp(gdb_packet_get_buffer(&packet), "$#00"));
+
+    const uint8_t DATA[] = {0x00u, 0xABu, 0xFFu};
+
+    gdb_packet_init(&packet, GDB_PACKET_TYPE_OUTBOUND);
+    GDB_TEST_EXPECT(gdb_packet_write_start(&packet) == GDB_PACKET_RESULT_OK);
+    GDB_TEST_EXPECT(gdb_packet_write_payload_binary_as_hex(&packet, DATA, sizeof(DATA)) == GDB_PACKET_RESULT_OK);
+    GDB_TEST_EXPECT(gdb_packet_write_payload_as_hex(&packet, "OK") == GDB_PACKET_RESULT_OK);
+    GDB_TEST_EXPECT(gdb_packet_write_stop(&packet) == GDB_PACKET_RESULT_OK);
+    GDB_TEST_EXPECT(0 == strcmp(gdb_packet_get_buffer(&packet), "$00ABFF4F4B#5F"));
+    return true;
+}
+
+static bool gdb_test_packet_write_overflow(void) {
+    static struct gdb_packet packet;
+    static char              payload[GDB_PACKET_MAX_BUFFER_LENGTH + 1u];
+
+    memset(payload, 'a', GDB_PACKET_MAX_BUFFER_LENGTH);
+    payload[GDB_PACKET_MAX_BUFFER_LENGTH] = '\0';
+
+    gdb_packet_init(&packet, GDB_PACKET_TYPE_OUTBOUND);
+    GDB_TEST_EXPECT(gdb_packet_write(&packet, payload) == GDB_PACKET_RESULT_OVERFLOW);
+
+    // The largest payload that fits leaves room for the overhead and the terminator.
+    payload[GDB_PACKET_MAX_USABLE_BUFFER_LENGTH - GDB_PACKET_OVERHEAD_LENGTH] = '\0';
+
+    gdb_packet_init(&packet, GDB_PACKET_TYPE_OUTBOUND);
+    GDB_TEST_EXPECT(gdb_packet_write(&packet, payload) == GDB_PACKET_RESULT_OK);
+    GDB_TEST_EXPECT(gdb_packet_get_length(&packet) == GDB_PACKET_MAX_USABLE_BUFFER_LENGTH);
+    return true;
+}
+
+static bool gdb_test_packet_escape(void) {
+    static struct gdb_packet packet;
+    const char               DATA[] = {'a', '$', '#', '}', '*', 'b', '\0'};
+
+    gdb_packet_init(&packet, GDB_PACKET_TYPE_OUTBOUND);
+    GDB_TEST_EXPECT(gdb_packet_write_start(&packet) == GDB_PACKET_RESULT_OK);
+    GDB_TEST_EXPECT(gdb_packet_write_payload_binary(&packet, DATA, sizeof(DATA)) == GDB_PACKET_RESULT_OK);
+    GDB_TEST_EXPECT(gdb_packet_write_stop(&packet) == GDB_PACKET_RESULT_OK);
+
+    // Each special character is escaped, and the checksum covers the escaped payload.
+    const char ESCAPED[] = {'a', '}', 0x04, '}', 0x03, '}', ']', '}', 0x0A, 'b', '\0'};
+
+    GDB_TEST_EXPECT(gdb_packet_get_payload_length(&packet) == sizeof(ESCAPED));
+    GDB_TEST_EXPECT(0 == memcmp(gdb_packet_get_buffer_payload(&packet), ESCAPED, sizeof(ESCAPED)));
+
+    uint8_t checksum = 0u;
+    for (size_t index = 0u; index < sizeof(ESCAPED); index++) {
+        checksum += (uint8_t)ESCAPED[index];
+    }
+
+    char trailer[4];
+    snprintf(trailer, sizeof(trailer), "#%02X", checksum);
+    GDB_TEST_EXPECT(0 == strcmp(gdb_packet_get_buffer_payload_offset(&packet, sizeof(ESCAPED)), trailer));
+
+    // Unescaping restores the data in place.
+    char unescaped[sizeof(ESCAPED)];
+    memcpy(unescaped, ESCAPED, sizeof(ESCAPED));
+
+    GDB_TEST_EXPECT(gdb_packet_unescape_binary(unescaped, sizeof(ESCAPED)) == sizeof(DATA));
+    GDB_TEST_EXPECT(0 == memcmp(unescaped, DATA, sizeof(DATA)));
+    return true;
+}
+
+static bool gdb_test_hex_nibbles(void) {
+    const char DIGITS[] = "0123456789ABCDEF";
+
+    for (uint8_t value = 0u; value < 16u; value++) {
+        GDB_TEST_EXPECT(hex_nibble_from_char((char)value) == DIGITS[value]);
+        GDB_TEST_EXPECT(char_from_hex_nibble((uint8_t)DIGITS[value]) == (char)value);
+    }
+
+    GDB_TEST_EXPECT(char_from_hex_nibble('a') == 10);
+    GDB_TEST_EXPECT(char_from_hex_nibble('f') == 15);
+    return true;
+}
+
+static bool gdb_test_hex_strings(void) {
+    uint8_t hex[6];
+    char    string[4];
+
+    hex_from_str("GDB", 3u, hex, sizeof(hex));
+    GDB_TEST_EXPECT(0 == memcmp(hex, "474442", sizeof(hex)));
+
+    memset(string, 0xFF, sizeof(string));
+    str_from_hex((const uint8_t*)"4f4B21", 6u, string, sizeof(string));
+    GDB_TEST_EXPECT(0 == strcmp(string, "OK!"));
+
+    // All byte values survive a round trip.
+    static char    binary[256];
+    static uint8_t binary_hex[512];
+    static char    decoded[257];
+
+    for (size_t index = 0u; index < sizeof(binary); index++) {
+        binary[index] = (char)index;
+    }
+
+    hex_from_str(binary, sizeof(binary), binary_hex, sizeof(binary_hex));
+    str_from_hex(binary_hex, sizeof(binary_hex), decoded, sizeof(decoded));
+
+    GDB_TEST_EXPECT(0 == memcmp(decoded, binary, sizeof(binary)));
+    GDB_TEST_EXPECT(decoded[sizeof(binary)] == '\0');
+    return true;
+}
+
+static bool gdb_test_get_args(void) {
+    char        string[] = "  load \tfile.elf 0x08000000 ";
+    const char* argv[GDB_MAX_ARG_COUNT];
+    size_t      argc = 0u;
+
+    GDB_TEST_EXPECT(gdb_get_args(string, &argc, argv) == GDB_RESULT_OK);
+    GDB_TEST_EXPECT(argc == 3u);
+    GDB_TEST_EXPECT(0 == strcmp(argv[0], "load"));
+    GDB_TEST_EXPECT(0 == strcmp(argv[1], "file.elf"));
+    GDB_TEST_EXPECT(0 == strcmp(argv[2], "0x08000000"));
+
+    char excess[GDB_MAX_ARG_COUNT * 2u + 2u];
+    for (size_t index = 0u; index <= GDB_MAX_ARG_COUNT; index++) {
+        excess[2u * index]      = 'a';
+        excess[2u * index + 1u] = ' ';
+    }
+    excess[sizeof(excess) - 1u] = '\0';
+
+    GDB_TEST_EXPECT(gdb_get_args(excess, &argc, argv) == GDB_RESULT_EXCESS_ARGUMENTS);
+    return true;
+}
+
+static bool gdb_test_dispatch_commands(void) {
+    GDB_TEST_EXPECT(gdb_test_is_reply(gdb_test_request("qC"), "QC1"));
+    GDB_TEST_EXPECT(gdb_test_is_reply(gdb_test_request("Hg0"), GDB_REPLY_OK));
+
+    // Unknown commands, queries and v packets are answered with an empty reply.
+    GDB_TEST_EXPECT(gdb_test_is_reply(gdb_test_request("j"), GDB_REPLY_EMPTY));
+    GDB_TEST_EXPECT(gdb_test_is_reply(gdb_test_request("qUnknown"), GDB_REPLY_EMPTY));
+    GDB_TEST_EXPECT(gdb_test_is_reply(gdb_test_request("vMustReplyEmpty"), GDB_REPLY_EMPTY));
+
+    // Without an attached target, target commands fail.
+    GDB_TEST_EXPECT(gdb_test_is_reply(gdb_test_request("m20000000,4"), GDB_REPLY_ERROR_FF));
+    return true;
+}
+
+static bool gdb_test_dispatch_acknowledgements(void) {
+    GDB_TEST_EXPECT(gdb_test_is_reply(gdb_test_request("qC"), "QC1"));
+
+    // A rejected reply is sent again, but only until it was acknowledged.
+    GDB_TEST_EXPECT(0 == strcmp(gdb_test_feed("-", 1u), "$QC1#C5"));
+    GDB_TEST_EXPECT(0 == strcmp(gdb_test_feed("+-", 2u), ""));
+
+    // A corrupted request is rejected, and not executed.
+    GDB_TEST_EXPECT(0 == strcmp(gdb_test_feed("$qC#00", 6u), "-"));
+
+    // "perf", hex encoded - replies with console output packets, and the final "OK".
+    const char* p_output     = gdb_test_request("qRcmd,70657266");
+    size_t      packet_count = 0u;
+
+    for (const char* p_character = p_output; *p_character != '\0'; p_character++) {
+        packet_count += (*p_character == GDB_PACKET_CHAR_START) ? 1u : 0u;
+    }
+
+    GDB_TEST_EXPECT(packet_count > 2u);
+
+    // Acknowledging the first packet does not give up on the last one. Rejecting the second one loses it.
+    GDB_TEST_EXPECT(0 == strcmp(gdb_test_feed("+", 1u), ""));
+    GDB_TEST_EXPECT(0 == strcmp(gdb_test_feed("-", 1u), ""));
+
+    for (size_t packet_index = 3u; packet_index < packet_count; packet_index++) {
+        GDB_TEST_EXPECT(0 == strcmp(gdb_test_feed("+", 1u), ""));
+    }
+
+    GDB_TEST_EXPECT(0 == strcmp(gdb_test_feed("-", 1u), "$OK#9A"));
+    GDB_TEST_EXPECT(0 == strcmp(gdb_test_feed("+-", 2u), ""));
+    return true;
+}
+
+static bool gdb_test_dispatch_monitor(void) {
+    // "help", hex encoded. The reply is the hex encoded output.
+    const char* p_output = gdb_test_request("qRcmd,68656c70");
+    const char  HEADER[] = "Supported monitor commands:";
+    char        decoded[sizeof(HEADER)];
+
+    GDB_TEST_EXPECT(0 == strncmp(p_output, "+$", 2u));
+    GDB_TEST_EXPECT(strlen(p_output) > (2u * sizeof(HEADER)));
+
+    str_from_hex((const uint8_t*)&p_output[2], 2u * (sizeof(HEADER) - 1u), decoded, sizeof(decoded));
+    GDB_TEST_EXPECT(0 == strcmp(decoded, HEADER));
+
+    // "nonsense", hex encoded.
+    GDB_TEST_EXPECT(gdb_test_is_reply(gdb_test_request("qRcmd,6e6f6e73656e7365"), GDB_REPLY_EMPTY));
+    return true;
+}
+
+static bool gdb_test_dispatch_target(void) {
+    GDB_TEST_EXPECT(0 == strncmp(gdb_test_request("vAttach;1"), "+$T", 3u));
+
+    GDB_TEST_EXPECT(gdb_test_is_reply(gdb_test_request("M20000010,4:01ab02cd"), GDB_REPLY_OK));
+    GDB_TEST_EXPECT(gdb_test_is_reply(gdb_test_request("m20000010,4"), "01AB02CD"));
+
+    // Binary writes are unescaped: 0x7d 0x5d is '}'.
+    const char WRITE[] = "X20000010,2:}]a";
+    GDB_TEST_EXPECT(gdb_test_is_reply(gdb_test_request(WRITE), GDB_REPLY_OK));
+    GDB_TEST_EXPECT(gdb_test_is_reply(gdb_test_request("m20000010,4"), "7D6102CD"));
+
+    GDB_TEST_EXPECT(gdb_test_is_reply(gdb_test_request("D"), GDB_REPLY_OK));
+    GDB_TEST_EXPECT(gdb_test_is_reply(gdb_test_request("m20000010,4"), GDB_REPLY_ERROR_FF));
+    return true;
+}
+
+/**
+ * @brief All tests. The dispatch tests run in a fresh session each.
+ */
+static const struct gdb_test G_TESTS[] = {
+    {"packet: read", gdb_test_packet_read},
+    {"packet: read split", gdb_test_packet_read_split},
+    {"packet: read checksum error", gdb_test_packet_read_checksum_error},
+    {"packet: read between packets", gdb_test_packet_read_between_packets},
+    {"packet: write", gdb_test_packet_write},
+    {"packet: write overflow", gdb_test_packet_write_overflow},
+    {"packet: escape", gdb_test_packet_escape},
+    {"hex: nibbles", gdb_test_hex_nibbles},
+    {"hex: strings", gdb_test_hex_strings},
+    {"dispatch: arguments", gdb_test_get_args},
+    {"dispatch: commands", gdb_test_dispatch_commands},
+    {"dispatch: acknowledgements", gdb_test_dispatch_acknowledgements},
+    {"dispatch: monitor", gdb_test_dispatch_monitor},
+    {"dispatch: target", gdb_test_dispatch_target},
+};
+
+int main(void) {
+    const struct sim_target_config CONFIG = {0};
+
+    sim_target_init(&CONFIG);
+    gdb_session_init();
+
+    size_t failure_count = 0u;
+
+    for (size_t test_index = 0u; test_index < ARRAY_LENGTH(G_TESTS); test_index++) {
+        const struct gdb_test* p_test = &G_TESTS[test_index];
+
+        if (!gdb_session_lock(GDB_SESSION_TRANSPORT_TCP_IP, gdb_test_write_cb)) {
+            fprintf(stderr, "Failed to lock the GDB session.\n");
+            return EXIT_FAILURE;
+        }
+
+        bool b_passed = p_test->p_run();
+        gdb_session_release();
+
+        printf("%-32s %s\n", p_test->p_name, b_passed ? "ok" : "FAILED");
+        failure_count += b_passed ? 0u : 1u;
+    }
+
+    printf("%zu of %zu tests passed.\n", ARRAY_LENGTH(G_TESTS) - failure_count, ARRAY_LENGTH(G_TESTS));
+    return (failure_count == 0u) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @}
+ */
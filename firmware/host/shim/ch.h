@@ -0,0 +1,126 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Host shim for the ChibiOS/RT kernel headers.
+ * @details Provides the small part of the kernel API that the GDB core uses, such that it can be built and run on a
+ * Linux host. There is only a single thread of execution, so semaphores never block.
+ *
+ * @addtogroup host
+ * @{
+ */
+
+#ifndef HOST_SHIM_CH_H_
+#define HOST_SHIM_CH_H_
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define TRUE  1
+#define FALSE 0
+
+#define MSG_OK      ((msg_t)0)
+#define MSG_TIMEOUT ((msg_t)-1)
+
+#define TIME_IMMEDIATE ((sysinterval_t)0)
+#define TIME_INFINITE  ((sysinterval_t)-1)
+
+/**
+ * @brief The system tick frequency. The host counts milliseconds.
+ */
+#define CH_CFG_ST_FREQUENCY 1000u
+
+#define TIME_MS2I(_ms) ((sysinterval_t)(_ms))
+#define TIME_I2MS(_i)  ((uint32_t)(_i))
+
+typedef int32_t  msg_t;
+typedef uint32_t sysinterval_t;
+typedef uint32_t systime_t;
+typedef uint32_t rtcnt_t;
+
+/**
+ * @brief A binary semaphore, reduced to its counter.
+ */
+typedef struct {
+    bool b_taken;  ///< True, if the semaphore is taken.
+} binary_semaphore_t;
+
+/**
+ * @brief Halt the system - print the reason, and abort the host process.
+ *
+ * @param p_reason A pointer to the reason string.
+ */
+static inline void chSysHalt(const char* p_reason) {
+    fprintf(stderr, "System halted: %s\n", p_reason);
+    abort();
+}
+
+#define chDbgAssert(_cond, _remark)                                                                                    \
+    do {                                                                                                               \
+        if (!(_cond)) {                                                                                                \
+            chSysHalt(_remark);                                                                                        \
+        }                                                                                                              \
+    } while (false)
+
+/**
+ * @brief Get the realtime counter, which counts nanoseconds on the host (see \a STM32_SYSCLK).
+ *
+ * @return rtcnt_t The counter value, wrapping around every 4.3 s.
+ */
+static inline rtcnt_t chSysGetRealtimeCounterX(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (rtcnt_t)((uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec);
+}
+
+/**
+ * @brief Get the system time.
+ *
+ * @return systime_t The time in milliseconds, wrapping around like on the probe.
+ */
+static inline systime_t chVTGetSystemTimeX(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (systime_t)((uint64_t)now.tv_sec * 1000ull + (uint64_t)now.tv_nsec / 1000000ull);
+}
+
+/**
+ * @brief Get the time that elapsed since a system time.
+ *
+ * @param start The start time.
+ * @return sysinterval_t The elapsed time.
+ */
+static inline sysinterval_t chVTTimeElapsedSinceX(systime_t start) {
+    return (sysinterval_t)(chVTGetSystemTimeX() - start);
+}
+
+static inline void chSysLock(void) {}
+static inline void chSysUnlock(void) {}
+
+static inline void chBSemObjectInit(binary_semaphore_t* p_semaphore, bool b_taken) { p_semaphore->b_taken = b_taken; }
+
+static inline msg_t chBSemWaitTimeout(binary_semaphore_t* p_semaphore, sysinterval_t timeout) {
+    (void)timeout;
+
+    if (p_semaphore->b_taken) {
+        return MSG_TIMEOUT;
+    }
+
+    p_semaphore->b_taken = true;
+    return MSG_OK;
+}
+
+static inline void chBSemSignal(binary_semaphore_t* p_semaphore) { p_semaphore->b_taken = false; }
+
+#endif  // HOST_SHIM_CH_H_
+
+/**
+ * @}
+ */
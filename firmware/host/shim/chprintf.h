@@ -0,0 +1,23 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Host shim for the ChibiOS formatted printing headers.
+ *
+ * @addtogroup host
+ * @{
+ */
+
+#ifndef HOST_SHIM_CHPRINTF_H_
+#define HOST_SHIM_CHPRINTF_H_
+
+#include <stdio.h>
+
+#define chsnprintf  snprintf
+#define chvsnprintf vsnprintf
+
+#endif  // HOST_SHIM_CHPRINTF_H_
+
+/**
+ * @}
+ */
@@ -0,0 +1,41 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Host shim for the ChibiOS formatted scanning headers.
+ *
+ * @addtogroup host
+ * @{
+ */
+
+#ifndef HOST_SHIM_CHSCANF_H_
+#define HOST_SHIM_CHSCANF_H_
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @brief Scan a buffer of limited size. The buffer is expected to be NUL-terminated within \a size.
+ *
+ * @param p_buffer A pointer to the buffer to scan.
+ * @param size The size of the buffer.
+ * @param p_format A pointer to the format string.
+ * @return int The number of assigned arguments.
+ */
+static inline int chsnscanf(const char* p_buffer, size_t size, const char* p_format, ...) {
+    (void)size;
+
+    va_list arguments;
+    va_start(arguments, p_format);
+    int count = vsscanf(p_buffer, p_format, arguments);
+    va_end(arguments);
+
+    return count;
+}
+
+#endif  // HOST_SHIM_CHSCANF_H_
+
+/**
+ * @}
+ */
@@ -0,0 +1,25 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Host shim for the blackmagic general headers.
+ *
+ * @addtogroup host
+ * @{
+ */
+
+#ifndef HOST_SHIM_GENERAL_H_
+#define HOST_SHIM_GENERAL_H_
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#endif  // HOST_SHIM_GENERAL_H_
+
+/**
+ * @}
+ */
@@ -0,0 +1,37 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Host shim for the ChibiOS HAL headers.
+ * @details The status LEDs do not exist on the host - setting and clearing them has no effect.
+ *
+ * @addtogroup host
+ * @{
+ */
+
+#ifndef HOST_SHIM_HAL_H_
+#define HOST_SHIM_HAL_H_
+
+#include "ch.h"
+
+typedef uint32_t ioline_t;
+
+/**
+ * @brief The frequency of the realtime counter - it counts nanoseconds on the host.
+ */
+#define STM32_SYSCLK 1000000000u
+
+#define LINE_LED_BLUE  ((ioline_t)0u)
+#define LINE_LED_GREEN ((ioline_t)1u)
+#define LINE_LED_AMBER ((ioline_t)2u)
+#define LINE_LED_RED   ((ioline_t)3u)
+
+#define palSetLine(_line)    ((void)(_line))
+#define palClearLine(_line)  ((void)(_line))
+#define palToggleLine(_line) ((void)(_line))
+
+#endif  // HOST_SHIM_HAL_H_
+
+/**
+ * @}
+ */
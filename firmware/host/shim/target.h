@@ -0,0 +1,79 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Host shim for the blackmagic target headers.
+ * @details Declares the public target API, as used by the GDB core. On the host, it is implemented by the simulated
+ * target (see sim_target.c).
+ *
+ * @addtogroup host
+ * @{
+ */
+
+#ifndef HOST_SHIM_TARGET_H_
+#define HOST_SHIM_TARGET_H_
+
+#include "general.h"
+
+typedef uint32_t target_addr_t;
+
+typedef struct target            target_s;
+typedef struct target_controller target_controller_s;
+
+/**
+ * @brief The interface, through which a target reports back to its controller (the GDB session).
+ */
+struct target_controller {
+    void (*destroy_callback)(target_controller_s* p_controller, target_s* p_target);
+    void (*printf)(target_controller_s* p_controller, const char* p_format, va_list arguments);
+};
+
+typedef enum target_halt_reason {
+    TARGET_HALT_RUNNING = 0,
+    TARGET_HALT_ERROR,
+    TARGET_HALT_REQUEST,
+    TARGET_HALT_STEPPING,
+    TARGET_HALT_BREAKPOINT,
+    TARGET_HALT_WATCHPOINT,
+    TARGET_HALT_FAULT,
+} target_halt_reason_e;
+
+typedef enum target_breakwatch {
+    TARGET_BREAK_SOFT,
+    TARGET_BREAK_HARD,
+    TARGET_WATCH_WRITE,
+    TARGET_WATCH_READ,
+    TARGET_WATCH_ACCESS,
+} target_breakwatch_e;
+
+target_s* target_attach_n(size_t n, target_controller_s* p_controller);
+void      target_detach(target_s* p_target);
+
+bool target_mem_map(target_s* p_target, char* p_buffer, size_t length);
+bool target_mem_read(target_s* p_target, void* p_destination, target_addr_t source, size_t length);
+bool target_mem_write(target_s* p_target, target_addr_t destination, const void* p_source, size_t length);
+
+bool target_flash_erase(target_s* p_target, target_addr_t address, size_t length);
+bool target_flash_write(target_s* p_target, target_addr_t destination, const void* p_source, size_t length);
+bool target_flash_complete(target_s* p_target);
+
+size_t      target_regs_size(target_s* p_target);
+const char* target_regs_description(target_s* p_target);
+void        target_regs_read(target_s* p_target, void* p_data);
+void        target_regs_write(target_s* p_target, const void* p_data);
+size_t      target_reg_read(target_s* p_target, uint32_t reg, void* p_data, size_t max);
+size_t      target_reg_write(target_s* p_target, uint32_t reg, const void* p_data, size_t size);
+
+void                 target_reset(target_s* p_target);
+void                 target_halt_request(target_s* p_target);
+target_halt_reason_e target_halt_poll(target_s* p_target, target_addr_t* p_watch);
+void                 target_halt_resume(target_s* p_target, bool b_step);
+
+int target_breakwatch_set(target_s* p_target, target_breakwatch_e type, target_addr_t address, size_t length);
+int target_breakwatch_clear(target_s* p_target, target_breakwatch_e type, target_addr_t address, size_t length);
+
+#endif  // HOST_SHIM_TARGET_H_
+
+/**
+ * @}
+ */
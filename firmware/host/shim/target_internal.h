@@ -0,0 +1,20 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Host shim for the blackmagic internal target headers.
+ *
+ * @addtogroup host
+ * @{
+ */
+
+#ifndef HOST_SHIM_TARGET_INTERNAL_H_
+#define HOST_SHIM_TARGET_INTERNAL_H_
+
+#include "target.h"
+
+#endif  // HOST_SHIM_TARGET_INTERNAL_H_
+
+/**
+ * @}
+ */
@@ -0,0 +1,417 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The simulated target module.
+ * @details Implements the blackmagic target API on top of host memory, with a Cortex-M like register set, flash and
+ * RAM. Every operation can be delayed, in order to emulate a slow debug link or flash controller. Delays are busy
+ * waits, as sleeping is too coarse for emulating single SWD transfers.
+ *
+ * There is only a single target, number 1.
+ *
+ * @addtogroup host
+ * @{
+ */
+
+#include "sim_target.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common/common.h"
+
+/**
+ * @brief A break- or watchpoint.
+ */
+struct sim_target_breakwatch {
+    target_breakwatch_e type;     ///< The type of break- or watchpoint.
+    target_addr_t       address;  ///< The address that it is set on.
+    bool                b_used;   ///< True, if the slot is in use.
+};
+
+/**
+ * @brief The simulated target.
+ */
+struct target {
+    target_controller_s* p_controller;  ///< The controller that is attached, or NULL.
+
+    uint8_t  flash[SIM_TARGET_FLASH_LENGTH];
+    uint8_t  ram[SIM_TARGET_RAM_LENGTH];
+    uint32_t registers[SIM_TARGET_REGISTER_COUNT];
+
+    struct sim_target_breakwatch breakwatches[SIM_TARGET_BREAKWATCH_MAX_COUNT];
+
+    target_halt_reason_e halt_reason;  ///< The reason for the last halt, or running.
+    bool                 b_stepping;   ///< True, if the target was resumed for a single step.
+    uint64_t             resume_ns;    ///< The time at which the target was resumed.
+
+    struct sim_target_config config;
+};
+
+static struct target g_sim_target;
+
+/**
+ * @brief The target description, as reported to GDB.
+ */
+static const char G_SIM_TARGET_DESCRIPTION[] =
+    "<?xml version=\"1.0\"?>"
+    "<!DOCTYPE target SYSTEM \"gdb-target.dtd\">"
+    "<target>"
+    "<architecture>arm</architecture>"
+    "<feature name=\"org.gnu.gdb.arm.m-profile\">"
+    "<reg name=\"r0\" bitsize=\"32\"/>"
+    "<reg name=\"r1\" bitsize=\"32\"/>"
+    "<reg name=\"r2\" bitsize=\"32\"/>"
+    "<reg name=\"r3\" bitsize=\"32\"/>"
+    "<reg name=\"r4\" bitsize=\"32\"/>"
+    "<reg name=\"r5\" bitsize=\"32\"/>"
+    "<reg name=\"r6\" bitsize=\"32\"/>"
+    "<reg name=\"r7\" bitsize=\"32\"/>"
+    "<reg name=\"r8\" bitsize=\"32\"/>"
+    "<reg name=\"r9\" bitsize=\"32\"/>"
+    "<reg name=\"r10\" bitsize=\"32\"/>"
+    "<reg name=\"r11\" bitsize=\"32\"/>"
+    "<reg name=\"r12\" bitsize=\"32\"/>"
+    "<reg name=\"sp\" bitsize=\"32\" type=\"data_ptr\"/>"
+    "<reg name=\"lr\" bitsize=\"32\" type=\"code_ptr\"/>"
+    "<reg name=\"pc\" bitsize=\"32\" type=\"code_ptr\"/>"
+    "<reg name=\"xpsr\" bitsize=\"32\" regnum=\"25\"/>"
+    "</feature>"
+    "</target>";
+
+/**
+ * @brief Get a monotonic time stamp.
+ *
+ * @return uint64_t The time stamp in nanoseconds.
+ */
+static uint64_t sim_target_get_time_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Busy-wait for a while.
+ *
+ * @param delay_ns The time to wait in nanoseconds.
+ */
+static void sim_target_delay_ns(uint64_t delay_ns) {
+    if (delay_ns == 0u) {
+        return;
+    }
+
+    const uint64_t END_NS = sim_target_get_time_ns() + delay_ns;
+
+    while (sim_target_get_time_ns() < END_NS) {
+    }
+}
+
+/**
+ * @brief Emulate the latency of an access through the debug link.
+ *
+ * @param p_target A pointer to the target.
+ * @param length The number of transferred bytes.
+ */
+static void sim_target_delay_access(struct target* p_target, size_t length) {
+    const uint64_t WORD_COUNT = (length + 3u) / 4u;
+
+    sim_target_delay_ns((uint64_t)p_target->config.access_latency_us * 1000u +
+                        WORD_COUNT * p_target->config.word_latency_ns);
+}
+
+/**
+ * @brief Map a target address range to simulated memory.
+ *
+ * @param p_target A pointer to the target.
+ * @param address The start address.
+ * @param length The length of the range.
+ * @param b_include_flash If false, flash is not mapped.
+ * @return uint8_t* A pointer to the memory, or NULL, if the range is not fully inside one memory.
+ */
+static uint8_t* sim_target_map(struct target* p_target, target_addr_t address, size_t length, bool b_include_flash) {
+    if (b_include_flash && (address >= SIM_TARGET_FLASH_START) &&
+        ((address - SIM_TARGET_FLASH_START) + length <= SIM_TARGET_FLASH_LENGTH)) {
+        return &p_target->flash[address - SIM_TARGET_FLASH_START];
+    }
+
+    if ((address >= SIM_TARGET_RAM_START) && ((address - SIM_TARGET_RAM_START) + length <= SIM_TARGET_RAM_LENGTH)) {
+        return &p_target->ram[address - SIM_TARGET_RAM_START];
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Check, if a breakpoint is set.
+ *
+ * @param p_target A pointer to the target.
+ * @return bool True, if any breakpoint is set.
+ */
+static bool sim_target_has_breakpoint(struct target* p_target) {
+    for (size_t index = 0u; index < ARRAY_LENGTH(p_target->breakwatches); index++) {
+        const struct sim_target_breakwatch* p_breakwatch = &p_target->breakwatches[index];
+
+        if (p_breakwatch->b_used &&
+            ((p_breakwatch->type == TARGET_BREAK_SOFT) || (p_breakwatch->type == TARGET_BREAK_HARD))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Initialize the simulated target - erase its memories, and apply the latency settings.
+ *
+ * @param p_config A pointer to the latency settings.
+ */
+void sim_target_init(const struct sim_target_config* p_config) {
+    ASSERT_PTR_NOT_NULL(p_config);
+
+    struct target* p_target = &g_sim_target;
+
+    memset(p_target, 0, sizeof(*p_target));
+    memset(p_target->flash, 0xFF, sizeof(p_target->flash));
+
+    p_target->config      = *p_config;
+    p_target->halt_reason = TARGET_HALT_REQUEST;
+}
+
+target_s* target_attach_n(size_t n, target_controller_s* p_controller) {
+    if (n != 1u) {
+        return NULL;
+    }
+
+    struct target* p_target = &g_sim_target;
+
+    p_target->p_controller = p_controller;
+    p_target->halt_reason  = TARGET_HALT_REQUEST;
+
+    sim_target_delay_access(p_target, 0u);
+    return p_target;
+}
+
+void target_detach(target_s* p_target) {
+    p_target->p_controller = NULL;
+    p_target->halt_reason  = TARGET_HALT_RUNNING;
+    p_target->b_stepping   = false;
+}
+
+bool target_mem_map(target_s* p_target, char* p_buffer, size_t length) {
+    (void)p_target;
+
+    int written = snprintf(p_buffer, length,
+                           "<memory-map>"
+                           "<memory type=\"flash\" start=\"0x%08x\" length=\"0x%x\">"
+                           "<property name=\"blocksize\">0x%x</property>"
+                           "</memory>"
+                           "<memory type=\"ram\" start=\"0x%08x\" length=\"0x%x\"/>"
+                           "</memory-map>",
+                           SIM_TARGET_FLASH_START, SIM_TARGET_FLASH_LENGTH, SIM_TARGET_FLASH_SECTOR_SIZE,
+                           SIM_TARGET_RAM_START, SIM_TARGET_RAM_LENGTH);
+
+    return (written > 0) && ((size_t)written < length);
+}
+
+bool target_mem_read(target_s* p_target, void* p_destination, target_addr_t source, size_t length) {
+    sim_target_delay_access(p_target, length);
+
+    const uint8_t* p_memory = sim_target_map(p_target, source, length, true);
+
+    if (p_memory == NULL) {
+        // Reading unmapped memory results in a fault.
+        return true;
+    }
+
+    memcpy(p_destination, p_memory, length);
+    return false;
+}
+
+bool target_mem_write(target_s* p_target, target_addr_t destination, const void* p_source, size_t length) {
+    sim_target_delay_access(p_target, length);
+
+    // Flash is not writable through the bus.
+    uint8_t* p_memory = sim_target_map(p_target, destination, length, false);
+
+    if (p_memory == NULL) {
+        return true;
+    }
+
+    memcpy(p_memory, p_source, length);
+    return false;
+}
+
+bool target_flash_erase(target_s* p_target, target_addr_t address, size_t length) {
+    const target_addr_t SECTOR_MASK = ~(SIM_TARGET_FLASH_SECTOR_SIZE - 1u);
+    const target_addr_t START       = address & SECTOR_MASK;
+    const target_addr_t END         = (address + length + SIM_TARGET_FLASH_SECTOR_SIZE - 1u) & SECTOR_MASK;
+
+    if ((START < SIM_TARGET_FLASH_START) || (END > SIM_TARGET_FLASH_START + SIM_TARGET_FLASH_LENGTH)) {
+        return false;
+    }
+
+    for (target_addr_t sector = START; sector < END; sector += SIM_TARGET_FLASH_SECTOR_SIZE) {
+        sim_target_delay_ns((uint64_t)p_target->config.flash_erase_latency_us * 1000u);
+        memset(&p_target->flash[sector - SIM_TARGET_FLASH_START], 0xFF, SIM_TARGET_FLASH_SECTOR_SIZE);
+    }
+
+    return true;
+}
+
+bool target_flash_write(target_s* p_target, target_addr_t destination, const void* p_source, size_t length) {
+    if ((destination < SIM_TARGET_FLASH_START) ||
+        ((destination - SIM_TARGET_FLASH_START) + length > SIM_TARGET_FLASH_LENGTH)) {
+        return false;
+    }
+
+    sim_target_delay_access(p_target, length);
+    sim_target_delay_ns((uint64_t)length * p_target->config.flash_write_latency_ns);
+
+    uint8_t*       p_flash = &p_target->flash[destination - SIM_TARGET_FLASH_START];
+    const uint8_t* p_bytes = p_source;
+
+    for (size_t index = 0u; index < length; index++) {
+        // Programming can only clear bits.
+        p_flash[index] &= p_bytes[index];
+    }
+
+    return true;
+}
+
+bool target_flash_complete(target_s* p_target) {
+    (void)p_target;
+    return true;
+}
+
+size_t target_regs_size(target_s* p_target) { return sizeof(p_target->registers); }
+
+const char* target_regs_description(target_s* p_target) {
+    (void)p_target;
+
+    // The caller frees the description.
+    return strdup(G_SIM_TARGET_DESCRIPTION);
+}
+
+void target_regs_read(target_s* p_target, void* p_data) {
+    sim_target_delay_access(p_target, sizeof(p_target->registers));
+    memcpy(p_data, p_target->registers, sizeof(p_target->registers));
+}
+
+void target_regs_write(target_s* p_target, const void* p_data) {
+    sim_target_delay_access(p_target, sizeof(p_target->registers));
+    memcpy(p_target->registers, p_data, sizeof(p_target->registers));
+}
+
+size_t target_reg_read(target_s* p_target, uint32_t reg, void* p_data, size_t max) {
+    if ((reg >= SIM_TARGET_REGISTER_COUNT) || (max < sizeof(uint32_t))) {
+        return 0u;
+    }
+
+    sim_target_delay_access(p_target, sizeof(uint32_t));
+    memcpy(p_data, &p_target->registers[reg], sizeof(uint32_t));
+    return sizeof(uint32_t);
+}
+
+size_t target_reg_write(target_s* p_target, uint32_t reg, const void* p_data, size_t size) {
+    if ((reg >= SIM_TARGET_REGISTER_COUNT) || (size != sizeof(uint32_t))) {
+        return 0u;
+    }
+
+    sim_target_delay_access(p_target, sizeof(uint32_t));
+    memcpy(&p_target->registers[reg], p_data, sizeof(uint32_t));
+    return sizeof(uint32_t);
+}
+
+void target_reset(target_s* p_target) {
+    sim_target_delay_access(p_target, 0u);
+
+    memset(p_target->registers, 0, sizeof(p_target->registers));
+
+    // Load the initial stack pointer and the reset vector from the vector table.
+    memcpy(&p_target->registers[SIM_TARGET_REGISTER_INDEX_SP], &p_target->flash[0], sizeof(uint32_t));
+    memcpy(&p_target->registers[SIM_TARGET_REGISTER_INDEX_PC], &p_target->flash[4], sizeof(uint32_t));
+}
+
+void target_halt_request(target_s* p_target) {
+    sim_target_delay_access(p_target, 0u);
+
+    if (p_target->halt_reason == TARGET_HALT_RUNNING) {
+        p_target->halt_reason = TARGET_HALT_REQUEST;
+    }
+}
+
+target_halt_reason_e target_halt_poll(target_s* p_target, target_addr_t* p_watch) {
+    (void)p_watch;
+
+    sim_target_delay_access(p_target, sizeof(uint32_t));
+
+    if (p_target->halt_reason != TARGET_HALT_RUNNING) {
+        return p_target->halt_reason;
+    }
+
+    if (p_target->b_stepping) {
+        p_target->b_stepping  = false;
+        p_target->halt_reason = TARGET_HALT_STEPPING;
+    } else if ((p_target->config.run_time_ms > 0u) && sim_target_has_breakpoint(p_target) &&
+               ((sim_target_get_time_ns() - p_target->resume_ns) >= p_target->config.run_time_ms * 1000000ull)) {
+        p_target->halt_reason = TARGET_HALT_BREAKPOINT;
+    }
+
+    return p_target->halt_reason;
+}
+
+void target_halt_resume(target_s* p_target, bool b_step) {
+    sim_target_delay_access(p_target, 0u);
+
+    if (b_step) {
+        // Pretend to execute a 16 bit instruction.
+        p_target->registers[SIM_TARGET_REGISTER_INDEX_PC] += 2u;
+    }
+
+    p_target->b_stepping  = b_step;
+    p_target->halt_reason = TARGET_HALT_RUNNING;
+    p_target->resume_ns   = sim_target_get_time_ns();
+}
+
+int target_breakwatch_set(target_s* p_target, target_breakwatch_e type, target_addr_t address, size_t length) {
+    (void)length;
+
+    for (size_t index = 0u; index < ARRAY_LENGTH(p_target->breakwatches); index++) {
+        struct sim_target_breakwatch* p_breakwatch = &p_target->breakwatches[index];
+
+        if (!p_breakwatch->b_used) {
+            p_breakwatch->type    = type;
+            p_breakwatch->address = address;
+            p_breakwatch->b_used  = true;
+
+            sim_target_delay_access(p_target, sizeof(uint32_t));
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+int target_breakwatch_clear(target_s* p_target, target_breakwatch_e type, target_addr_t address, size_t length) {
+    (void)length;
+
+    for (size_t index = 0u; index < ARRAY_LENGTH(p_target->breakwatches); index++) {
+        struct sim_target_breakwatch* p_breakwatch = &p_target->breakwatches[index];
+
+        if (p_breakwatch->b_used && (p_breakwatch->type == type) && (p_breakwatch->address == address)) {
+            p_breakwatch->b_used = false;
+
+            sim_target_delay_access(p_target, sizeof(uint32_t));
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,46 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The simulated target module headers.
+ *
+ * @addtogroup host
+ * @{
+ */
+
+#ifndef HOST_SIM_TARGET_H_
+#define HOST_SIM_TARGET_H_
+
+#include <stdint.h>
+
+#include "target.h"
+
+#define SIM_TARGET_FLASH_START       0x08000000u
+#define SIM_TARGET_FLASH_LENGTH      0x00040000u  // 256 kiB
+#define SIM_TARGET_FLASH_SECTOR_SIZE 0x00000800u  // 2 kiB
+#define SIM_TARGET_RAM_START         0x20000000u
+#define SIM_TARGET_RAM_LENGTH        0x00010000u  // 64 kiB
+
+#define SIM_TARGET_REGISTER_COUNT       17u  // r0-r12, sp, lr, pc, xpsr
+#define SIM_TARGET_REGISTER_INDEX_SP    13u
+#define SIM_TARGET_REGISTER_INDEX_PC    15u
+#define SIM_TARGET_BREAKWATCH_MAX_COUNT 8u
+
+/**
+ * @brief Latency settings of the simulated target, for emulating the debug link and flash controller.
+ */
+struct sim_target_config {
+    uint32_t access_latency_us;       ///< The fixed latency of every memory or register access.
+    uint32_t word_latency_ns;         ///< The additional latency per transferred 32 bit word.
+    uint32_t flash_erase_latency_us;  ///< The latency per erased flash sector.
+    uint32_t flash_write_latency_ns;  ///< The latency per programmed flash byte.
+    uint32_t run_time_ms;  ///< The time after which a resumed target halts on a breakpoint. Zero runs until halted.
+};
+
+void sim_target_init(const struct sim_target_config* p_config);
+
+#endif  // HOST_SIM_TARGET_H_
+
+/**
+ * @}
+ */
@@ -10,7 +10,7 @@ LWBINDSRC = \
 
 # Add blocks of files from Filelists.mk as required for enabled options
 LWSRC_REQUIRED = $(COREFILES) $(CORE4FILES) $(APIFILES) $(LWBINDSRC) $(NETIFFILES)
-LWSRC_EXTRAS ?= $(HTTPFILES)
+LWSRC_EXTRAS ?= $(HTTPFILES) $(MDNSFILES)
 
 LWINC = \
         $(CHIBIOS)/os/various/lwip_bindings \
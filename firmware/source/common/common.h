@@ -28,15 +28,16 @@
     } while (false)
 
 /**
- * @brief Return the \a _val if \a _op does not match it.
- * @param _op The operation to execute, or the left hand value.
+ * @brief Return the result of \a _op if it does not match \a _val.
+ * @param _op The operation to execute, or the left hand value. It is evaluated once.
  * @param _val The comparison, or right hand value.
- * @returns \a _val or nothing, in case of match.
+ * @returns The result of \a _op or nothing, in case of match.
  */
 #define RETURN_IF_NOT(_op, _val)                                                                                       \
     do {                                                                                                               \
-        if ((_op) != (_val)) {                                                                                         \
-            return (_val);                                                                                             \
+        const __typeof__(_op) _return_if_not_result = (_op);                                                           \
+        if (_return_if_not_result != (_val)) {                                                                         \
+            return _return_if_not_result;                                                                              \
         }                                                                                                              \
     } while (false)
 
@@ -0,0 +1,60 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   CRC calculation functions.
+ * @details Implements the reflected CRC-32 (IEEE 802.3, as used by zlib), such that checksums can be reproduced by
+ * host tools. A nibble-wise table keeps the flash footprint small.
+ *
+ * @addtogroup common
+ * @{
+ */
+
+#include "crc.h"
+
+#include "common.h"
+
+/**
+ * @brief The CRC-32 lookup table for a single nibble (reflected polynomial 0xEDB88320).
+ */
+static const uint32_t CRC_32_NIBBLE_TABLE[16] = {
+    0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu, 0x76DC4190u, 0x6B6B51F4u, 0x4DB26158u, 0x5005713Cu,
+    0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu, 0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu,
+};
+
+/**
+ * @brief Continue a CRC-32 calculation over more data.
+ *
+ * @param crc The CRC of the previous data, or \a CRC_32_INIT.
+ * @param p_data A pointer to the data.
+ * @param length The length of the data in bytes.
+ * @return uint32_t The updated CRC.
+ */
+uint32_t crc_32_update(uint32_t crc, const void *p_data, const size_t length) {
+    ASSERT_VERBOSE((p_data != NULL) || (length == 0u), "Null pointer.");
+
+    const uint8_t *p_bytes = (const uint8_t *)p_data;
+
+    crc = ~crc;
+
+    for (size_t byte_index = 0u; byte_index < length; byte_index++) {
+        crc ^= p_bytes[byte_index];
+        crc = (crc >> 4u) ^ CRC_32_NIBBLE_TABLE[crc & 0xFu];
+        crc = (crc >> 4u) ^ CRC_32_NIBBLE_TABLE[crc & 0xFu];
+    }
+
+    return ~crc;
+}
+
+/**
+ * @brief Calculate the CRC-32 of a block of data.
+ *
+ * @param p_data A pointer to the data.
+ * @param length The length of the data in bytes.
+ * @return uint32_t The CRC.
+ */
+uint32_t crc_32(const void *p_data, const size_t length) { return crc_32_update(CRC_32_INIT, p_data, length); }
+
+/**
+ * @}
+ */
@@ -0,0 +1,29 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   CRC calculation functions.
+ *
+ * @addtogroup common
+ * @{
+ */
+
+#ifndef SOURCE_COMMON_CRC_H_
+#define SOURCE_COMMON_CRC_H_
+
+#include <inttypes.h>
+#include <stddef.h>
+
+/**
+ * @brief The initial value of a CRC-32 calculation.
+ */
+#define CRC_32_INIT 0u
+
+uint32_t crc_32_update(uint32_t crc, const void *p_data, size_t length);
+uint32_t crc_32(const void *p_data, size_t length);
+
+#endif  // SOURCE_COMMON_CRC_H_
+
+/**
+ * @}
+ */
@@ -0,0 +1,45 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Memory placement attributes.
+ * @details The regions are defined in the linker script, and the sections are provided by the ChibiOS linker rules.
+ *
+ * Data that only the CPU accesses - thread stacks, packet buffers, the lwIP pools and the trace ring - is placed in
+ * the core coupled memory (CCM), which has no wait states and is not shared with the Ethernet DMA on the bus matrix.
+ * Everything that is handed to a DMA (e.g. the Ethernet MAC descriptors and buffers, or memory from the ChibiOS heap)
+ * must stay in the default sections, which are in SRAM1/2. Run "make memory_report" for the usage per region.
+ *
+ * @addtogroup common
+ * @{
+ */
+
+#ifndef SOURCE_COMMON_MEMORY_H_
+#define SOURCE_COMMON_MEMORY_H_
+
+/**
+ * @brief Place a variable in the backup SRAM (BCKP, 4 KiB).
+ * @details The section is not initialized by the startup code - its content survives resets, as long as the
+ * backup domain is powered. After a power cycle, the content is random, so it has to be validated before use.
+ */
+#define MEMORY_BACKUP_SRAM __attribute__((section(".ram5")))
+
+/**
+ * @brief Place a variable in the core coupled memory (CCM, 64 KiB).
+ * @details CCM is only accessible by the CPU - not by DMA, or the Ethernet MAC. The section is cleared by the
+ * startup code, like .bss.
+ */
+#define MEMORY_CCM __attribute__((section(".ram4_clear")))
+
+/**
+ * @brief Place a variable in the core coupled memory (CCM, 64 KiB), without initialization.
+ * @details For memory that is always written before it is read, e.g. thread working areas or memory pools, such
+ * that the startup code does not have to clear it. Like \a MEMORY_CCM, it is not accessible by DMA.
+ */
+#define MEMORY_CCM_NOINIT __attribute__((section(".ram4")))
+
+#endif  // SOURCE_COMMON_MEMORY_H_
+
+/**
+ * @}
+ */
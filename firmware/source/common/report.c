@@ -0,0 +1,36 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Report output functions.
+ * @details Reports (e.g. statistics and histograms) are formatted once, and written to any output that provides a
+ * formatted output callback, such that the GDB console and the shell show the same content.
+ *
+ * @addtogroup common
+ * @{
+ */
+
+#include "report.h"
+
+#include "common.h"
+
+/**
+ * @brief Write formatted output to a report output.
+ *
+ * @param p_output A pointer to the report output.
+ * @param p_format A pointer to the format string.
+ */
+void report_printf(const struct report_output* p_output, const char* p_format, ...) {
+    ASSERT_PTR_NOT_NULL(p_output);
+    ASSERT_PTR_NOT_NULL(p_output->p_vprintf_cb);
+
+    va_list arguments;
+
+    va_start(arguments, p_format);
+    p_output->p_vprintf_cb(p_output->p_context, p_format, arguments);
+    va_end(arguments);
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,36 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Report output functions.
+ *
+ * @addtogroup common
+ * @{
+ */
+
+#ifndef SOURCE_COMMON_REPORT_H_
+#define SOURCE_COMMON_REPORT_H_
+
+#include <stdarg.h>
+
+/**
+ * @brief A formatted output callback. Each call writes whole lines, terminated with '\\n'.
+ */
+typedef void (*p_report_vprintf_cb_t)(void* p_context, const char* p_format, va_list arguments);
+
+/**
+ * @brief An output, to which reports are written - e.g. the GDB console, or the shell.
+ */
+struct report_output {
+    p_report_vprintf_cb_t p_vprintf_cb;  ///< The formatted output callback.
+    void*                 p_context;     ///< The context of the output, e.g. the GDB session.
+};
+
+void report_printf(const struct report_output* p_output, const char* p_format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+#endif  // SOURCE_COMMON_REPORT_H_
+
+/**
+ * @}
+ */
@@ -0,0 +1,777 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The configuration store module.
+ * @details Keeps the probe settings in a reserved flash sector (sector 7, see STM32F407xE.ld). The sector holds a
+ * header, followed by a log of records. Every change appends a record with the key, the value and a CRC, and the
+ * latest valid record of a key wins. A record without value resets the key to its default.
+ *
+ * Appending spreads the writes over the whole sector, which is only erased when it runs full. The live values are then
+ * written back, as the start of a new log. A power loss during that window loses the settings, and the defaults apply.
+ * Programming and erasing stall all code fetches from flash - erasing takes up to a few seconds.
+ *
+ * On boot, the log is replayed into RAM once. Reading a setting is an array access, so nothing reads flash at runtime.
+ *
+ * @addtogroup config
+ * @{
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/crc.h"
+#include "network/network.h"
+#include "network/network_benchmark.h"
+#include "network/network_gdb_udp.h"
+#include "network/network_power.h"
+#include "network/network_recorder.h"
+#include "network/network_startup.h"
+#include "network/network_telemetry.h"
+#include "network/network_trace.h"
+
+#if CONFIG_ENABLE == TRUE
+
+/**
+ * @brief The flash sector of the store.
+ */
+#define CONFIG_FLASH_SECTOR 7u
+
+/**
+ * @brief The magic number of the sector header ("CFG1").
+ */
+#define CONFIG_MAGIC 0x31474643u
+
+/**
+ * @brief The value of erased flash.
+ */
+#define CONFIG_ERASED_WORD 0xFFFFFFFFu
+
+/**
+ * @brief The flash controller unlock sequence.
+ */
+#define CONFIG_FLASH_KEY_1 0x45670123u
+#define CONFIG_FLASH_KEY_2 0xCDEF89ABu
+
+/**
+ * @brief The flash controller error flags.
+ */
+#define CONFIG_FLASH_ERRORS (FLASH_SR_PGSERR | FLASH_SR_PGPERR | FLASH_SR_PGAERR | FLASH_SR_WRPERR)
+
+/**
+ * @brief Round a size up to full flash words.
+ */
+#define CONFIG_WORD_ALIGN(_size) (((_size) + 3u) & ~(size_t)3u)
+
+/**
+ * @brief The largest record: key and length, the value, and the CRC.
+ */
+#define CONFIG_RECORD_MAX_SIZE (sizeof(struct config_record_header) + CONFIG_STRING_SIZE + sizeof(uint32_t))
+
+/**
+ * @brief The limits of the store, as provided by the linker script.
+ */
+extern uint8_t __config_store_base__[];
+extern uint8_t __config_store_end__[];
+
+/**
+ * @brief The types of settings.
+ */
+enum config_type {
+    CONFIG_TYPE_U32,     ///< An unsigned number within limits.
+    CONFIG_TYPE_IPV4,    ///< An IPv4 address in dotted notation, stored in host byte order.
+    CONFIG_TYPE_STRING,  ///< A string.
+    CONFIG_TYPE_CHOICE,  ///< One of a list of names, stored as its index.
+};
+
+/**
+ * @brief The description of a setting.
+ */
+struct config_entry {
+    const char*        p_name;            ///< The name, as used by the monitor and shell commands.
+    enum config_type   type;              ///< The type.
+    uint32_t           default_u32;       ///< The default of a number, address or choice.
+    const char*        p_default_string;  ///< The default of a string.
+    uint32_t           min;               ///< The minimum of a number.
+    uint32_t           max;               ///< The maximum of a number, or the number of choices.
+    const char* const* p_choices;         ///< The names of the choices.
+};
+
+/**
+ * @brief The header at the start of the flash sector.
+ */
+struct config_sector_header {
+    uint32_t magic;        ///< The magic number \a CONFIG_MAGIC.
+    uint32_t erase_count;  ///< The number of times that the sector was erased.
+    uint32_t crc;          ///< The CRC of the preceding members.
+};
+
+/**
+ * @brief The header of a record, followed by the value (padded to full words), and the CRC of header and value.
+ */
+struct config_record_header {
+    uint16_t key;     ///< The key of the setting.
+    uint16_t length;  ///< The length of the value, or zero for resetting the setting to its default.
+};
+
+/**
+ * @brief A setting value in RAM.
+ */
+union config_value {
+    uint32_t u32;                         ///< A number, address or choice.
+    char     string[CONFIG_STRING_SIZE];  ///< A zero-terminated string.
+};
+
+/**
+ * @brief The names of the network address modes, in the order of \a enum network_address_mode.
+ */
+static const char* const G_CONFIG_ADDRESS_MODE_NAMES[] = {
+    [NETWORK_ADDRESS_MODE_STATIC]          = "static",
+    [NETWORK_ADDRESS_MODE_DHCP]            = "dhcp",
+    [NETWORK_ADDRESS_MODE_DHCP_STATIC]     = "dhcp-static",
+    [NETWORK_ADDRESS_MODE_DHCP_LINK_LOCAL] = "dhcp-link-local",
+};
+
+/**
+ * @brief The descriptions of all settings, indexed by key.
+ */
+static const struct config_entry G_CONFIG_ENTRIES[CONFIG_KEY_COUNT] = {
+    [CONFIG_KEY_ADDRESS_MODE]     = {"address_mode", CONFIG_TYPE_CHOICE, NETWORK_ADDRESS_MODE, NULL, 0u,
+                                     ARRAY_LENGTH(G_CONFIG_ADDRESS_MODE_NAMES), G_CONFIG_ADDRESS_MODE_NAMES},
+    [CONFIG_KEY_STATIC_ADDRESS]   = {"address", CONFIG_TYPE_IPV4, NETWORK_STATIC_ADDRESS, NULL, 0u, 0u, NULL},
+    [CONFIG_KEY_STATIC_NETMASK]   = {"netmask", CONFIG_TYPE_IPV4, NETWORK_STATIC_NETMASK, NULL, 0u, 0u, NULL},
+    [CONFIG_KEY_STATIC_GATEWAY]   = {"gateway", CONFIG_TYPE_IPV4, NETWORK_STATIC_GATEWAY, NULL, 0u, 0u, NULL},
+    [CONFIG_KEY_DHCP_TIMEOUT_MS]  = {"dhcp_timeout_ms", CONFIG_TYPE_U32, NETWORK_DHCP_TIMEOUT_MS, NULL, 100u, 60000u,
+                                     NULL},
+    [CONFIG_KEY_HOSTNAME]         = {"hostname", CONFIG_TYPE_STRING, 0u, LWIP_NETIF_HOSTNAME_STRING, 0u, 0u, NULL},
+    [CONFIG_KEY_SWD_FREQUENCY_HZ] = {"swd_frequency_hz", CONFIG_TYPE_U32, CONFIG_DEFAULT_SWD_FREQUENCY_HZ, NULL, 1000u,
+                                     STM32_SYSCLK / 2u, NULL},
+    [CONFIG_KEY_GDB_PORT]         = {"gdb_port", CONFIG_TYPE_U32, NETWORK_FIRST_TCP_PORT, NULL, 1u, UINT16_MAX, NULL},
+    [CONFIG_KEY_TELEMETRY_PORT]   = {"telemetry_port", CONFIG_TYPE_U32, NETWORK_TELEMETRY_UDP_PORT, NULL, 1u,
+                                     UINT16_MAX, NULL},
+    [CONFIG_KEY_TRACE_PORT]       = {"trace_port", CONFIG_TYPE_U32, NETWORK_TRACE_TCP_PORT, NULL, 1u, UINT16_MAX, NULL},
+    [CONFIG_KEY_BENCHMARK_PORT]   = {"benchmark_port", CONFIG_TYPE_U32, NETWORK_BENCHMARK_TCP_PORT, NULL, 1u,
+                                     UINT16_MAX, NULL},
+    [CONFIG_KEY_GDB_UDP_PORT]     = {"gdb_udp_port", CONFIG_TYPE_U32, NETWORK_GDB_UDP_PORT, NULL, 1u, UINT16_MAX,
+                                     NULL},
+    [CONFIG_KEY_POWER_PORT]       = {"power_port", CONFIG_TYPE_U32, NETWORK_POWER_TCP_PORT, NULL, 1u, UINT16_MAX, NULL},
+    [CONFIG_KEY_RECORDER_PORT]    = {"recorder_port", CONFIG_TYPE_U32, NETWORK_RECORDER_TCP_PORT, NULL, 1u, UINT16_MAX,
+                                     NULL},
+    [CONFIG_KEY_UART_BAUD_RATE]   = {"uart_baud_rate", CONFIG_TYPE_U32, RECORDER_UART_BAUD_RATE, NULL, 1200u, 2000000u,
+                                     NULL},
+};
+
+/**
+ * @brief The state of the store.
+ */
+static struct {
+    union config_value values[CONFIG_KEY_COUNT];  ///< The current values, indexed by key.
+    size_t             write_offset;              ///< The offset of the next record in the sector.
+    uint32_t           erase_count;               ///< The number of times that the sector was erased.
+    bool               b_compaction_required;     ///< True, if the log has to be rewritten before appending.
+} g_config;
+
+/**
+ * @brief Serializes changes, which may come from the GDB session and the shell.
+ */
+static MUTEX_DECL(g_config_mutex);
+
+/**
+ * @brief Get the size of the flash sector of the store.
+ *
+ * @return size_t The size in bytes.
+ */
+static inline size_t config_get_sector_size(void) { return (size_t)(__config_store_end__ - __config_store_base__); }
+
+/**
+ * @brief Read a word from the flash sector of the store.
+ *
+ * @param offset The offset within the sector.
+ * @return uint32_t The word.
+ */
+static inline uint32_t config_flash_read_word(size_t offset) {
+    uint32_t word;
+
+    memcpy(&word, &__config_store_base__[offset], sizeof(word));
+    return word;
+}
+
+/**
+ * @brief Wait for the flash controller, and check the result of the last operation.
+ *
+ * @return bool True, if the operation succeeded.
+ */
+static bool config_flash_wait(void) {
+    while ((FLASH->SR & FLASH_SR_BSY) != 0u) {
+    }
+
+    const uint32_t ERRORS = FLASH->SR & CONFIG_FLASH_ERRORS;
+
+    FLASH->SR = ERRORS;
+    return (ERRORS == 0u);
+}
+
+/**
+ * @brief Unlock the flash controller, and clear stale error flags.
+ */
+static void config_flash_unlock(void) {
+    if ((FLASH->CR & FLASH_CR_LOCK) != 0u) {
+        FLASH->KEYR = CONFIG_FLASH_KEY_1;
+        FLASH->KEYR = CONFIG_FLASH_KEY_2;
+    }
+
+    FLASH->SR = CONFIG_FLASH_ERRORS;
+}
+
+/**
+ * @brief Lock the flash controller, and discard cached flash content, which may be stale now.
+ */
+static void config_flash_lock(void) {
+    FLASH->CR |= FLASH_CR_LOCK;
+
+    FLASH->ACR &= ~FLASH_ACR_DCEN;
+    FLASH->ACR |= FLASH_ACR_DCRST;
+    FLASH->ACR &= ~FLASH_ACR_DCRST;
+    FLASH->ACR |= FLASH_ACR_DCEN;
+}
+
+/**
+ * @brief Erase the flash sector of the store. The controller must be unlocked.
+ *
+ * @return bool True, if the sector was erased.
+ */
+static bool config_flash_erase(void) {
+    (void)config_flash_wait();
+
+    FLASH->CR &= ~(FLASH_CR_PSIZE | FLASH_CR_SNB);
+    FLASH->CR |= FLASH_CR_PSIZE_1 | (CONFIG_FLASH_SECTOR << FLASH_CR_SNB_Pos) | FLASH_CR_SER;
+    FLASH->CR |= FLASH_CR_STRT;
+
+    const bool B_SUCCESS = config_flash_wait();
+
+    FLASH->CR &= ~(FLASH_CR_SER | FLASH_CR_SNB);
+    return B_SUCCESS;
+}
+
+/**
+ * @brief Program words into the flash sector of the store. The controller must be unlocked.
+ *
+ * @param offset The word-aligned offset within the sector.
+ * @param p_data A pointer to the data.
+ * @param size The size of the data, a multiple of words.
+ * @return bool True, if all words were programmed.
+ */
+static bool config_flash_program(size_t offset, const void* p_data, size_t size) {
+    const uint8_t* p_bytes   = (const uint8_t*)p_data;
+    bool           b_success = true;
+
+    FLASH->CR &= ~FLASH_CR_PSIZE;
+    FLASH->CR |= FLASH_CR_PSIZE_1 | FLASH_CR_PG;
+
+    for (size_t word_offset = 0u; b_success && (word_offset < size); word_offset += sizeof(uint32_t)) {
+        uint32_t word;
+
+        memcpy(&word, &p_bytes[word_offset], sizeof(word));
+        *(volatile uint32_t*)(void*)&__config_store_base__[offset + word_offset] = word;
+        __DSB();
+
+        b_success = config_flash_wait();
+    }
+
+    FLASH->CR &= ~FLASH_CR_PG;
+    return b_success;
+}
+
+/**
+ * @brief Get the CRC of a sector header.
+ *
+ * @param p_header A pointer to the header.
+ * @return uint32_t The CRC.
+ */
+static uint32_t config_get_header_crc(const struct config_sector_header* p_header) {
+    return crc_32(p_header, offsetof(struct config_sector_header, crc));
+}
+
+/**
+ * @brief Reset a setting in RAM to its default.
+ *
+ * @param key The key of the setting.
+ */
+static void config_set_default(enum config_key key) {
+    const struct config_entry* p_entry = &G_CONFIG_ENTRIES[key];
+    union config_value*        p_value = &g_config.values[key];
+
+    memset(p_value, 0, sizeof(*p_value));
+
+    if (p_entry->type == CONFIG_TYPE_STRING) {
+        strncpy(p_value->string, p_entry->p_default_string, CONFIG_STRING_SIZE - 1u);
+    } else {
+        p_value->u32 = p_entry->default_u32;
+    }
+}
+
+/**
+ * @brief Check, if a setting holds its default value.
+ *
+ * @param key The key of the setting.
+ * @return bool True, if the value is the default.
+ */
+static bool config_is_default(enum config_key key) {
+    const struct config_entry* p_entry = &G_CONFIG_ENTRIES[key];
+    const union config_value*  p_value = &g_config.values[key];
+
+    if (p_entry->type == CONFIG_TYPE_STRING) {
+        return (0 == strcmp(p_value->string, p_entry->p_default_string));
+    }
+
+    return (p_value->u32 == p_entry->default_u32);
+}
+
+/**
+ * @brief Apply the value of a valid record to a setting in RAM.
+ *
+ * @param key The key of the setting.
+ * @param p_data A pointer to the value.
+ * @param length The length of the value, or zero for the default.
+ */
+static void config_apply_record(enum config_key key, const uint8_t* p_data, size_t length) {
+    union config_value* p_value = &g_config.values[key];
+
+    if (length == 0u) {
+        config_set_default(key);
+    } else if (G_CONFIG_ENTRIES[key].type == CONFIG_TYPE_STRING) {
+        if (length < CONFIG_STRING_SIZE) {
+            memset(p_value, 0, sizeof(*p_value));
+            memcpy(p_value->string, p_data, length);
+        }
+    } else if (length == sizeof(uint32_t)) {
+        memcpy(&p_value->u32, p_data, sizeof(uint32_t));
+    }
+}
+
+/**
+ * @brief Replay the log in the flash sector into RAM.
+ * @details Replay stops at erased flash, or at the first invalid record, e.g. one that was cut short by a power loss.
+ * In the latter case, the end of the log is unknown, and it has to be rewritten before appending.
+ */
+static void config_load(void) {
+    const size_t                SECTOR_SIZE = config_get_sector_size();
+    struct config_sector_header header;
+
+    memcpy(&header, __config_store_base__, sizeof(header));
+
+    if ((header.magic != CONFIG_MAGIC) || (header.crc != config_get_header_crc(&header))) {
+        // Blank or foreign sector.
+        g_config.b_compaction_required = true;
+        return;
+    }
+
+    size_t offset = sizeof(header);
+
+    g_config.erase_count = header.erase_count;
+
+    while ((offset + sizeof(struct config_record_header) + sizeof(uint32_t)) <= SECTOR_SIZE) {
+        if (config_flash_read_word(offset) == CONFIG_ERASED_WORD) {
+            break;
+        }
+
+        struct config_record_header record;
+        memcpy(&record, &__config_store_base__[offset], sizeof(record));
+
+        const size_t VALUE_SIZE  = CONFIG_WORD_ALIGN((size_t)record.length);
+        const size_t RECORD_SIZE = sizeof(record) + VALUE_SIZE + sizeof(uint32_t);
+
+        if ((record.length > CONFIG_STRING_SIZE) || ((offset + RECORD_SIZE) > SECTOR_SIZE) ||
+            (config_flash_read_word(offset + RECORD_SIZE - sizeof(uint32_t)) !=
+             crc_32(&__config_store_base__[offset], sizeof(record) + record.length))) {
+            g_config.b_compaction_required = true;
+            break;
+        }
+
+        // Keys that this firmware does not know are skipped, and dropped by the next compaction.
+        if (record.key < CONFIG_KEY_COUNT) {
+            config_apply_record((enum config_key)record.key, &__config_store_base__[offset + sizeof(record)],
+                                record.length);
+        }
+
+        offset += RECORD_SIZE;
+    }
+
+    g_config.write_offset = offset;
+}
+
+/**
+ * @brief Append a record for the current value of a setting. The controller must be unlocked.
+ *
+ * @param key The key of the setting.
+ * @param b_default True, for storing a reset to the default.
+ * @return bool True, if the record was written.
+ */
+static bool config_append(enum config_key key, bool b_default) {
+    uint8_t                     buffer[CONFIG_RECORD_MAX_SIZE];
+    const union config_value*   p_value = &g_config.values[key];
+    struct config_record_header record  = {.key = (uint16_t)key, .length = 0u};
+
+    if (!b_default) {
+        record.length = (G_CONFIG_ENTRIES[key].type == CONFIG_TYPE_STRING) ? (uint16_t)strlen(p_value->string)
+                                                                            : (uint16_t)sizeof(uint32_t);
+    }
+
+    const size_t VALUE_SIZE  = CONFIG_WORD_ALIGN((size_t)record.length);
+    const size_t RECORD_SIZE = sizeof(record) + VALUE_SIZE + sizeof(uint32_t);
+
+    if ((g_config.write_offset + RECORD_SIZE) > config_get_sector_size()) {
+        return false;
+    }
+
+    memset(buffer, 0, sizeof(buffer));
+    memcpy(buffer, &record, sizeof(record));
+    memcpy(&buffer[sizeof(record)], p_value, record.length);
+
+    const uint32_t CRC = crc_32(buffer, sizeof(record) + record.length);
+    memcpy(&buffer[sizeof(record) + VALUE_SIZE], &CRC, sizeof(CRC));
+
+    // The CRC is programmed last, so a record that is cut short never validates.
+    if (!config_flash_program(g_config.write_offset, buffer, RECORD_SIZE)) {
+        return false;
+    }
+
+    g_config.write_offset += RECORD_SIZE;
+    return true;
+}
+
+/**
+ * @brief Erase the sector, and start a new log with all settings that differ from their defaults.
+ * The controller must be unlocked.
+ *
+ * @return bool True, if the log was rewritten.
+ */
+static bool config_compact(void) {
+    struct config_sector_header header = {.magic = CONFIG_MAGIC, .erase_count = g_config.erase_count + 1u};
+
+    header.crc = config_get_header_crc(&header);
+
+    if (!config_flash_erase()) {
+        return false;
+    }
+
+    g_config.erase_count  = header.erase_count;
+    g_config.write_offset = sizeof(header);
+
+    if (!config_flash_program(0u, &header, sizeof(header))) {
+        return false;
+    }
+
+    g_config.b_compaction_required = false;
+
+    for (size_t key = 0u; key < CONFIG_KEY_COUNT; key++) {
+        if (!config_is_default((enum config_key)key)) {
+            if (!config_append((enum config_key)key, false)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Store the current value of a setting, and compact the log, if required.
+ *
+ * @param key The key of the setting.
+ * @param b_default True, for storing a reset to the default.
+ * @return bool True, if the setting was stored.
+ */
+static bool config_store(enum config_key key, bool b_default) {
+    bool b_success;
+
+    config_flash_unlock();
+
+    if (g_config.b_compaction_required) {
+        b_success = config_compact();
+    } else {
+        // A full sector is compacted, which also stores the new value.
+        b_success = config_append(key, b_default) || config_compact();
+    }
+
+    config_flash_lock();
+    return b_success;
+}
+
+/**
+ * @brief Parse an IPv4 address in dotted notation.
+ *
+ * @param p_text A pointer to the text.
+ * @param p_address A pointer to the address in host byte order.
+ * @return bool True, if the text is a valid address.
+ */
+static bool config_parse_ipv4(const char* p_text, uint32_t* p_address) {
+    uint32_t address = 0u;
+
+    for (size_t part_index = 0u; part_index < 4u; part_index++) {
+        char*               p_end = NULL;
+        const unsigned long PART  = strtoul(p_text, &p_end, 10);
+
+        if ((p_end == p_text) || (PART > UINT8_MAX) || (*p_end != ((part_index < 3u) ? '.' : '\0'))) {
+            return false;
+        }
+
+        address = (address << 8u) | (uint32_t)PART;
+        p_text  = p_end + 1;
+    }
+
+    *p_address = address;
+    return true;
+}
+
+/**
+ * @brief Parse the text of a setting value.
+ *
+ * @param key The key of the setting.
+ * @param p_text A pointer to the text.
+ * @param p_value A pointer to the parsed value.
+ * @return bool True, if the text is valid for the setting.
+ */
+static bool config_parse(enum config_key key, const char* p_text, union config_value* p_value) {
+    const struct config_entry* p_entry = &G_CONFIG_ENTRIES[key];
+
+    memset(p_value, 0, sizeof(*p_value));
+
+    switch (p_entry->type) {
+        case CONFIG_TYPE_U32: {
+            char*               p_end = NULL;
+            const unsigned long VALUE = strtoul(p_text, &p_end, 0);
+
+            if ((p_end == p_text) || (*p_end != '\0') || (VALUE < p_entry->min) || (VALUE > p_entry->max)) {
+                return false;
+            }
+
+            p_value->u32 = (uint32_t)VALUE;
+            return true;
+        }
+
+        case CONFIG_TYPE_IPV4:
+            return config_parse_ipv4(p_text, &p_value->u32);
+
+        case CONFIG_TYPE_STRING:
+            if ((strlen(p_text) == 0u) || (strlen(p_text) >= CONFIG_STRING_SIZE)) {
+                return false;
+            }
+
+            strncpy(p_value->string, p_text, CONFIG_STRING_SIZE - 1u);
+            return true;
+
+        case CONFIG_TYPE_CHOICE:
+            for (uint32_t choice_index = 0u; choice_index < p_entry->max; choice_index++) {
+                if (0 == strcmp(p_text, p_entry->p_choices[choice_index])) {
+                    p_value->u32 = choice_index;
+                    return true;
+                }
+            }
+            return false;
+
+        default:
+            ASSERT_NOT_REACHED();
+            return false;
+    }
+}
+
+/**
+ * @brief Load the settings from flash. Must be called before any setting is read.
+ */
+void config_init(void) {
+    for (size_t key = 0u; key < CONFIG_KEY_COUNT; key++) {
+        config_set_default((enum config_key)key);
+    }
+
+    config_load();
+}
+
+/**
+ * @brief Get the value of a number, address or choice setting.
+ *
+ * @param key The key of the setting.
+ * @return uint32_t The value.
+ */
+uint32_t config_get_u32(enum config_key key) {
+    ASSERT_VERBOSE((key < CONFIG_KEY_COUNT) && (G_CONFIG_ENTRIES[key].type != CONFIG_TYPE_STRING), "Invalid key.");
+    return g_config.values[key].u32;
+}
+
+/**
+ * @brief Get the value of a string setting.
+ *
+ * @param key The key of the setting.
+ * @return const char* A pointer to the zero-terminated value.
+ */
+const char* config_get_string(enum config_key key) {
+    ASSERT_VERBOSE((key < CONFIG_KEY_COUNT) && (G_CONFIG_ENTRIES[key].type == CONFIG_TYPE_STRING), "Invalid key.");
+    return g_config.values[key].string;
+}
+
+/**
+ * @brief Get the name of a setting.
+ *
+ * @param key The key of the setting.
+ * @return const char* A pointer to the name.
+ */
+const char* config_get_name(enum config_key key) {
+    ASSERT_VERBOSE(key < CONFIG_KEY_COUNT, "Invalid key.");
+    return G_CONFIG_ENTRIES[key].p_name;
+}
+
+/**
+ * @brief Find a setting by its name.
+ *
+ * @param p_name A pointer to the name.
+ * @param p_key A pointer to the key that is found.
+ * @return bool True, if the setting exists.
+ */
+bool config_find_key(const char* p_name, enum config_key* p_key) {
+    ASSERT_PTR_NOT_NULL(p_name);
+    ASSERT_PTR_NOT_NULL(p_key);
+
+    for (size_t key = 0u; key < CONFIG_KEY_COUNT; key++) {
+        if (0 == strcmp(p_name, G_CONFIG_ENTRIES[key].p_name)) {
+            *p_key = (enum config_key)key;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Format the value of a setting as text, in the format that \a config_set accepts.
+ *
+ * @param key The key of the setting.
+ * @param p_buffer A pointer to the buffer for the text.
+ * @param size The size of the buffer.
+ */
+void config_format(enum config_key key, char* p_buffer, size_t size) {
+    ASSERT_VERBOSE(key < CONFIG_KEY_COUNT, "Invalid key.");
+    ASSERT_PTR_NOT_NULL(p_buffer);
+
+    const struct config_entry* p_entry = &G_CONFIG_ENTRIES[key];
+    const uint32_t             VALUE   = g_config.values[key].u32;
+
+    switch (p_entry->type) {
+        case CONFIG_TYPE_U32:
+            SNPRINTF(p_buffer, size, "%lu", (unsigned long)VALUE);
+            break;
+
+        case CONFIG_TYPE_IPV4:
+            SNPRINTF(p_buffer, size, "%u.%u.%u.%u", (unsigned int)((VALUE >> 24u) & 0xFFu),
+                     (unsigned int)((VALUE >> 16u) & 0xFFu), (unsigned int)((VALUE >> 8u) & 0xFFu),
+                     (unsigned int)(VALUE & 0xFFu));
+            break;
+
+        case CONFIG_TYPE_STRING:
+            SNPRINTF(p_buffer, size, "%s", g_config.values[key].string);
+            break;
+
+        case CONFIG_TYPE_CHOICE:
+            SNPRINTF(p_buffer, size, "%s", (VALUE < p_entry->max) ? p_entry->p_choices[VALUE] : "?");
+            break;
+
+        default:
+            ASSERT_NOT_REACHED();
+            break;
+    }
+}
+
+/**
+ * @brief Change a setting, and store it in flash. Most settings take effect after the next reset.
+ *
+ * @param key The key of the setting.
+ * @param p_value A pointer to the value text, or NULL for resetting the setting to its default.
+ * @return enum config_result The result.
+ */
+enum config_result config_set(enum config_key key, const char* p_value) {
+    ASSERT_VERBOSE(key < CONFIG_KEY_COUNT, "Invalid key.");
+
+    union config_value value;
+
+    if ((p_value != NULL) && !config_parse(key, p_value, &value)) {
+        return CONFIG_RESULT_INVALID_VALUE;
+    }
+
+    chMtxLock(&g_config_mutex);
+
+    chSysLock();
+    if (p_value == NULL) {
+        config_set_default(key);
+    } else {
+        g_config.values[key] = value;
+    }
+    chSysUnlock();
+
+    const bool B_STORED = config_store(key, p_value == NULL);
+
+    chMtxUnlock(&g_config_mutex);
+
+    return B_STORED ? CONFIG_RESULT_OK : CONFIG_RESULT_FLASH_ERROR;
+}
+
+/**
+ * @brief Reset all settings to their defaults, and erase the stored ones.
+ *
+ * @return enum config_result The result.
+ */
+enum config_result config_reset(void) {
+    chMtxLock(&g_config_mutex);
+
+    chSysLock();
+    for (size_t key = 0u; key < CONFIG_KEY_COUNT; key++) {
+        config_set_default((enum config_key)key);
+    }
+    chSysUnlock();
+
+    config_flash_unlock();
+    const bool B_COMPACTED = config_compact();
+    config_flash_lock();
+
+    chMtxUnlock(&g_config_mutex);
+
+    return B_COMPACTED ? CONFIG_RESULT_OK : CONFIG_RESULT_FLASH_ERROR;
+}
+
+/**
+ * @brief Get the usage of the flash sector of the store.
+ *
+ * @param p_usage A pointer to the usage to fill.
+ */
+void config_get_usage(struct config_usage* p_usage) {
+    ASSERT_PTR_NOT_NULL(p_usage);
+
+    p_usage->used_size   = g_config.write_offset;
+    p_usage->size        = config_get_sector_size();
+    p_usage->erase_count = g_config.erase_count;
+}
+
+/**
+ * @brief Get a message that describes the result of changing a setting.
+ *
+ * @param result The result.
+ * @return const char* A pointer to the message.
+ */
+const char* config_get_result_message(enum config_result result) {
+    switch (result) {
+        case CONFIG_RESULT_OK:
+            return "Stored. Network settings take effect after a reset.";
+        case CONFIG_RESULT_INVALID_VALUE:
+            return "Invalid value.";
+        case CONFIG_RESULT_FLASH_ERROR:
+            return "Changed, but writing to flash failed.";
+        default:
+            return "Unknown result.";
+    }
+}
+
+#endif  // CONFIG_ENABLE == TRUE
+
+/**
+ * @}
+ */
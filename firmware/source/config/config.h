@@ -0,0 +1,96 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The configuration store module headers.
+ *
+ * @addtogroup config
+ * @{
+ */
+
+#ifndef SOURCE_CONFIG_CONFIG_H_
+#define SOURCE_CONFIG_CONFIG_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/common.h"
+
+/**
+ * @brief Enables the configuration store. It requires the flash of the STM32, so the host build leaves it disabled.
+ */
+#ifndef CONFIG_ENABLE
+#define CONFIG_ENABLE FALSE
+#endif
+
+/**
+ * @brief The maximum length of a string setting, including the terminator.
+ */
+#define CONFIG_STRING_SIZE 32u
+
+/**
+ * @brief The default SWD clock frequency.
+ */
+#ifndef CONFIG_DEFAULT_SWD_FREQUENCY_HZ
+#define CONFIG_DEFAULT_SWD_FREQUENCY_HZ 4000000u
+#endif
+
+/**
+ * @brief The settings in the store. The values are persistent identifiers in flash - only append new keys.
+ */
+enum config_key {
+    CONFIG_KEY_ADDRESS_MODE,      ///< The network address mode (see \a enum network_address_mode).
+    CONFIG_KEY_STATIC_ADDRESS,    ///< The static IPv4 address.
+    CONFIG_KEY_STATIC_NETMASK,    ///< The static IPv4 netmask.
+    CONFIG_KEY_STATIC_GATEWAY,    ///< The static IPv4 gateway.
+    CONFIG_KEY_DHCP_TIMEOUT_MS,   ///< The time until falling back from DHCP.
+    CONFIG_KEY_HOSTNAME,          ///< The host name, as announced by DHCP and mDNS.
+    CONFIG_KEY_SWD_FREQUENCY_HZ,  ///< The default SWD clock frequency.
+    CONFIG_KEY_GDB_PORT,          ///< The GDB TCP port.
+    CONFIG_KEY_TELEMETRY_PORT,    ///< The telemetry UDP port.
+    CONFIG_KEY_TRACE_PORT,        ///< The trace TCP port.
+    CONFIG_KEY_BENCHMARK_PORT,    ///< The benchmark TCP port.
+    CONFIG_KEY_GDB_UDP_PORT,      ///< The GDB UDP port.
+    CONFIG_KEY_POWER_PORT,        ///< The power profile TCP port.
+    CONFIG_KEY_RECORDER_PORT,     ///< The recorder TCP port.
+    CONFIG_KEY_UART_BAUD_RATE,    ///< The baud rate of the target serial port.
+    CONFIG_KEY_COUNT
+};
+
+/**
+ * @brief The results of changing a setting.
+ */
+enum config_result {
+    CONFIG_RESULT_OK,             ///< The setting was changed, and stored.
+    CONFIG_RESULT_INVALID_VALUE,  ///< The value could not be parsed, or is out of range.
+    CONFIG_RESULT_FLASH_ERROR,    ///< The setting was changed in RAM, but storing it failed.
+};
+
+/**
+ * @brief The usage of the flash sector of the store.
+ */
+struct config_usage {
+    size_t   used_size;    ///< The number of bytes that are used by the log.
+    size_t   size;         ///< The size of the flash sector.
+    uint32_t erase_count;  ///< The number of times that the sector was erased.
+};
+
+#if CONFIG_ENABLE == TRUE
+void               config_init(void);
+uint32_t           config_get_u32(enum config_key key);
+const char*        config_get_string(enum config_key key);
+const char*        config_get_name(enum config_key key);
+bool               config_find_key(const char* p_name, enum config_key* p_key);
+void               config_format(enum config_key key, char* p_buffer, size_t size);
+enum config_result config_set(enum config_key key, const char* p_value);
+enum config_result config_reset(void);
+void               config_get_usage(struct config_usage* p_usage);
+const char*        config_get_result_message(enum config_result result);
+#endif
+
+#endif  // SOURCE_CONFIG_CONFIG_H_
+
+/**
+ * @}
+ */
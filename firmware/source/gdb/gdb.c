@@ -14,7 +14,10 @@
 
 #include <string.h>
 
+#include "common/hex.h"
+#include "perf/perf.h"
 #include "query/gdb_query.h"
+#include "v/gdb_v.h"
 
 /**
  * @brief Extract arguments from the input packet of a GDB session.
@@ -49,6 +52,208 @@ enum gdb_result gdb_get_args(char* p_string, size_t* p_argc, const char** pp_arg
     return GDB_RESULT_OK;
 }
 
+/**
+ * @brief Get the attached target of a session. Replies with an error, if there is none.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @return target_s* A pointer to the target, or NULL, if none is attached.
+ */
+static target_s* gdb_get_target(struct gdb_session* p_gdb_session) {
+    if (p_gdb_session->p_target == NULL) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_FF);
+    }
+
+    return p_gdb_session->p_target;
+}
+
+/**
+ * @brief Get the payload of the input packet of a session.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param p_payload_length A pointer to the payload length to set.
+ * @return char* A pointer to the payload.
+ */
+static char* gdb_get_payload(struct gdb_session* p_gdb_session, size_t* p_payload_length) {
+    *p_payload_length = gdb_packet_get_payload_length(&p_gdb_session->input_packet);
+    return gdb_packet_get_buffer_payload(&p_gdb_session->input_packet);
+}
+
+/**
+ * @brief Get the data section of the input packet of a session, which follows the first separator character.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param separator The character that separates the data from the command.
+ * @param p_data_length A pointer to the data length to set.
+ * @return char* A pointer to the data, or NULL, if the separator was not found.
+ */
+char* gdb_get_data(struct gdb_session* p_gdb_session, char separator, size_t* p_data_length) {
+    ASSERT_PTR_NOT_NULL(p_gdb_session);
+    ASSERT_PTR_NOT_NULL(p_data_length);
+
+    size_t payload_length = 0u;
+    char*  p_payload      = gdb_get_payload(p_gdb_session, &payload_length);
+    char*  p_separator    = memchr(p_payload, separator, payload_length);
+
+    if (p_separator == NULL) {
+        return NULL;
+    }
+
+    char* p_data   = p_separator + 1u;
+    *p_data_length = payload_length - (size_t)(p_data - p_payload);
+    return p_data;
+}
+
+/**
+ * @brief Reply with binary data, encoded as hex characters.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param p_data A pointer to the data.
+ * @param length The length of the data.
+ */
+static void gdb_reply_hex(struct gdb_session* p_gdb_session, const void* p_data, size_t length) {
+    struct gdb_packet* p_output_packet = &p_gdb_session->output_packet;
+
+    gdb_packet_write_start(p_output_packet);
+    gdb_packet_write_payload_binary_as_hex(p_output_packet, p_data, length);
+    gdb_packet_write_stop(p_output_packet);
+
+    gdb_session_flush(p_gdb_session);
+}
+
+/**
+ * @brief Decode hex characters into the scratch memory of a session.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param p_hex A pointer to the hex characters.
+ * @param hex_length The number of hex characters.
+ * @return size_t The number of decoded bytes.
+ */
+static size_t gdb_decode_hex(struct gdb_session* p_gdb_session, const char* p_hex, size_t hex_length) {
+    if (hex_length < 2u) {
+        return 0u;
+    }
+
+    str_from_hex((const uint8_t*)p_hex, hex_length, p_gdb_session->scratch, sizeof(p_gdb_session->scratch));
+    return hex_length / 2u;
+}
+
+/**
+ * @brief Send a string to the GDB console.
+ * @details The client only accepts console output while a monitor command is executed, or the target is running.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param p_string A pointer to the NUL-terminated string.
+ */
+void gdb_console_out(struct gdb_session* p_gdb_session, const char* p_string) {
+    ASSERT_PTR_NOT_NULL(p_gdb_session);
+    ASSERT_PTR_NOT_NULL(p_string);
+
+    struct gdb_packet* p_output_packet = &p_gdb_session->output_packet;
+
+    gdb_packet_write_start(p_output_packet);
+    gdb_packet_write_payload(p_output_packet, GDB_REPLY_CONSOLE_OUTPUT);
+    gdb_packet_write_payload_as_hex(p_output_packet, p_string);
+    gdb_packet_write_stop(p_output_packet);
+
+    gdb_session_flush(p_gdb_session);
+}
+
+/**
+ * @brief Send formatted output to the GDB console. It is truncated to \a GDB_OUTPUT_MAX_LENGTH characters.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param p_format A pointer to the format string.
+ * @param arguments The format arguments.
+ */
+void gdb_console_voutf(struct gdb_session* p_gdb_session, const char* p_format, va_list arguments) {
+    char output[GDB_OUTPUT_MAX_LENGTH];
+
+    chvsnprintf(output, ARRAY_LENGTH(output), p_format, arguments);
+    gdb_console_out(p_gdb_session, output);
+}
+
+/**
+ * @brief Send formatted output to the GDB console. It is truncated to \a GDB_OUTPUT_MAX_LENGTH characters.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param p_format A pointer to the format string.
+ */
+void gdb_console_outf(struct gdb_session* p_gdb_session, const char* p_format, ...) {
+    va_list arguments;
+
+    va_start(arguments, p_format);
+    gdb_console_voutf(p_gdb_session, p_format, arguments);
+    va_end(arguments);
+}
+
+/**
+ * @brief The report output callback of the GDB console.
+ *
+ * @param p_context A pointer to the GDB session structure.
+ * @param p_format A pointer to the format string.
+ * @param arguments The format arguments.
+ */
+static void gdb_console_report_cb(void* p_context, const char* p_format, va_list arguments) {
+    gdb_console_voutf((struct gdb_session*)p_context, p_format, arguments);
+}
+
+/**
+ * @brief Get a report output, which writes to the GDB console.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @return struct report_output The report output.
+ */
+struct report_output gdb_console_get_report_output(struct gdb_session* p_gdb_session) {
+    const struct report_output OUTPUT = {.p_vprintf_cb = gdb_console_report_cb, .p_context = p_gdb_session};
+
+    return OUTPUT;
+}
+
+/**
+ * @brief Reply with the stop reason of a target.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param halt_reason The reason for the target to halt.
+ * @param watch_address The address that triggered a watchpoint, if that is the halt reason.
+ */
+void gdb_reply_stop(struct gdb_session* p_gdb_session, target_halt_reason_e halt_reason, target_addr_t watch_address) {
+    ASSERT_PTR_NOT_NULL(p_gdb_session);
+
+    char reply[GDB_STOP_REPLY_MAX_LENGTH];
+
+    switch (halt_reason) {
+        case TARGET_HALT_ERROR:
+            // The target was lost - end the process on the client side.
+            SNPRINTF(reply, ARRAY_LENGTH(reply), "X%02X", GDB_SIGNAL_LOST);
+
+            if (p_gdb_session->p_target != NULL) {
+                target_detach(p_gdb_session->p_target);
+                p_gdb_session->p_target = NULL;
+            }
+
+            p_gdb_session->b_target_lost = false;
+            break;
+
+        case TARGET_HALT_REQUEST:
+            SNPRINTF(reply, ARRAY_LENGTH(reply), "T%02X", GDB_SIGNAL_INT);
+            break;
+
+        case TARGET_HALT_WATCHPOINT:
+            SNPRINTF(reply, ARRAY_LENGTH(reply), "T%02Xwatch:%08" PRIX32 ";", GDB_SIGNAL_TRAP, (uint32_t)watch_address);
+            break;
+
+        case TARGET_HALT_FAULT:
+            SNPRINTF(reply, ARRAY_LENGTH(reply), "T%02X", GDB_SIGNAL_SEGV);
+            break;
+
+        default:
+            SNPRINTF(reply, ARRAY_LENGTH(reply), "T%02X", GDB_SIGNAL_TRAP);
+            break;
+    }
+
+    gdb_reply(p_gdb_session, reply);
+}
+
 /**
  * @brief
  * @note The function does not take arguments from the input packet.
@@ -68,32 +273,103 @@ static void gdb_extended_remote(struct gdb_session* p_gdb_session) {
  * @param p_gdb_session A pointer to the GDB session structure.
  */
 static void gdb_stop_reason_query(struct gdb_session* p_gdb_session) {
-    // FIXME: Extract from target field.
-    bool b_target_is_running = false;
+    if (p_gdb_session->p_target == NULL) {
+        gdb_reply(p_gdb_session, "W00");
+        return;
+    }
 
-    if (p_gdb_session->properties.b_non_stop && b_target_is_running) {
+    if (p_gdb_session->properties.b_non_stop && p_gdb_session->b_target_running) {
         gdb_reply(p_gdb_session, GDB_REPLY_OK);
         return;
     }
 
-    gdb_reply(p_gdb_session, "W00");
+    gdb_reply_stop(p_gdb_session, TARGET_HALT_REQUEST, 0u);
 }
 
-static void gdb_resume_addr(struct gdb_session* p_gdb_session) { gdb_reply(p_gdb_session, GDB_REPLY_EMPTY); }
+/**
+ * @brief Resume the target. The signal and address arguments are ignored.
+ * @details There is no immediate reply - the stop reply is sent, when the target halts.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ */
+static void gdb_resume(struct gdb_session* p_gdb_session) {
+    target_s* p_target = gdb_get_target(p_gdb_session);
 
-static void gdb_resume_signal(struct gdb_session* p_gdb_session) { gdb_reply(p_gdb_session, GDB_REPLY_EMPTY); }
+    if (p_target == NULL) {
+        return;
+    }
 
-static void gdb_detach(struct gdb_session* p_gdb_session) { gdb_reply(p_gdb_session, GDB_REPLY_EMPTY); }
+    target_halt_resume(p_target, false);
+    p_gdb_session->b_target_running = true;
+}
 
 /**
- * @brief
+ * @brief Detach from the target, and let it run freely.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ */
+static void gdb_detach(struct gdb_session* p_gdb_session) {
+    if (p_gdb_session->p_target != NULL) {
+        target_detach(p_gdb_session->p_target);
+    }
+
+    p_gdb_session->p_target         = NULL;
+    p_gdb_session->b_target_running = false;
+    p_gdb_session->b_target_lost    = false;
+
+    gdb_reply(p_gdb_session, GDB_REPLY_OK);
+}
+
+/**
+ * @brief Read all general registers of the target.
  * @note The function does not take arguments from the input packet.
  *
  * @param p_gdb_session A pointer to the GDB session structure.
  */
-static void gdb_get_registers(struct gdb_session* p_gdb_session) { gdb_reply(p_gdb_session, GDB_REPLY_OK); }
+static void gdb_get_registers(struct gdb_session* p_gdb_session) {
+    target_s* p_target = gdb_get_target(p_gdb_session);
+
+    if (p_target == NULL) {
+        return;
+    }
+
+    const size_t REGISTERS_SIZE = target_regs_size(p_target);
+
+    if (REGISTERS_SIZE > GDB_MAX_MEMORY_LENGTH) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
 
-static void gdb_set_registers(struct gdb_session* p_gdb_session) { gdb_reply(p_gdb_session, GDB_REPLY_EMPTY); }
+    target_regs_read(p_target, p_gdb_session->scratch);
+    gdb_reply_hex(p_gdb_session, p_gdb_session->scratch, REGISTERS_SIZE);
+}
+
+/**
+ * @brief Write all general registers of the target.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ */
+static void gdb_set_registers(struct gdb_session* p_gdb_session) {
+    target_s* p_target = gdb_get_target(p_gdb_session);
+
+    if (p_target == NULL) {
+        return;
+    }
+
+    size_t payload_length = 0u;
+    char*  p_payload      = gdb_get_payload(p_gdb_session, &payload_length);
+
+    // Skip the command character.
+    size_t length = gdb_decode_hex(p_gdb_session, &p_payload[1], payload_length - 1u);
+
+    if (length != target_regs_size(p_target)) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
+
+    target_regs_write(p_target, p_gdb_session->scratch);
+    gdb_reply(p_gdb_session, GDB_REPLY_OK);
+}
 
 static void gdb_set_thread(struct gdb_session* p_gdb_session) {
     // FIXME: Extract thread number, if applicable.
@@ -107,29 +383,205 @@ static void gdb_set_thread(struct gdb_session* p_gdb_session) {
  *
  * @param p_gdb_session A pointer to the GDB session structure.
  */
-static void gdb_kill(struct gdb_session* p_gdb_session) { gdb_reply(p_gdb_session, GDB_REPLY_OK); }
+static void gdb_kill(struct gdb_session* p_gdb_session) {
+    if (p_gdb_session->p_target != NULL) {
+        target_reset(p_gdb_session->p_target);
+        target_detach(p_gdb_session->p_target);
+    }
+
+    p_gdb_session->p_target         = NULL;
+    p_gdb_session->b_target_running = false;
+    p_gdb_session->b_target_lost    = false;
+
+    gdb_reply(p_gdb_session, GDB_REPLY_OK);
+}
+
+/**
+ * @brief Read target memory, and reply with its contents as hex characters.
+ * @details Requests that exceed the packet size are shortened, which the client handles by reading the rest.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ */
+static void gdb_get_memory(struct gdb_session* p_gdb_session) {
+    target_s* p_target = gdb_get_target(p_gdb_session);
+
+    if (p_target == NULL) {
+        return;
+    }
+
+    size_t   payload_length = 0u;
+    char*    p_payload      = gdb_get_payload(p_gdb_session, &payload_length);
+    uint32_t address        = 0u;
+    uint32_t length         = 0u;
+
+    if (2 != SNSCANF(p_payload, payload_length, "m%" SCNx32 ",%" SCNx32, &address, &length)) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
+
+    if (length > GDB_MAX_MEMORY_LENGTH) {
+        length = GDB_MAX_MEMORY_LENGTH;
+    }
+
+    if (target_mem_read(p_target, p_gdb_session->scratch, address, length)) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
+
+    gdb_reply_hex(p_gdb_session, p_gdb_session->scratch, length);
+}
+
+/**
+ * @brief Write target memory from hex characters.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ */
+static void gdb_write_memory_hex(struct gdb_session* p_gdb_session) {
+    target_s* p_target = gdb_get_target(p_gdb_session);
+
+    if (p_target == NULL) {
+        return;
+    }
+
+    size_t   payload_length = 0u;
+    char*    p_payload      = gdb_get_payload(p_gdb_session, &payload_length);
+    uint32_t address        = 0u;
+    uint32_t length         = 0u;
+    size_t   hex_length     = 0u;
+    char*    p_hex          = gdb_get_data(p_gdb_session, ':', &hex_length);
+
+    if ((p_hex == NULL) || (2 != SNSCANF(p_payload, payload_length, "M%" SCNx32 ",%" SCNx32, &address, &length)) ||
+        (gdb_decode_hex(p_gdb_session, p_hex, hex_length) != length)) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
+
+    if ((length > 0u) && target_mem_write(p_target, address, p_gdb_session->scratch, length)) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
+
+    gdb_reply(p_gdb_session, GDB_REPLY_OK);
+}
+
+/**
+ * @brief Read a single target register.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ */
+static void gdb_read_register(struct gdb_session* p_gdb_session) {
+    target_s* p_target = gdb_get_target(p_gdb_session);
+
+    if (p_target == NULL) {
+        return;
+    }
+
+    size_t   payload_length = 0u;
+    char*    p_payload      = gdb_get_payload(p_gdb_session, &payload_length);
+    uint32_t register_index = 0u;
+
+    if (1 != SNSCANF(p_payload, payload_length, "p%" SCNx32, &register_index)) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
+
+    size_t length = target_reg_read(p_target, register_index, p_gdb_session->scratch, GDB_MAX_MEMORY_LENGTH);
+
+    if (length == 0u) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
+
+    gdb_reply_hex(p_gdb_session, p_gdb_session->scratch, length);
+}
+
+/**
+ * @brief Write a single target register.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ */
+static void gdb_write_register(struct gdb_session* p_gdb_session) {
+    target_s* p_target = gdb_get_target(p_gdb_session);
 
-static void gdb_get_memory(struct gdb_session* p_gdb_session) { gdb_reply(p_gdb_session, GDB_REPLY_EMPTY); }
+    if (p_target == NULL) {
+        return;
+    }
 
-static void gdb_write_memory_hex(struct gdb_session* p_gdb_session) { gdb_reply(p_gdb_session, GDB_REPLY_EMPTY); }
+    size_t   payload_length = 0u;
+    char*    p_payload      = gdb_get_payload(p_gdb_session, &payload_length);
+    uint32_t register_index = 0u;
+    size_t   hex_length     = 0u;
+    char*    p_hex          = gdb_get_data(p_gdb_session, '=', &hex_length);
+
+    if ((p_hex == NULL) || (1 != SNSCANF(p_payload, payload_length, "P%" SCNx32, &register_index))) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
 
-static void gdb_read_register(struct gdb_session* p_gdb_session) { gdb_reply(p_gdb_session, GDB_REPLY_EMPTY); }
+    size_t length = gdb_decode_hex(p_gdb_session, p_hex, hex_length);
 
-static void gdb_write_register(struct gdb_session* p_gdb_session) { gdb_reply(p_gdb_session, GDB_REPLY_EMPTY); }
+    if ((length == 0u) || (target_reg_write(p_target, register_index, p_gdb_session->scratch, length) == 0u)) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
 
-static void gdb_set(struct gdb_session* p_gdb_session) { gdb_reply(p_gdb_session, GDB_REPLY_EMPTY); }
+    gdb_reply(p_gdb_session, GDB_REPLY_OK);
+}
 
 static void gdb_restart(struct gdb_session* p_gdb_session) { gdb_reply(p_gdb_session, GDB_REPLY_EMPTY); }
 
-static void gdb_step(struct gdb_session* p_gdb_session) { gdb_reply(p_gdb_session, GDB_REPLY_EMPTY); }
+/**
+ * @brief Single-step the target. The signal and address arguments are ignored.
+ * @details There is no immediate reply - the stop reply is sent, when the target halts.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ */
+static void gdb_step(struct gdb_session* p_gdb_session) {
+    target_s* p_target = gdb_get_target(p_gdb_session);
+
+    if (p_target == NULL) {
+        return;
+    }
 
-static void gdb_step_signal(struct gdb_session* p_gdb_session) { gdb_reply(p_gdb_session, GDB_REPLY_EMPTY); }
+    target_halt_resume(p_target, true);
+    p_gdb_session->b_target_running = true;
+}
 
 static void gdb_is_thread_alive(struct gdb_session* p_gdb_session) { gdb_reply(p_gdb_session, GDB_REPLY_EMPTY); }
 
-static void gdb_v(struct gdb_session* p_gdb_session) { gdb_reply(p_gdb_session, GDB_REPLY_EMPTY); }
+/**
+ * @brief Write target memory from binary data.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ */
+static void gdb_write_memory(struct gdb_session* p_gdb_session) {
+    target_s* p_target = gdb_get_target(p_gdb_session);
+
+    if (p_target == NULL) {
+        return;
+    }
+
+    size_t   payload_length = 0u;
+    char*    p_payload      = gdb_get_payload(p_gdb_session, &payload_length);
+    uint32_t address        = 0u;
+    uint32_t length         = 0u;
+    size_t   data_length    = 0u;
+    char*    p_data         = gdb_get_data(p_gdb_session, ':', &data_length);
+
+    if ((p_data == NULL) || (2 != SNSCANF(p_payload, payload_length, "X%" SCNx32 ",%" SCNx32, &address, &length)) ||
+        (gdb_packet_unescape_binary(p_data, data_length) != length)) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
+
+    // Empty writes are used by the client for probing support of binary downloads.
+    if ((length > 0u) && target_mem_write(p_target, address, p_data, length)) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
 
-static void gdb_write_memory(struct gdb_session* p_gdb_session) { gdb_reply(p_gdb_session, GDB_REPLY_EMPTY); }
+    gdb_reply(p_gdb_session, GDB_REPLY_OK);
+}
 
 /**
  * @brief Insert or remove a target breakpoint.
@@ -137,27 +589,46 @@ static void gdb_write_memory(struct gdb_session* p_gdb_session) { gdb_reply(p_gd
  * @param p_gdb_session A pointer to the GDB session structure.
  */
 static void gdb_breakpoint(struct gdb_session* p_gdb_session) {
-    char*  p_buffer = gdb_packet_get_buffer(&p_gdb_session->output_packet);
-    size_t size     = gdb_packet_get_length(&p_gdb_session->output_packet);
+    target_s* p_target = gdb_get_target(p_gdb_session);
+
+    if (p_target == NULL) {
+        return;
+    }
+
+    size_t   payload_length = 0u;
+    char*    p_payload      = gdb_get_payload(p_gdb_session, &payload_length);
+    uint32_t kind           = 0u;
+    uint32_t address        = 0u;
+    uint32_t length         = 0u;
+
+    if (3 != SNSCANF(&p_payload[1], payload_length - 1u, "%" SCNu32 ",%" SCNx32 ",%" SCNu32, &kind, &address,
+                     &length)) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
 
-    uint32_t kind    = 0u;
-    uint32_t address = 0u;
-    uint32_t length  = 0u;
-    SNSCANF(p_buffer, size, "%*[zZ]%" PRIu32 ",%08" PRIx32 ",%" PRIu32, &kind, &address, &length);
+    if (kind > TARGET_WATCH_ACCESS) {
+        // Unsupported breakpoint kind.
+        gdb_reply(p_gdb_session, GDB_REPLY_EMPTY);
+        return;
+    }
+
+    int result = 0;
 
-    // FIXME: set or clear breakpoint on the target.
-    (void)kind;
-    (void)address;
-    (void)length;
+    if (p_payload[0] == 'Z') {
+        result = target_breakwatch_set(p_target, (target_breakwatch_e)kind, address, length);
+    } else {
+        result = target_breakwatch_clear(p_target, (target_breakwatch_e)kind, address, length);
+    }
 
-    // Error when inserting/removing breakpoint.
-    gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+    if (result != 0) {
+        // Error when inserting/removing breakpoint.
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
 
     // Breakpoint insertion/removal was successful.
     gdb_reply(p_gdb_session, GDB_REPLY_OK);
-
-    // Unsupported breakpoint kind.
-    gdb_reply(p_gdb_session, GDB_REPLY_EMPTY);
 }
 
 /**
@@ -166,8 +637,8 @@ static void gdb_breakpoint(struct gdb_session* p_gdb_session) {
 const struct gdb_command G_COMMANDS[] = {
     {'!', gdb_extended_remote},    // Enable extended remote mode.
     {'?', gdb_stop_reason_query},  // Stop reason query.
-    {'c', gdb_resume_addr},        // Continue (at addr)
-    {'C', gdb_resume_signal},      // Continue with signal.
+    {'c', gdb_resume},             // Continue (at addr)
+    {'C', gdb_resume},             // Continue with signal.
     {'D', gdb_detach},             // Detach.
     {'g', gdb_get_registers},      // Read general registers.
     {'G', gdb_set_registers},      // Write general registers.
@@ -178,15 +649,15 @@ const struct gdb_command G_COMMANDS[] = {
     {'p', gdb_read_register},      // Read register.
     {'P', gdb_write_register},     // Write register.
     {'q', gdb_query},              // General query
-    {'Q', gdb_set},                // General set.
+    {'Q', gdb_query},              // General set.
     {'R', gdb_restart},            // Extended remote restart command.
     {'s', gdb_step},               // Single step.
-    {'S', gdb_step_signal},        // Step with signal.
+    {'S', gdb_step},               // Step with signal.
     {'T', gdb_is_thread_alive},    // Thread liveliness query.
     {'v', gdb_v},                  // Group of 'v' commands.
     {'X', gdb_write_memory},       // Write memory (binary).
-    {'z', gdb_breakpoint},         // Insert breakpoint/watchpoint.
-    {'Z', gdb_breakpoint},         // Remove breakpoint/watchpoint.
+    {'z', gdb_breakpoint},         // Remove breakpoint/watchpoint.
+    {'Z', gdb_breakpoint},         // Insert breakpoint/watchpoint.
 };
 
 /**
@@ -218,7 +689,7 @@ void gdb_execute(struct gdb_session* p_gdb_session) {
     }
 
     ASSERT_PTR_NOT_NULL(p_gdb_command->p_callback);
-    p_gdb_command->p_callback(p_gdb_session);
+    PERF_MEASURE(command, NULL, p_gdb_command->p_callback(p_gdb_session));
 }
 
 /**
@@ -265,7 +736,8 @@ void gdb_execute_sub(const char* p_command_string, struct gdb_session* p_gdb_ses
         return;
     }
 
-    p_matched_gdb_subcommand->p_callback(p_gdb_session, argc, p_argv);
+    PERF_MEASURE(gdb_packet_get_command(&p_gdb_session->input_packet), p_matched_gdb_subcommand->p_subcommand,
+                 p_matched_gdb_subcommand->p_callback(p_gdb_session, argc, p_argv));
 }
 
 /**
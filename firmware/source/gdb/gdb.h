@@ -11,9 +11,11 @@
 #ifndef SOURCE_GDB_GDB_H_
 #define SOURCE_GDB_GDB_H_
 
+#include <stdarg.h>
 #include <stdint.h>
 
 #include "common/common.h"
+#include "common/report.h"
 #include "gdb_packet.h"
 #include "gdb_session.h"
 
@@ -22,6 +24,21 @@
  */
 #define GDB_MAX_ARG_COUNT 32u
 
+/**
+ * @brief The maximum length of target memory that is transferred in a single packet, as hex characters.
+ */
+#define GDB_MAX_MEMORY_LENGTH ((GDB_PACKET_MAX_USABLE_BUFFER_LENGTH - GDB_PACKET_OVERHEAD_LENGTH) / 2u)
+
+/**
+ * @brief The maximum length of a single console output message, before hex encoding.
+ */
+#define GDB_OUTPUT_MAX_LENGTH 512u
+
+/**
+ * @brief The maximum length of a stop reply.
+ */
+#define GDB_STOP_REPLY_MAX_LENGTH 32u
+
 #define GDB_REPLY_EMPTY          ""    // An empty response, usually for unsupported requests.
 #define GDB_REPLY_OK             "OK"  // A reply for successful execution of a command.
 #define GDB_REPLY_CONSOLE_OUTPUT "O"   // Leads a reply that results in GDB console output.
@@ -30,6 +47,17 @@
 #define GDB_REPLY_ERROR_01 "E01"  // Error reply with index 1
 #define GDB_REPLY_ERROR_02 "E02"  // Error reply with index 2
 #define GDB_REPLY_ERROR_03 "E03"  // Error reply with index 3
+#define GDB_REPLY_ERROR_FF "EFF"  // Error reply, if no target is attached.
+
+/**
+ * @brief The signal numbers that are reported to GDB in stop replies.
+ */
+enum gdb_signal {
+    GDB_SIGNAL_INT  = 2,   ///< The target was interrupted on request.
+    GDB_SIGNAL_TRAP = 5,   ///< The target hit a breakpoint or watchpoint, or finished a step.
+    GDB_SIGNAL_SEGV = 11,  ///< The target faulted.
+    GDB_SIGNAL_LOST = 29,  ///< The target was lost.
+};
 
 /**
  * @brief GDB result codes for handling commands.
@@ -67,8 +95,15 @@ struct gdb_subcommand {
 };
 
 enum gdb_result gdb_get_args(char* p_string, size_t* p_argc, const char** pp_argv);
+char*           gdb_get_data(struct gdb_session* p_gdb_session, char separator, size_t* p_data_length);
 
 void gdb_execute(struct gdb_session* p_gdb_session);
+void gdb_console_out(struct gdb_session* p_gdb_session, const char* p_string);
+void gdb_console_voutf(struct gdb_session* p_gdb_session, const char* p_format, va_list arguments);
+void gdb_console_outf(struct gdb_session* p_gdb_session, const char* p_format, ...)
+    __attribute__((format(printf, 2, 3)));
+struct report_output gdb_console_get_report_output(struct gdb_session* p_gdb_session);
+void gdb_reply_stop(struct gdb_session* p_gdb_session, target_halt_reason_e halt_reason, target_addr_t watch_address);
 void gdb_execute_sub(const char* p_command_string, struct gdb_session* p_gdb_session,
                      const struct gdb_subcommand* p_gdb_subcommands, const size_t gdb_subcommands_length,
                      const size_t argc, const char* p_argv);
@@ -15,6 +15,7 @@
 
 #include "common/common.h"
 #include "common/hex.h"
+#include "perf/perf.h"
 
 /**
  * @brief Initialize a packet.
@@ -58,6 +59,21 @@ static enum gdb_packet_result gdb_packet_add_char(struct gdb_packet* p_packet, c
     return GDB_PACKET_RESULT_OK;
 }
 
+/**
+ * @brief NUL-terminate the GDB packet buffer. The terminator does not count towards the packet length.
+ *
+ * @param p_packet A pointer to the packet.
+ * @return enum gdb_packet_result The packet result.
+ */
+static enum gdb_packet_result gdb_packet_terminate(struct gdb_packet* p_packet) {
+    if (p_packet->length >= GDB_PACKET_MAX_BUFFER_LENGTH) {
+        return GDB_PACKET_RESULT_OVERFLOW;
+    }
+
+    p_packet->buffer[p_packet->length] = '\0';
+    return GDB_PACKET_RESULT_OK;
+}
+
 /**
  * @brief Parse a character from a GDB packet.
  *
@@ -86,6 +102,40 @@ void gdb_packet_parse_char(struct gdb_packet* p_packet, char character) {
     }
 }
 
+/**
+ * @brief Read a single character, while waiting for the start of a packet.
+ * @details Outside of packets, only the start character, interrupt requests and acknowledgements of previous replies
+ * are meaningful. Everything else is dropped.
+ *
+ * @param p_packet A pointer to the packet.
+ * @param character The character to read.
+ * @return enum gdb_packet_result The packet result.
+ */
+static enum gdb_packet_result gdb_packet_read_char_idle(struct gdb_packet* p_packet, char character) {
+    switch (character) {
+        case GDB_PACKET_CHAR_START:
+            gdb_packet_add_char(p_packet, character, false);
+
+            p_packet->state = GDB_PACKET_STATE_COLLECT;
+            break;
+
+        case GDB_PACKET_CHAR_CTRL_C:
+            p_packet->state = GDB_PACKET_STATE_ABORT;
+            return GDB_PACKET_RESULT_INTERRUPT;
+
+        case GDB_PACKET_CHAR_ACK:
+            return GDB_PACKET_RESULT_ACK;
+
+        case GDB_PACKET_CHAR_NACK:
+            return GDB_PACKET_RESULT_NACK;
+
+        default:
+            break;
+    }
+
+    return GDB_PACKET_RESULT_COLLECTING;
+}
+
 /**
  * @brief Read a single character from a GDB packet.
  *
@@ -94,8 +144,14 @@ void gdb_packet_parse_char(struct gdb_packet* p_packet, char character) {
  * @return enum gdb_packet_result The packet result.
  */
 static enum gdb_packet_result gdb_packet_read_char(struct gdb_packet* p_packet, char character) {
+    if (p_packet->state == GDB_PACKET_STATE_INIT) {
+        return gdb_packet_read_char_idle(p_packet, character);
+    }
+
     switch (character) {
         case GDB_PACKET_CHAR_START:
+            // Start characters are always escaped within packets - the rest of the previous packet was lost.
+            gdb_packet_init(p_packet, GDB_PACKET_TYPE_INBOUND);
             gdb_packet_add_char(p_packet, character, false);
 
             p_packet->state = GDB_PACKET_STATE_COLLECT;
@@ -107,19 +163,6 @@ static enum gdb_packet_result gdb_packet_read_char(struct gdb_packet* p_packet,
             p_packet->state = GDB_PACKET_STATE_COLLECT_CHECKSUM_UPPER;
             break;
 
-        case GDB_PACKET_CHAR_CTRL_C:
-            p_packet->state = GDB_PACKET_STATE_ABORT;
-            break;
-
-        case GDB_PACKET_CHAR_ACK:
-        case GDB_PACKET_CHAR_NACK:
-            if (p_packet->state == GDB_PACKET_STATE_PENDING_ACK) {
-                // TODO(elagil): Handle ACK.
-            } else {
-                gdb_packet_parse_char(p_packet, character);
-            }
-            break;
-
         default:
             gdb_packet_parse_char(p_packet, character);
             break;
@@ -130,7 +173,7 @@ static enum gdb_packet_result gdb_packet_read_char(struct gdb_packet* p_packet,
     }
 
     // NUL-terminate the packet string.
-    RETURN_IF_NOT(gdb_packet_add_char(p_packet, '\0', false), GDB_PACKET_RESULT_OK);
+    RETURN_IF_NOT(gdb_packet_terminate(p_packet), GDB_PACKET_RESULT_OK);
 
     if (p_packet->reference_checksum != p_packet->checksum) {
         return GDB_PACKET_RESULT_CHECKSUM_ERROR;
@@ -141,7 +184,8 @@ static enum gdb_packet_result gdb_packet_read_char(struct gdb_packet* p_packet,
 
 /**
  * @brief Read characters from a stream into a GDB packet.
- * @details Detects GDB packet boundaries.
+ * @details Detects GDB packet boundaries. A packet may be spread over multiple calls - collection continues, where
+ * the previous call stopped.
  *
  * @param p_packet A pointer to the packet.
  * @param p_characters A pointer to the characters to consume.
@@ -155,7 +199,14 @@ enum gdb_packet_result gdb_packet_read_stream(struct gdb_packet* p_packet, const
     ASSERT_PTR_NOT_NULL(p_characters);
     ASSERT_PTR_NOT_NULL(p_consumed_length);
 
-    gdb_packet_init(p_packet, GDB_PACKET_TYPE_INBOUND);
+    const bool b_is_collecting = (p_packet->state == GDB_PACKET_STATE_COLLECT) ||
+                                 (p_packet->state == GDB_PACKET_STATE_COLLECT_CHECKSUM_UPPER) ||
+                                 (p_packet->state == GDB_PACKET_STATE_COLLECT_CHECKSUM_LOWER);
+
+    if (!b_is_collecting) {
+        gdb_packet_init(p_packet, GDB_PACKET_TYPE_INBOUND);
+    }
+
     enum gdb_packet_result result = GDB_PACKET_RESULT_COLLECTING;
 
     *p_consumed_length = 0u;
@@ -163,8 +214,15 @@ enum gdb_packet_result gdb_packet_read_stream(struct gdb_packet* p_packet, const
         result = gdb_packet_read_char(p_packet, p_characters[character_index]);
         (*p_consumed_length)++;
 
-        if ((result == GDB_PACKET_RESULT_OK) || (result == GDB_PACKET_RESULT_CHECKSUM_ERROR)) {
-            // A full packet was consumed - with or without success.
+        if (result == GDB_PACKET_RESULT_OK) {
+            PERF_MARK(PERF_MARK_PARSED);
+        }
+
+        if ((result == GDB_PACKET_RESULT_OK) || (result == GDB_PACKET_RESULT_CHECKSUM_ERROR) ||
+            (result == GDB_PACKET_RESULT_INTERRUPT) || (result == GDB_PACKET_RESULT_ACK) ||
+            (result == GDB_PACKET_RESULT_NACK)) {
+            // A full packet was consumed - with or without success - the client requested an interrupt, or it
+            // acknowledged the previous reply.
             break;
         }
     }
@@ -215,15 +273,32 @@ enum gdb_packet_result gdb_packet_write_payload(struct gdb_packet* p_packet, con
  * @return enum gdb_packet_result The packet result.
  */
 enum gdb_packet_result gdb_packet_write_payload_as_hex(struct gdb_packet* p_packet, const char* p_characters) {
-    ASSERT_PTR_NOT_NULL(p_packet);
     ASSERT_PTR_NOT_NULL(p_characters);
+
+    return gdb_packet_write_payload_binary_as_hex(p_packet, p_characters, strlen(p_characters));
+}
+
+/**
+ * @brief Write binary data to a GDB packet - the payload itself - as hex values. Can be called repeatedly.
+ *
+ * @param p_packet A pointer to the packet.
+ * @param p_data A pointer to the data to write to the packet as hex values.
+ * @param length The length of the data.
+ * @return enum gdb_packet_result The packet result.
+ */
+enum gdb_packet_result gdb_packet_write_payload_binary_as_hex(struct gdb_packet* p_packet, const void* p_data,
+                                                              size_t length) {
+    ASSERT_PTR_NOT_NULL(p_packet);
+    ASSERT_PTR_NOT_NULL(p_data);
     ASSERT_VERBOSE(p_packet->state == GDB_PACKET_STATE_COLLECT, "Invalid packet state.");
 
-    for (size_t character_index = 0u; character_index < strlen(p_characters); character_index++) {
-        char character = p_characters[character_index];
+    const uint8_t* p_bytes = p_data;
+
+    for (size_t byte_index = 0u; byte_index < length; byte_index++) {
+        uint8_t byte = p_bytes[byte_index];
 
-        char upper_nibble = hex_nibble_from_char(GET_UPPER_NIBBLE(character));
-        char lower_nibble = hex_nibble_from_char(GET_LOWER_NIBBLE(character));
+        char upper_nibble = hex_nibble_from_char(GET_UPPER_NIBBLE(byte));
+        char lower_nibble = hex_nibble_from_char(GET_LOWER_NIBBLE(byte));
 
         RETURN_IF_NOT(gdb_packet_add_char(p_packet, upper_nibble, true), GDB_PACKET_RESULT_OK);
         RETURN_IF_NOT(gdb_packet_add_char(p_packet, lower_nibble, true), GDB_PACKET_RESULT_OK);
@@ -232,6 +307,45 @@ enum gdb_packet_result gdb_packet_write_payload_as_hex(struct gdb_packet* p_pack
     return GDB_PACKET_RESULT_OK;
 }
 
+/**
+ * @brief Write binary data to a GDB packet - the payload itself. Escapes characters that are special to the protocol.
+ * Can be called repeatedly.
+ *
+ * @param p_packet A pointer to the packet.
+ * @param p_data A pointer to the data to write to the packet.
+ * @param length The length of the data.
+ * @return enum gdb_packet_result The packet result.
+ */
+enum gdb_packet_result gdb_packet_write_payload_binary(struct gdb_packet* p_packet, const void* p_data,
+                                                       size_t length) {
+    ASSERT_PTR_NOT_NULL(p_packet);
+    ASSERT_PTR_NOT_NULL(p_data);
+    ASSERT_VERBOSE(p_packet->state == GDB_PACKET_STATE_COLLECT, "Invalid packet state.");
+
+    const char* p_characters = p_data;
+
+    for (size_t character_index = 0u; character_index < length; character_index++) {
+        char character = p_characters[character_index];
+
+        switch (character) {
+            case GDB_PACKET_CHAR_START:
+            case GDB_PACKET_CHAR_STOP:
+            case GDB_PACKET_CHAR_ESC:
+            case GDB_PACKET_CHAR_RUN_LENGTH_START:
+                RETURN_IF_NOT(gdb_packet_add_char(p_packet, GDB_PACKET_CHAR_ESC, true), GDB_PACKET_RESULT_OK);
+                character ^= GDB_PACKET_ESCAPE_XOR;
+                break;
+
+            default:
+                break;
+        }
+
+        RETURN_IF_NOT(gdb_packet_add_char(p_packet, character, true), GDB_PACKET_RESULT_OK);
+    }
+
+    return GDB_PACKET_RESULT_OK;
+}
+
 /**
  * @brief Write characters to a GDB packet - finalize the packet.
  *
@@ -247,7 +361,7 @@ enum gdb_packet_result gdb_packet_write_stop(struct gdb_packet* p_packet) {
                   GDB_PACKET_RESULT_OK);
     RETURN_IF_NOT(gdb_packet_add_char(p_packet, hex_nibble_from_char(GET_LOWER_NIBBLE(p_packet->checksum)), false),
                   GDB_PACKET_RESULT_OK);
-    RETURN_IF_NOT(gdb_packet_add_char(p_packet, '\0', false), GDB_PACKET_RESULT_OK);
+    RETURN_IF_NOT(gdb_packet_terminate(p_packet), GDB_PACKET_RESULT_OK);
 
     p_packet->state = GDB_PACKET_STATE_COMPLETE;
     return GDB_PACKET_RESULT_OK;
@@ -271,23 +385,30 @@ enum gdb_packet_result gdb_packet_write(struct gdb_packet* p_packet, const char*
 }
 
 /**
- * @brief Write a single ACK or NACK character to a GDB packet.
- * @details Freshly initializes the provided packet. This function is meant for generating GDB packets for
- * transmission towards the GDB stub.
+ * @brief Remove the escaping from binary data in place, as received in 'X' or 'vFlashWrite' packets.
  *
- * @param p_packet A pointer to the packet.
- * @param character The character to write.
- * @return enum gdb_packet_result The packet result.
+ * @param p_data A pointer to the escaped data.
+ * @param length The length of the escaped data.
+ * @return size_t The length of the unescaped data.
  */
-enum gdb_packet_result gdb_packet_write_ack(struct gdb_packet* p_packet, const char character) {
-    ASSERT_PTR_NOT_NULL(p_packet);
-    ASSERT_VERBOSE((character == GDB_PACKET_CHAR_ACK) || (character == GDB_PACKET_CHAR_NACK), "Unsupported character.");
+size_t gdb_packet_unescape_binary(char* p_data, size_t length) {
+    ASSERT_PTR_NOT_NULL(p_data);
 
-    gdb_packet_init(p_packet, GDB_PACKET_TYPE_OUTBOUND);
-    RETURN_IF_NOT(gdb_packet_add_char(p_packet, character, false), GDB_PACKET_RESULT_OK);
+    size_t unescaped_length = 0u;
 
-    p_packet->state = GDB_PACKET_STATE_COMPLETE;
-    return GDB_PACKET_RESULT_OK;
+    for (size_t character_index = 0u; character_index < length; character_index++) {
+        char character = p_data[character_index];
+
+        if ((character == GDB_PACKET_CHAR_ESC) && ((character_index + 1u) < length)) {
+            character_index++;
+            character = p_data[character_index] ^ GDB_PACKET_ESCAPE_XOR;
+        }
+
+        p_data[unescaped_length] = character;
+        unescaped_length++;
+    }
+
+    return unescaped_length;
 }
 
 /**
@@ -22,6 +22,7 @@
 #define GDB_PACKET_OVERHEAD_LENGTH          4u  // Start, stop, and two checksum bytes.
 #define GDB_PACKET_MAX_BUFFER_LENGTH        2048u
 #define GDB_PACKET_MAX_USABLE_BUFFER_LENGTH (GDB_PACKET_MAX_BUFFER_LENGTH - 1u)
+#define GDB_PACKET_ESCAPE_XOR               0x20u  // Escaped characters are XOR'ed with this value.
 
 enum gdb_packet_char {
     GDB_PACKET_CHAR_START              = '$',
@@ -40,6 +41,9 @@ enum gdb_packet_result {
     GDB_PACKET_RESULT_COLLECTING,
     GDB_PACKET_RESULT_OVERFLOW,
     GDB_PACKET_RESULT_CHECKSUM_ERROR,
+    GDB_PACKET_RESULT_INTERRUPT,
+    GDB_PACKET_RESULT_ACK,
+    GDB_PACKET_RESULT_NACK,
 };
 
 enum gdb_packet_state {
@@ -79,10 +83,14 @@ enum gdb_packet_result gdb_packet_read_stream(struct gdb_packet* p_packet, const
 enum gdb_packet_result gdb_packet_write_start(struct gdb_packet* p_packet);
 enum gdb_packet_result gdb_packet_write_payload(struct gdb_packet* p_packet, const char* p_characters);
 enum gdb_packet_result gdb_packet_write_payload_as_hex(struct gdb_packet* p_packet, const char* p_characters);
+enum gdb_packet_result gdb_packet_write_payload_binary(struct gdb_packet* p_packet, const void* p_data, size_t length);
+enum gdb_packet_result gdb_packet_write_payload_binary_as_hex(struct gdb_packet* p_packet, const void* p_data,
+                                                              size_t length);
 enum gdb_packet_result gdb_packet_write_stop(struct gdb_packet* p_packet);
 
 enum gdb_packet_result gdb_packet_write(struct gdb_packet* p_packet, const char* p_characters);
-enum gdb_packet_result gdb_packet_write_ack(struct gdb_packet* p_packet, const char character);
+
+size_t gdb_packet_unescape_binary(char* p_data, size_t length);
 
 /**
  * @brief Mark a packet as sent.
@@ -91,11 +99,23 @@ enum gdb_packet_result gdb_packet_write_ack(struct gdb_packet* p_packet, const c
  */
 static inline void gdb_packet_mark_sent(struct gdb_packet* p_packet) {
     ASSERT_PTR_NOT_NULL(p_packet);
-    ASSERT_VERBOSE(p_packet->state = GDB_PACKET_STATE_COMPLETE, "Incomplete packet cannot have been sent.");
+    ASSERT_VERBOSE((p_packet->state == GDB_PACKET_STATE_COMPLETE) || (p_packet->state == GDB_PACKET_STATE_PENDING_ACK),
+                   "Incomplete packet cannot have been sent.");
 
     p_packet->state = GDB_PACKET_STATE_SENT;
 }
 
+/**
+ * @brief Mark a packet as sent, but not yet acknowledged by the client. It is sent again, if the client rejects it.
+ *
+ * @param p_packet A pointer to the packet.
+ */
+static inline void gdb_packet_mark_pending_ack(struct gdb_packet* p_packet) {
+    ASSERT_PTR_NOT_NULL(p_packet);
+
+    p_packet->state = GDB_PACKET_STATE_PENDING_ACK;
+}
+
 /**
  * @brief Get the full length of a packet.
  *
@@ -104,7 +124,8 @@ static inline void gdb_packet_mark_sent(struct gdb_packet* p_packet) {
  */
 static inline size_t gdb_packet_get_length(struct gdb_packet* p_packet) {
     ASSERT_PTR_NOT_NULL(p_packet);
-    ASSERT_VERBOSE((p_packet->state == GDB_PACKET_STATE_COMPLETE) || (p_packet->state == GDB_PACKET_STATE_SENT),
+    ASSERT_VERBOSE((p_packet->state == GDB_PACKET_STATE_COMPLETE) || (p_packet->state == GDB_PACKET_STATE_SENT) ||
+                       (p_packet->state == GDB_PACKET_STATE_PENDING_ACK),
                    "Packet not complete.");
 
     return p_packet->length;
@@ -16,30 +16,48 @@
 #include <string.h>
 
 #include "common/common.h"
+#include "common/memory.h"
 #include "gdb.h"
 #include "gdb_packet.h"
 #include "network/network.h"
+#include "perf/perf.h"
+#include "target_power/target_voltage.h"
+#include "trace/trace.h"
 
 /**
  * @brief The GDB session. There can only be one connection at a time.
  */
-struct gdb_session g_gdb_session;
+struct gdb_session g_gdb_session MEMORY_CCM;
 
 enum gdb_session_state gdb_session_get_state(void) { return g_gdb_session.state; }
 
-void gdb_session_flush(struct gdb_session* p_gdb_session) {
-    ASSERT_PTR_NOT_NULL(p_gdb_session);
-    ASSERT_PTR_NOT_NULL(p_gdb_session->p_write_cb);
-
-    bool b_success = p_gdb_session->p_write_cb(gdb_packet_get_buffer(&p_gdb_session->output_packet),
-                                               gdb_packet_get_length(&p_gdb_session->output_packet));
-
-    gdb_packet_mark_sent(&p_gdb_session->output_packet);
+/**
+ * @brief Get the attached target, e.g. for reporting it.
+ *
+ * @return target_s* A pointer to the target, or NULL, if none is attached.
+ */
+target_s* gdb_session_get_target(void) { return g_gdb_session.p_target; }
 
-    if (b_success) {
-        return;
-    }
+/**
+ * @brief Check, if the transport of the session can lose data. Packets are then also sent again after a timeout, not
+ * only when the client rejects them.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @return bool True, if the transport can lose data.
+ */
+static bool gdb_session_is_lossy(const struct gdb_session* p_gdb_session) {
+    return (p_gdb_session->transport == GDB_SESSION_TRANSPORT_USB_CDC) ||
+           (p_gdb_session->transport == GDB_SESSION_TRANSPORT_UDP_IP);
+}
 
+/**
+ * @brief Handle a failed write to the transport.
+ * @details A broken TCP connection ends the session. On lossy transports, the packet stays pending, and is sent again
+ * after the retransmission timeout.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ */
+static void gdb_session_write_failed(struct gdb_session* p_gdb_session) {
     switch (p_gdb_session->transport) {
         case GDB_SESSION_TRANSPORT_TCP_IP:
             p_gdb_session->state = GDB_SESSION_STATE_ABORTED;
@@ -48,10 +66,94 @@ void gdb_session_flush(struct gdb_session* p_gdb_session) {
         default:
             break;
     }
+}
+
+/**
+ * @brief Write an acknowledgement character to the transport. It does not replace the output packet, which may still
+ * wait for its own acknowledgement.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param character The acknowledgement character (ACK or NACK).
+ * @param b_more If true, more output follows right away, and the transport may hold back the data until then.
+ */
+static void gdb_session_write_ack(struct gdb_session* p_gdb_session, char character, bool b_more) {
+    ASSERT_PTR_NOT_NULL(p_gdb_session);
+    ASSERT_PTR_NOT_NULL(p_gdb_session->p_write_cb);
+    ASSERT_VERBOSE((character == GDB_PACKET_CHAR_ACK) || (character == GDB_PACKET_CHAR_NACK), "Unsupported character.");
+
+    if (!p_gdb_session->p_write_cb(&character, 1u, b_more)) {
+        gdb_session_write_failed(p_gdb_session);
+    }
+}
 
-    // FIXME: Add retries, if not TCP.
+/**
+ * @brief Write the output packet to the transport.
+ * @details In acknowledgement mode, a written packet is retained, until the client acknowledges it. It is sent again,
+ * if the client rejects it, or - on lossy transports - if the acknowledgement does not arrive in time. Only the last
+ * packet is retained, but the written packets are counted, such that a command that replies with several packets
+ * (console output) waits for the acknowledgement of each of them, before it gives up on the last one.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param b_more If true, more output follows right away, and the transport may hold back the data until then.
+ */
+static void gdb_session_write(struct gdb_session* p_gdb_session, bool b_more) {
+    ASSERT_PTR_NOT_NULL(p_gdb_session);
+    ASSERT_PTR_NOT_NULL(p_gdb_session->p_write_cb);
+
+    bool b_success = p_gdb_session->p_write_cb(gdb_packet_get_buffer(&p_gdb_session->output_packet),
+                                               gdb_packet_get_length(&p_gdb_session->output_packet), b_more);
+
+    if (p_gdb_session->properties.b_no_ack_mode) {
+        gdb_packet_mark_sent(&p_gdb_session->output_packet);
+    } else {
+        gdb_packet_mark_pending_ack(&p_gdb_session->output_packet);
+        p_gdb_session->retransmit.sent_time = chVTGetSystemTimeX();
+        p_gdb_session->retransmit.count     = 0u;
+        p_gdb_session->retransmit.unacknowledged_count++;
+    }
+
+    if (!b_success) {
+        gdb_session_write_failed(p_gdb_session);
+    }
 }
 
+/**
+ * @brief Send the output packet again, as it was not acknowledged. Gives up on it after
+ * \a GDB_SESSION_RETRANSMIT_LIMIT attempts.
+ * @details Earlier packets, which were not acknowledged either, are no longer retained - only the acknowledgement of
+ * the packet that is sent again is awaited.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ */
+static void gdb_session_retransmit(struct gdb_session* p_gdb_session) {
+    ASSERT_VERBOSE(p_gdb_session->output_packet.state == GDB_PACKET_STATE_PENDING_ACK, "No packet pending.");
+
+    if (p_gdb_session->retransmit.count >= GDB_SESSION_RETRANSMIT_LIMIT) {
+        gdb_packet_mark_sent(&p_gdb_session->output_packet);
+        p_gdb_session->retransmit.unacknowledged_count = 0u;
+        return;
+    }
+
+    p_gdb_session->retransmit.count++;
+    p_gdb_session->retransmit.unacknowledged_count = 1u;
+    p_gdb_session->retransmit.sent_time = chVTGetSystemTimeX();
+    TRACE(TRACE_ID_PACKET_RETRANSMIT, p_gdb_session->retransmit.count, 0u);
+
+    bool b_success = p_gdb_session->p_write_cb(gdb_packet_get_buffer(&p_gdb_session->output_packet),
+                                               gdb_packet_get_length(&p_gdb_session->output_packet), false);
+
+    if (!b_success) {
+        gdb_session_write_failed(p_gdb_session);
+    }
+}
+
+/**
+ * @brief Write the output packet to the transport, and push it out - this ends a reply.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ */
+void gdb_session_flush(struct gdb_session* p_gdb_session) { gdb_session_write(p_gdb_session, false); }
+
 /**
  * @brief Handle data from the stub in the GDB session.
  *
@@ -72,17 +174,71 @@ size_t gdb_session_handle(const char* p_input, const size_t input_length) {
 
     switch (result) {
         case GDB_PACKET_RESULT_OK:
+            TRACE(TRACE_ID_PACKET_COMPLETE, *gdb_packet_get_buffer_payload(&g_gdb_session.input_packet),
+                  gdb_packet_get_payload_length(&g_gdb_session.input_packet));
+
             if (!g_gdb_session.properties.b_no_ack_mode) {
-                gdb_packet_write_ack(&g_gdb_session.output_packet, GDB_PACKET_CHAR_ACK);
-                gdb_session_flush(&g_gdb_session);
+                gdb_session_write_ack(&g_gdb_session, GDB_PACKET_CHAR_ACK, true);
             }
             gdb_execute(&g_gdb_session);
+            PERF_MARK(PERF_MARK_EXECUTED);
+            TRACE(TRACE_ID_EXECUTED, *gdb_packet_get_buffer_payload(&g_gdb_session.input_packet), 0u);
+
+            // A single step usually completes right away - do not wait for the next poll interval to report it.
+            gdb_session_poll();
             break;
 
         case GDB_PACKET_RESULT_CHECKSUM_ERROR:
+            TRACE(TRACE_ID_PACKET_CHECKSUM, 0u, 0u);
+
             if (!g_gdb_session.properties.b_no_ack_mode) {
-                gdb_packet_write_ack(&g_gdb_session.output_packet, GDB_PACKET_CHAR_NACK);
-                gdb_session_flush(&g_gdb_session);
+                gdb_session_write_ack(&g_gdb_session, GDB_PACKET_CHAR_NACK, false);
+            }
+            break;
+
+        case GDB_PACKET_RESULT_INTERRUPT:
+            TRACE(TRACE_ID_PACKET_INTERRUPT, 0u, 0u);
+
+            if (!g_gdb_session.b_target_running) {
+                break;
+            }
+
+            if (g_gdb_session.p_target != NULL) {
+                // The stop reply is sent, when polling detects the halt.
+                target_halt_request(g_gdb_session.p_target);
+            } else {
+                // The target was lost on a power-up, and the client gives up waiting for it.
+                g_gdb_session.b_target_running = false;
+                gdb_reply_stop(&g_gdb_session, TARGET_HALT_ERROR, 0u);
+            }
+            break;
+
+        case GDB_PACKET_RESULT_ACK:
+            // Acknowledgements arrive in order, so only the last one belongs to the retained packet.
+            if (g_gdb_session.retransmit.unacknowledged_count > 0u) {
+                g_gdb_session.retransmit.unacknowledged_count--;
+            }
+
+            if ((g_gdb_session.retransmit.unacknowledged_count == 0u) &&
+                (g_gdb_session.output_packet.state == GDB_PACKET_STATE_PENDING_ACK)) {
+                gdb_packet_mark_sent(&g_gdb_session.output_packet);
+            }
+            break;
+
+        case GDB_PACKET_RESULT_NACK:
+            // Only the last packet can be sent again, and only, if it was not acknowledged yet. The client rejects a
+            // packet that was corrupted, or that it did not receive in time (e.g. lost on the UDP transport). A
+            // rejected earlier packet is no longer retained, and is lost.
+            if (g_gdb_session.output_packet.state != GDB_PACKET_STATE_PENDING_ACK) {
+                break;
+            }
+
+            TRACE(TRACE_ID_PACKET_NACK, 0u, 0u);
+
+            if (g_gdb_session.retransmit.unacknowledged_count > 1u) {
+                g_gdb_session.retransmit.unacknowledged_count--;
+            } else {
+                gdb_session_retransmit(&g_gdb_session);
             }
             break;
 
@@ -94,6 +250,168 @@ size_t gdb_session_handle(const char* p_input, const size_t input_length) {
     return consumed_length;
 }
 
+#if TARGET_VOLTAGE_ENABLE == TRUE
+/**
+ * @brief Follow the power state of the attached target.
+ * @details While the target is unpowered, it is not polled, such that it is not reported as lost. After it powered up
+ * again, the stale target is detached, and the target is attached again, and resumed, if it was running before.
+ *
+ * If attaching fails, it is retried on every poll. A running target stays running for the client, which is told about
+ * the failure on its console, and can interrupt to give up on the target. A halted target answers target commands with
+ * errors meanwhile.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @return bool True, if the target can be polled.
+ */
+static bool gdb_session_follow_target_power(struct gdb_session* p_gdb_session) {
+    if (!target_voltage_is_present()) {
+        return false;
+    }
+
+    const uint32_t POWER_UP_COUNT = target_voltage_get_power_up_count();
+
+    if (POWER_UP_COUNT != p_gdb_session->power_up_count) {
+        TRACE(TRACE_ID_TARGET_POWER_UP, p_gdb_session->target_number, POWER_UP_COUNT);
+
+        p_gdb_session->power_up_count = POWER_UP_COUNT;
+
+        if (p_gdb_session->p_target != NULL) {
+            // The debug state of the target was lost with its power.
+            target_detach(p_gdb_session->p_target);
+            p_gdb_session->p_target = NULL;
+        }
+    } else if (!p_gdb_session->b_target_lost) {
+        return true;
+    }
+
+    p_gdb_session->p_target = target_attach_n(p_gdb_session->target_number, &p_gdb_session->target_controller);
+
+    if (p_gdb_session->p_target == NULL) {
+        if (!p_gdb_session->b_target_lost && p_gdb_session->b_target_running) {
+            gdb_console_out(p_gdb_session, "Target powered up, but attaching again failed. Retrying.\n");
+        }
+
+        p_gdb_session->b_target_lost = true;
+        return false;
+    }
+
+    p_gdb_session->b_target_lost = false;
+
+    if (p_gdb_session->b_target_running) {
+        target_halt_resume(p_gdb_session->p_target, false);
+    }
+
+    return true;
+}
+#endif
+
+/**
+ * @brief Poll a running target for halting, and send the stop reply, if it did. On lossy transports, send a packet
+ * again, which was not acknowledged in time.
+ * @details Must be called by the transport at least every \a GDB_SESSION_POLL_INTERVAL_MS, while the session is active.
+ */
+void gdb_session_poll(void) {
+    if (g_gdb_session.state != GDB_SESSION_STATE_ACTIVE) {
+        return;
+    }
+
+    if ((g_gdb_session.output_packet.state == GDB_PACKET_STATE_PENDING_ACK) && gdb_session_is_lossy(&g_gdb_session) &&
+        (chVTTimeElapsedSinceX(g_gdb_session.retransmit.sent_time) >= TIME_MS2I(GDB_SESSION_RETRANSMIT_TIMEOUT_MS))) {
+        // E.g. a stop reply, for which GDB waits without a timeout of its own.
+        gdb_session_retransmit(&g_gdb_session);
+    }
+
+#if TARGET_VOLTAGE_ENABLE == TRUE
+    if (((g_gdb_session.p_target != NULL) || g_gdb_session.b_target_lost) &&
+        !gdb_session_follow_target_power(&g_gdb_session)) {
+        return;
+    }
+#endif
+
+    if (!g_gdb_session.b_target_running) {
+        return;
+    }
+
+    ASSERT_PTR_NOT_NULL(g_gdb_session.p_target);
+
+    target_addr_t        watch_address = 0u;
+    target_halt_reason_e halt_reason   = target_halt_poll(g_gdb_session.p_target, &watch_address);
+
+    if (halt_reason == TARGET_HALT_RUNNING) {
+        return;
+    }
+
+    TRACE(TRACE_ID_TARGET_HALTED, halt_reason, watch_address);
+
+    g_gdb_session.b_target_running = false;
+    gdb_reply_stop(&g_gdb_session, halt_reason, watch_address);
+}
+
+/**
+ * @brief Forget about a target that is destroyed, e.g. by a new scan.
+ *
+ * @param p_controller A pointer to the target controller (unused).
+ * @param p_target A pointer to the target that is destroyed.
+ */
+static void gdb_session_target_destroy_cb(target_controller_s* p_controller, target_s* p_target) {
+    (void)p_controller;
+
+    if (g_gdb_session.p_target == p_target) {
+        g_gdb_session.p_target         = NULL;
+        g_gdb_session.b_target_running = false;
+        g_gdb_session.b_target_lost    = false;
+    }
+}
+
+/**
+ * @brief Forward formatted output from the target drivers to the GDB console.
+ *
+ * @param p_controller A pointer to the target controller (unused).
+ * @param p_format A pointer to the format string.
+ * @param arguments The format arguments.
+ */
+static void gdb_session_target_printf_cb(target_controller_s* p_controller, const char* p_format, va_list arguments) {
+    (void)p_controller;
+
+    gdb_voutf(p_format, arguments);
+}
+
+/**
+ * @brief Send a string to the console of the active GDB session. Required by the blackmagic target drivers.
+ *
+ * @param p_string A pointer to the NUL-terminated string.
+ */
+void gdb_out(const char* p_string) {
+    if (g_gdb_session.state == GDB_SESSION_STATE_ACTIVE) {
+        gdb_console_out(&g_gdb_session, p_string);
+    }
+}
+
+/**
+ * @brief Send formatted output to the console of the active GDB session. Required by the blackmagic target drivers.
+ *
+ * @param p_format A pointer to the format string.
+ * @param arguments The format arguments.
+ */
+void gdb_voutf(const char* p_format, va_list arguments) {
+    if (g_gdb_session.state == GDB_SESSION_STATE_ACTIVE) {
+        gdb_console_voutf(&g_gdb_session, p_format, arguments);
+    }
+}
+
+/**
+ * @brief Send formatted output to the console of the active GDB session. Required by the blackmagic target drivers.
+ *
+ * @param p_format A pointer to the format string.
+ */
+void gdb_outf(const char* p_format, ...) {
+    va_list arguments;
+
+    va_start(arguments, p_format);
+    gdb_voutf(p_format, arguments);
+    va_end(arguments);
+}
+
 /**
  * @brief Lock the GDB session.
  *
@@ -107,10 +425,13 @@ bool gdb_session_lock(enum gdb_session_transport transport, p_gdb_write_cb_t p_w
     if (b_locked) {
         gdb_packet_init(&g_gdb_session.input_packet, GDB_PACKET_TYPE_INBOUND);
         gdb_packet_init(&g_gdb_session.output_packet, GDB_PACKET_TYPE_OUTBOUND);
+        g_gdb_session.retransmit.unacknowledged_count = 0u;
 
         g_gdb_session.state      = GDB_SESSION_STATE_ACTIVE;
         g_gdb_session.transport  = transport;
         g_gdb_session.p_write_cb = p_write_cb;
+        PERF_CLEAR_MARKS();
+        TRACE(TRACE_ID_SESSION_LOCK, transport, 0u);
         palSetLine(LINE_LED_AMBER);
     }
 
@@ -121,12 +442,20 @@ bool gdb_session_lock(enum gdb_session_transport transport, p_gdb_write_cb_t p_w
  * @brief Release the GDB session.
  */
 void gdb_session_release(void) {
+    if (g_gdb_session.p_target != NULL) {
+        target_detach(g_gdb_session.p_target);
+    }
+
+    g_gdb_session.p_target                        = NULL;
+    g_gdb_session.b_target_running                = false;
+    g_gdb_session.b_target_lost                   = false;
     g_gdb_session.properties.b_is_extended_remote = false;
     g_gdb_session.properties.b_non_stop           = false;
     g_gdb_session.properties.b_no_ack_mode        = false;
     g_gdb_session.transport                       = GDB_SESSION_TRANSPORT_NONE;
     g_gdb_session.state                           = GDB_SESSION_STATE_IDLE;
 
+    TRACE(TRACE_ID_SESSION_RELEASE, 0u, 0u);
     chBSemSignal(&g_gdb_session.lock);
     palClearLine(LINE_LED_AMBER);
 }
@@ -135,6 +464,9 @@ void gdb_session_release(void) {
  * @brief Initialize the GDB session.
  */
 void gdb_session_init(void) {
+    g_gdb_session.target_controller.destroy_callback = gdb_session_target_destroy_cb;
+    g_gdb_session.target_controller.printf           = gdb_session_target_printf_cb;
+
     chBSemObjectInit(&g_gdb_session.lock, true);
     gdb_session_release();
 }
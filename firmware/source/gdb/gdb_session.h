@@ -17,7 +17,26 @@
 #include "target.h"
 #include "target_internal.h"
 
-typedef bool (*p_gdb_write_cb_t)(char*, size_t);
+/**
+ * @brief The interval, in which a running target is polled for halting, in milliseconds.
+ */
+#define GDB_SESSION_POLL_INTERVAL_MS 10u
+
+/**
+ * @brief The time, after which a packet that was not acknowledged is sent again, on transports that can lose data.
+ */
+#define GDB_SESSION_RETRANSMIT_TIMEOUT_MS 250u
+
+/**
+ * @brief The number of times that a packet is sent again, before it is given up.
+ */
+#define GDB_SESSION_RETRANSMIT_LIMIT 8u
+
+/**
+ * @brief A transport write callback. The last argument is true, if more data follows right away (e.g. an
+ * acknowledgement, before the reply), such that the transport does not need to push the data yet.
+ */
+typedef bool (*p_gdb_write_cb_t)(char*, size_t, bool);
 
 enum gdb_session_state {
     GDB_SESSION_STATE_IDLE,
@@ -32,16 +51,28 @@ enum gdb_session_transport {
     GDB_SESSION_TRANSPORT_NONE,     ///< No transport (when session is inactive).
     GDB_SESSION_TRANSPORT_USB_CDC,  ///< The USB CDC transport.
     GDB_SESSION_TRANSPORT_TCP_IP,   ///< The TCP/IP transport.
+    GDB_SESSION_TRANSPORT_UDP_IP,   ///< The UDP/IP transport, which relies on acknowledgements for retransmission.
 };
 
 /**
  * @brief The GDB session structure.
  */
 struct gdb_session {
-    target_s* p_target;
+    target_s*           p_target;           ///< The attached target, or NULL, if none is attached.
+    target_controller_s target_controller;  ///< The controller, through which the target reports back.
+    bool                b_target_running;   ///< True, if the target was resumed, and did not halt yet.
+    uint32_t            target_number;      ///< The number of the attached target, for attaching again.
+    uint32_t            power_up_count;     ///< The target power-up count, when the target was attached.
+    bool                b_target_lost;      ///< True, if attaching again after a power-up failed. It is retried.
 
     struct gdb_packet input_packet;
-    struct gdb_packet output_packet;
+    struct gdb_packet output_packet;  ///< The last packet that was written, retained until it is acknowledged.
+
+    struct {
+        systime_t sent_time;             ///< The time, at which the output packet was last sent.
+        size_t    count;                 ///< The number of times that the output packet was sent again.
+        size_t    unacknowledged_count;  ///< The number of written packets, which were not acknowledged yet.
+    } retransmit;
 
     p_gdb_write_cb_t           p_write_cb;
     enum gdb_session_transport transport;  ///< The type of transport to use for the session.
@@ -54,12 +85,16 @@ struct gdb_session {
 
     enum gdb_session_state state;
     binary_semaphore_t     lock;  ///< The session locking semaphore. FIXME: Make generic.
+
+    char scratch[GDB_PACKET_MAX_BUFFER_LENGTH];  ///< Working memory for command handlers, e.g. for target data.
 };
 
 enum gdb_session_state gdb_session_get_state(void);
+target_s*              gdb_session_get_target(void);
 
 size_t gdb_session_handle(const char* p_input, const size_t input_size);
 void   gdb_session_flush(struct gdb_session* p_gdb_session);
+void   gdb_session_poll(void);
 
 bool gdb_session_lock(enum gdb_session_transport transport, p_gdb_write_cb_t p_write_cb);
 void gdb_session_release(void);
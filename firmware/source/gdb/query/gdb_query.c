@@ -10,6 +10,7 @@
 
 #include "gdb_query.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "common/hex.h"
@@ -38,12 +39,126 @@ static void gdb_query_supported(struct gdb_session* p_gdb_session, const size_t
 
     char message[GDB_QUERY_MESSAGE_MAX_LENGTH];
 
-    // FIXME: add ";qXfer:memory-map:read+;qXfer:features:read+;vContSupported+;QStartNoAckMode+" features
-    SNPRINTF(message, ARRAY_LENGTH(message), "PacketSize=%X", GDB_PACKET_MAX_USABLE_BUFFER_LENGTH);
+    SNPRINTF(message, ARRAY_LENGTH(message),
+             "PacketSize=%X;qXfer:memory-map:read+;qXfer:features:read+;QStartNoAckMode+",
+             GDB_PACKET_MAX_USABLE_BUFFER_LENGTH);
 
     gdb_reply(p_gdb_session, message);
 }
 
+/**
+ * @brief Reply to a 'qXfer' read request with a part of a document.
+ * @details The requested offset and length follow the annex, e.g. "qXfer:memory-map:read::0,3fb".
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param p_prefix A pointer to the request prefix, up to the offset.
+ * @param p_document A pointer to the document.
+ * @param document_length The length of the document.
+ */
+static void gdb_query_reply_xfer(struct gdb_session* p_gdb_session, const char* p_prefix, const char* p_document,
+                                 size_t document_length) {
+    struct gdb_packet* p_input_packet  = &p_gdb_session->input_packet;
+    struct gdb_packet* p_output_packet = &p_gdb_session->output_packet;
+
+    const size_t PREFIX_LENGTH = strlen(p_prefix);
+    uint32_t     offset        = 0u;
+    uint32_t     length        = 0u;
+
+    if (2 != SNSCANF(gdb_packet_get_buffer_payload_offset(p_input_packet, PREFIX_LENGTH),
+                     gdb_packet_get_payload_length(p_input_packet) - PREFIX_LENGTH, "%" SCNx32 ",%" SCNx32, &offset,
+                     &length)) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
+
+    if (offset >= document_length) {
+        // Nothing left to read.
+        gdb_reply(p_gdb_session, "l");
+        return;
+    }
+
+    size_t chunk_length = document_length - offset;
+
+    if (chunk_length > length) {
+        chunk_length = length;
+    }
+
+    // All characters could require escaping, which doubles their length.
+    if (chunk_length > GDB_MAX_MEMORY_LENGTH) {
+        chunk_length = GDB_MAX_MEMORY_LENGTH;
+    }
+
+    gdb_packet_write_start(p_output_packet);
+    gdb_packet_write_payload(p_output_packet, ((offset + chunk_length) < document_length) ? "m" : "l");
+    gdb_packet_write_payload_binary(p_output_packet, &p_document[offset], chunk_length);
+    gdb_packet_write_stop(p_output_packet);
+
+    gdb_session_flush(p_gdb_session);
+}
+
+/**
+ * @brief Respond to the query of the target memory map.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param argc The argument count (unused).
+ * @param p_argv The list of argument string pointers (unused).
+ */
+static void gdb_query_memory_map_read(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv) {
+    (void)argc;
+    (void)p_argv;
+
+    if ((p_gdb_session->p_target == NULL) ||
+        !target_mem_map(p_gdb_session->p_target, p_gdb_session->scratch, sizeof(p_gdb_session->scratch))) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
+
+    gdb_query_reply_xfer(p_gdb_session, GDB_QUERY_MEMORY_MAP_READ, p_gdb_session->scratch,
+                         strlen(p_gdb_session->scratch));
+}
+
+/**
+ * @brief Respond to the query of the target description.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param argc The argument count (unused).
+ * @param p_argv The list of argument string pointers (unused).
+ */
+static void gdb_query_features_read(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv) {
+    (void)argc;
+    (void)p_argv;
+
+    // The description is allocated by the target driver.
+    const char* p_description = NULL;
+
+    if (p_gdb_session->p_target != NULL) {
+        p_description = target_regs_description(p_gdb_session->p_target);
+    }
+
+    if (p_description == NULL) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
+
+    gdb_query_reply_xfer(p_gdb_session, GDB_QUERY_FEATURES_READ, p_description, strlen(p_description));
+    free((void*)p_description);
+}
+
+/**
+ * @brief Respond to the query, whether the target was attached to, or started.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param argc The argument count (unused).
+ * @param p_argv The list of argument string pointers (unused).
+ */
+static void gdb_query_attached_to_existing(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv) {
+    (void)argc;
+    (void)p_argv;
+
+    // Targets are always attached to, never started.
+    gdb_reply(p_gdb_session, "1");
+}
+
 /**
  * @brief Respond to the query of the current thread ID.
  *
@@ -95,7 +210,7 @@ static void gdb_query_subsequent_thread_info(struct gdb_session* p_gdb_session,
 }
 
 /**
- * @brief Start the no-ACK mode.
+ * @brief Start the no-ACK mode. Refused on the UDP transport, which relies on acknowledgements for retransmission.
  *
  * @param p_gdb_session A pointer to the GDB session structure.
  * @param argc The argument count (unused).
@@ -105,6 +220,12 @@ static void gdb_query_start_no_ack_mode(struct gdb_session* p_gdb_session, const
     (void)argc;
     (void)p_argv;
 
+    if (p_gdb_session->transport == GDB_SESSION_TRANSPORT_UDP_IP) {
+        // The client keeps acknowledging, if the request is unsupported.
+        gdb_reply(p_gdb_session, GDB_REPLY_EMPTY);
+        return;
+    }
+
     p_gdb_session->properties.b_no_ack_mode = true;
 
     gdb_reply(p_gdb_session, GDB_REPLY_OK);
@@ -118,12 +239,12 @@ const struct gdb_subcommand G_QUERY_COMMANDS[] = {
     {GDB_QUERY_SUPPORTED_FEATURES, NULL, gdb_query_supported},
     {GDB_QUERY_CURRENT_THREAD_ID, NULL, gdb_query_current_thread_id},
     {GDB_QUERY_CRC, NULL, NULL},
-    {GDB_QUERY_MEMORY_MAP_READ, NULL, NULL},
-    {GDB_QUERY_FEATURES_READ, NULL, NULL},
+    {GDB_QUERY_MEMORY_MAP_READ, NULL, gdb_query_memory_map_read},
+    {GDB_QUERY_FEATURES_READ, NULL, gdb_query_features_read},
     {GDB_QUERY_FIRST_THREAD_INFO, NULL, gdb_query_first_thread_info},
     {GDB_QUERY_SUBSEQUENT_THREAD_INFO, NULL, gdb_query_subsequent_thread_info},
     {GDB_QUERY_START_NO_ACK_MODE, NULL, gdb_query_start_no_ack_mode},
-    {GDB_QUERY_ATTACHED_TO_EXISTING, NULL, NULL},
+    {GDB_QUERY_ATTACHED_TO_EXISTING, NULL, gdb_query_attached_to_existing},
 };
 
 /**
@@ -13,18 +13,66 @@
 #include <string.h>
 
 #include "common/hex.h"
+#include "config/config.h"
 #include "gdb/gdb_packet.h"
 #include "gdb_query.h"
+#include "perf/perf.h"
+#include "recorder/recorder.h"
+#include "stats/stats.h"
+#include "target_power/target_voltage.h"
+#include "trace/trace.h"
 
 static void gdb_query_remote_help(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv);
+#if CONFIG_ENABLE == TRUE
+static void gdb_query_remote_config(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv);
+#endif
 static void gdb_query_remote_version(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv);
+#if PERF_ENABLE == TRUE
+static void gdb_query_remote_perf(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv);
+static void gdb_query_remote_latency(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv);
+#endif
+#if STATS_ENABLE == TRUE
+static void gdb_query_remote_stats(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv);
+#endif
+#if TRACE_ENABLE == TRUE
+static void gdb_query_remote_trace(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv);
+#endif
+#if RECORDER_ENABLE == TRUE
+static void gdb_query_remote_recorder(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv);
+#endif
+#if TARGET_VOLTAGE_ENABLE == TRUE
+static void gdb_query_remote_vtarget(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv);
+#endif
 
 /**
  * @brief The supported monitor subcommands.
  */
 const struct gdb_subcommand G_QUERY_REMOTE_SUBCOMMANDS[] = {
+#if CONFIG_ENABLE == TRUE
+    {"config", "Show the settings, change one with 'config <name> <value>', or reset with 'config reset [<name>]'.",
+     gdb_query_remote_config},
+#endif
     {"help", "Show the supported monitor commands.", gdb_query_remote_help},
-    {"version", "Show firmware version information.", gdb_query_remote_version}};
+#if PERF_ENABLE == TRUE
+    {"latency", "Show request latency histograms per stage, or reset them with 'latency reset'.",
+     gdb_query_remote_latency},
+    {"perf", "Show command execution time histograms, or reset them with 'perf reset'.", gdb_query_remote_perf},
+#endif
+#if RECORDER_ENABLE == TRUE
+    {"recorder", "Show the state of the SD card recorder.", gdb_query_remote_recorder},
+#endif
+#if STATS_ENABLE == TRUE
+    {"stats", "Show network startup, network, thread and memory statistics.", gdb_query_remote_stats},
+#endif
+#if TRACE_ENABLE == TRUE
+    {"trace", "Show the event trace state, or discard the post-mortem trace with 'trace reset'.",
+     gdb_query_remote_trace},
+#endif
+    {"version", "Show firmware version information.", gdb_query_remote_version},
+#if TARGET_VOLTAGE_ENABLE == TRUE
+    {"vtarget", "Show the target voltage, and whether the target is powered.", gdb_query_remote_vtarget},
+#endif
+};
 
 /**
  * @brief Respond to the help query, and provide a list of all supported monitor subcommands.
@@ -78,6 +126,192 @@ static void gdb_query_remote_version(struct gdb_session* p_gdb_session, const si
     gdb_session_flush(p_gdb_session);
 }
 
+#if (PERF_ENABLE == TRUE) || (TRACE_ENABLE == TRUE)
+/**
+ * @brief Check, if the first argument of a monitor command is "reset".
+ *
+ * @param argc The argument count.
+ * @param p_argv The list of argument string pointers.
+ * @return bool True, if a reset was requested.
+ */
+static bool gdb_query_remote_is_reset(const size_t argc, const char* p_argv) {
+    const char** pp_argv = (const char**)p_argv;
+
+    return (argc > 1u) && (0 == strcmp(pp_argv[1u], "reset"));
+}
+#endif
+
+#if PERF_ENABLE == TRUE
+
+/**
+ * @brief Show the execution time histograms of all commands, or reset them.
+ * @details Subcommands are listed with their parent command character.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param argc The argument count.
+ * @param p_argv The list of argument string pointers.
+ */
+static void gdb_query_remote_perf(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv) {
+    if (gdb_query_remote_is_reset(argc, p_argv)) {
+        perf_reset();
+        gdb_reply(p_gdb_session, GDB_REPLY_OK);
+        return;
+    }
+
+    const struct report_output OUTPUT = gdb_console_get_report_output(p_gdb_session);
+
+    perf_report(&OUTPUT);
+    gdb_reply(p_gdb_session, GDB_REPLY_OK);
+}
+
+/**
+ * @brief Show the request latency histograms per stage, or reset them.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param argc The argument count.
+ * @param p_argv The list of argument string pointers.
+ */
+static void gdb_query_remote_latency(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv) {
+    if (gdb_query_remote_is_reset(argc, p_argv)) {
+        perf_reset_stages();
+        gdb_reply(p_gdb_session, GDB_REPLY_OK);
+        return;
+    }
+
+    const struct report_output OUTPUT = gdb_console_get_report_output(p_gdb_session);
+
+    perf_report_stages(&OUTPUT);
+    gdb_reply(p_gdb_session, GDB_REPLY_OK);
+}
+#endif  // PERF_ENABLE == TRUE
+
+#if CONFIG_ENABLE == TRUE
+/**
+ * @brief Show the settings of the configuration store, or change them.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param argc The argument count.
+ * @param p_argv The list of argument string pointers.
+ */
+static void gdb_query_remote_config(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv) {
+    const char**    pp_argv = (const char**)p_argv;
+    enum config_key key     = CONFIG_KEY_COUNT;
+
+    if (argc <= 1u) {
+        struct config_usage usage;
+        char                value[CONFIG_STRING_SIZE];
+
+        for (size_t key_index = 0u; key_index < CONFIG_KEY_COUNT; key_index++) {
+            config_format((enum config_key)key_index, value, ARRAY_LENGTH(value));
+            gdb_console_outf(p_gdb_session, "%-20s %s\n", config_get_name((enum config_key)key_index), value);
+        }
+
+        config_get_usage(&usage);
+        gdb_console_outf(p_gdb_session, "Store: %lu of %lu bytes used, erased %lu times.\n",
+                         (unsigned long)usage.used_size, (unsigned long)usage.size, (unsigned long)usage.erase_count);
+    } else if ((argc == 2u) && (0 == strcmp(pp_argv[1u], "reset"))) {
+        gdb_console_outf(p_gdb_session, "%s\n", config_get_result_message(config_reset()));
+    } else if ((argc == 3u) && (0 == strcmp(pp_argv[1u], "reset")) && config_find_key(pp_argv[2u], &key)) {
+        gdb_console_outf(p_gdb_session, "%s\n", config_get_result_message(config_set(key, NULL)));
+    } else if ((argc == 3u) && config_find_key(pp_argv[1u], &key)) {
+        gdb_console_outf(p_gdb_session, "%s\n", config_get_result_message(config_set(key, pp_argv[2u])));
+    } else {
+        gdb_console_outf(p_gdb_session, "Unknown setting, or wrong number of arguments.\n");
+    }
+
+    gdb_reply(p_gdb_session, GDB_REPLY_OK);
+}
+#endif  // CONFIG_ENABLE == TRUE
+
+#if STATS_ENABLE == TRUE
+/**
+ * @brief Show the runtime statistics of the network stack, threads and memory.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param argc The argument count (unused).
+ * @param p_argv The list of argument string pointers (unused).
+ */
+static void gdb_query_remote_stats(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv) {
+    (void)argc;
+    (void)p_argv;
+
+    const struct report_output OUTPUT = gdb_console_get_report_output(p_gdb_session);
+
+    stats_report(&OUTPUT);
+    gdb_reply(p_gdb_session, GDB_REPLY_OK);
+}
+#endif  // STATS_ENABLE == TRUE
+
+#if TRACE_ENABLE == TRUE
+/**
+ * @brief Show the state of the event trace, and the post-mortem trace of the last halt, or discard the latter.
+ * @details The events themselves are streamed on \a NETWORK_TRACE_TCP_PORT (see tools/trace_decode.py).
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param argc The argument count.
+ * @param p_argv The list of argument string pointers.
+ */
+static void gdb_query_remote_trace(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv) {
+    if (gdb_query_remote_is_reset(argc, p_argv)) {
+        trace_clear_post_mortem();
+        gdb_reply(p_gdb_session, GDB_REPLY_OK);
+        return;
+    }
+
+    gdb_console_outf(p_gdb_session, "%lu events traced, %lu in the ring.\n", (unsigned long)g_trace_ring.head,
+                     (unsigned long)TRACE_EVENT_COUNT);
+
+    const struct trace_post_mortem* p_post_mortem = trace_get_post_mortem();
+
+    if (p_post_mortem == NULL) {
+        gdb_console_outf(p_gdb_session, "No post-mortem trace.\n");
+    } else {
+        gdb_console_outf(p_gdb_session, "Post-mortem trace of %lu events, halt reason: %s\n",
+                         (unsigned long)p_post_mortem->event_count, p_post_mortem->reason);
+    }
+
+    gdb_reply(p_gdb_session, GDB_REPLY_OK);
+}
+#endif  // TRACE_ENABLE == TRUE
+
+#if RECORDER_ENABLE == TRUE
+/**
+ * @brief Show the state of the SD card recorder. Formatting is left to the shell, as it discards all data on the card.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param argc The argument count (unused).
+ * @param p_argv The list of argument string pointers (unused).
+ */
+static void gdb_query_remote_recorder(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv) {
+    (void)argc;
+    (void)p_argv;
+
+    const struct report_output OUTPUT = gdb_console_get_report_output(p_gdb_session);
+
+    recorder_report(&OUTPUT);
+    gdb_reply(p_gdb_session, GDB_REPLY_OK);
+}
+#endif  // RECORDER_ENABLE == TRUE
+
+#if TARGET_VOLTAGE_ENABLE == TRUE
+/**
+ * @brief Show the target voltage, and the power state of the target.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param argc The argument count (unused).
+ * @param p_argv The list of argument string pointers (unused).
+ */
+static void gdb_query_remote_vtarget(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv) {
+    (void)argc;
+    (void)p_argv;
+
+    const struct report_output OUTPUT = gdb_console_get_report_output(p_gdb_session);
+
+    target_voltage_report(&OUTPUT);
+    gdb_reply(p_gdb_session, GDB_REPLY_OK);
+}
+#endif  // TARGET_VOLTAGE_ENABLE == TRUE
+
 /**
  * @brief Execute a remote command on the server.
  *
@@ -0,0 +1,215 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The GDB 'v' (sub)command handling module.
+ * @details Handles attaching to targets, and flash programming.
+ *
+ * @addtogroup gdb
+ * @{
+ */
+
+#include "gdb_v.h"
+
+#include <string.h>
+
+#include "target_power/target_voltage.h"
+
+#define GDB_V_ATTACH           "vAttach;"
+#define GDB_V_KILL             "vKill;"
+#define GDB_V_FLASH_ERASE      "vFlashErase:"
+#define GDB_V_FLASH_WRITE      "vFlashWrite:"
+#define GDB_V_FLASH_DONE       "vFlashDone"
+#define GDB_V_CONTINUE_ACTIONS "vCont?"
+#define GDB_V_RUN              "vRun"
+#define GDB_V_MUST_REPLY_EMPTY "vMustReplyEmpty"
+
+/**
+ * @brief Attach to a target by its number in the target list.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param argc The argument count (unused).
+ * @param p_argv The list of argument string pointers (unused).
+ */
+static void gdb_v_attach(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv) {
+    (void)argc;
+    (void)p_argv;
+
+    const char* p_payload       = gdb_packet_get_buffer_payload(&p_gdb_session->input_packet);
+    uint32_t    target_number   = 0u;
+    size_t      payload_length  = gdb_packet_get_payload_length(&p_gdb_session->input_packet);
+    const char* p_target_number = &p_payload[strlen(GDB_V_ATTACH)];
+
+    if (1 != SNSCANF(p_target_number, payload_length - strlen(GDB_V_ATTACH), "%" SCNx32, &target_number)) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
+
+#if TARGET_VOLTAGE_ENABLE == TRUE
+    if (!target_voltage_wait_present(TARGET_VOLTAGE_ATTACH_TIMEOUT_MS)) {
+        // An unpowered target would only run into the SWD timeouts.
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_02);
+        return;
+    }
+#endif
+
+    if (p_gdb_session->p_target != NULL) {
+        target_detach(p_gdb_session->p_target);
+    }
+
+    p_gdb_session->b_target_running = false;
+    p_gdb_session->b_target_lost    = false;
+    p_gdb_session->p_target         = target_attach_n(target_number, &p_gdb_session->target_controller);
+
+    if (p_gdb_session->p_target == NULL) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_01);
+        return;
+    }
+
+    p_gdb_session->target_number = target_number;
+#if TARGET_VOLTAGE_ENABLE == TRUE
+    p_gdb_session->power_up_count = target_voltage_get_power_up_count();
+#endif
+
+    gdb_reply_stop(p_gdb_session, TARGET_HALT_REQUEST, 0u);
+}
+
+/**
+ * @brief Kill the process, which detaches from the target.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param argc The argument count (unused).
+ * @param p_argv The list of argument string pointers (unused).
+ */
+static void gdb_v_kill(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv) {
+    (void)argc;
+    (void)p_argv;
+
+    if (p_gdb_session->p_target != NULL) {
+        target_reset(p_gdb_session->p_target);
+        target_detach(p_gdb_session->p_target);
+    }
+
+    p_gdb_session->p_target         = NULL;
+    p_gdb_session->b_target_running = false;
+    p_gdb_session->b_target_lost    = false;
+
+    gdb_reply(p_gdb_session, GDB_REPLY_OK);
+}
+
+/**
+ * @brief Erase a region of target flash.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param argc The argument count (unused).
+ * @param p_argv The list of argument string pointers (unused).
+ */
+static void gdb_v_flash_erase(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv) {
+    (void)argc;
+    (void)p_argv;
+
+    size_t   arguments_length = 0u;
+    char*    p_arguments      = gdb_get_data(p_gdb_session, ':', &arguments_length);
+    uint32_t address          = 0u;
+    uint32_t length           = 0u;
+
+    if ((p_gdb_session->p_target == NULL) || (p_arguments == NULL) ||
+        (2 != SNSCANF(p_arguments, arguments_length, "%" SCNx32 ",%" SCNx32, &address, &length))) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_FF);
+        return;
+    }
+
+    if (!target_flash_erase(p_gdb_session->p_target, address, length)) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_FF);
+        return;
+    }
+
+    gdb_reply(p_gdb_session, GDB_REPLY_OK);
+}
+
+/**
+ * @brief Write binary data to target flash.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param argc The argument count (unused).
+ * @param p_argv The list of argument string pointers (unused).
+ */
+static void gdb_v_flash_write(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv) {
+    (void)argc;
+    (void)p_argv;
+
+    size_t   arguments_length = 0u;
+    char*    p_arguments      = gdb_get_data(p_gdb_session, ':', &arguments_length);
+    uint32_t address          = 0u;
+
+    if ((p_gdb_session->p_target == NULL) || (p_arguments == NULL) ||
+        (1 != SNSCANF(p_arguments, arguments_length, "%" SCNx32, &address))) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_FF);
+        return;
+    }
+
+    // The data follows the address, separated by another colon.
+    char* p_data = memchr(p_arguments, ':', arguments_length);
+
+    if (p_data == NULL) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_FF);
+        return;
+    }
+
+    p_data++;
+    size_t length = gdb_packet_unescape_binary(p_data, arguments_length - (size_t)(p_data - p_arguments));
+
+    if (!target_flash_write(p_gdb_session->p_target, address, p_data, length)) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_FF);
+        return;
+    }
+
+    gdb_reply(p_gdb_session, GDB_REPLY_OK);
+}
+
+/**
+ * @brief Finish flash programming.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ * @param argc The argument count (unused).
+ * @param p_argv The list of argument string pointers (unused).
+ */
+static void gdb_v_flash_done(struct gdb_session* p_gdb_session, const size_t argc, const char* p_argv) {
+    (void)argc;
+    (void)p_argv;
+
+    if ((p_gdb_session->p_target == NULL) || !target_flash_complete(p_gdb_session->p_target)) {
+        gdb_reply(p_gdb_session, GDB_REPLY_ERROR_FF);
+        return;
+    }
+
+    gdb_reply(p_gdb_session, GDB_REPLY_OK);
+}
+
+/**
+ * @brief Supported 'v' commands.
+ */
+const struct gdb_subcommand G_V_COMMANDS[] = {
+    {GDB_V_ATTACH, NULL, gdb_v_attach},
+    {GDB_V_KILL, NULL, gdb_v_kill},
+    {GDB_V_FLASH_ERASE, NULL, gdb_v_flash_erase},
+    {GDB_V_FLASH_WRITE, NULL, gdb_v_flash_write},
+    {GDB_V_FLASH_DONE, NULL, gdb_v_flash_done},
+    {GDB_V_CONTINUE_ACTIONS, NULL, NULL},
+    {GDB_V_RUN, NULL, NULL},
+    {GDB_V_MUST_REPLY_EMPTY, NULL, NULL},
+};
+
+/**
+ * @brief Entry point to handling 'v' commands.
+ *
+ * @param p_gdb_session A pointer to the GDB session structure.
+ */
+void gdb_v(struct gdb_session* p_gdb_session) {
+    gdb_execute_sub(gdb_packet_get_buffer_payload(&p_gdb_session->input_packet), p_gdb_session, G_V_COMMANDS,
+                    ARRAY_LENGTH(G_V_COMMANDS), 0u, NULL);
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,23 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The GDB 'v' (sub)command handling module headers.
+ *
+ * @addtogroup gdb
+ * @{
+ */
+
+#ifndef SOURCE_GDB_V_GDB_V_H_
+#define SOURCE_GDB_V_GDB_V_H_
+
+#include "gdb/gdb.h"
+#include "gdb/gdb_session.h"
+
+void gdb_v(struct gdb_session* p_gdb_session);
+
+#endif  // SOURCE_GDB_V_GDB_V_H_
+
+/**
+ * @}
+ */
@@ -12,10 +12,16 @@
 #include <stdio.h>
 
 #include "ch.h"
+#include "config/config.h"
 #include "gdb/gdb_session.h"
 #include "hal.h"
 #include "network/network.h"
+#include "recorder/recorder.h"
+#include "target_power/power_profile.h"
+#include "target_power/target_voltage.h"
 #include "usb_cdc/shell_interface.h"
+#include "usb_cdc/usb_gdb.h"
+#include "usb_cdc/usb_trace.h"
 
 /**
  * @brief Application entry point.
@@ -31,9 +37,27 @@ int main(void) {
     palClearLine(LINE_LED_RED);
     palClearLine(LINE_LED_GREEN);
 
+    config_init();
+#if TARGET_VOLTAGE_ENABLE == TRUE
+    target_voltage_init();
+#endif
+#if POWER_PROFILE_ENABLE == TRUE
+    power_profile_init();
+#endif
+#if RECORDER_ENABLE == TRUE
+    recorder_init();
+#endif
     gdb_session_init();
     network_init();
+#if TRACE_ENABLE == TRUE
+    usb_trace_init();
+#endif
+
+#if USB_GDB_ENABLE == TRUE
+    usb_gdb_start_thread();
+#else
     shell_interface_start_thread();
+#endif
 
     while (true) {
         palToggleLine(LINE_LED_RED);
@@ -3,7 +3,8 @@
 /**
  * @file
  * @brief   The network module.
- * @details Provides a TCP server for GDB to connect to.
+ * @details Provides a TCP server for GDB to connect to. It listens right away, before the link is up, such that
+ * connections are accepted as soon as an address is usable (see network_startup.c).
  *
  * @addtogroup network
  * @{
@@ -13,22 +14,67 @@
 
 #include <string.h>
 
+#include "common/memory.h"
+#include "config/config.h"
 #include "gdb/gdb_session.h"
 #include "lwip/api.h"
 #include "lwip/netif.h"
 #include "lwip/opt.h"
 #include "lwip/sys.h"
 #include "lwipthread.h"
+#include "network_benchmark.h"
+#include "network_gdb_udp.h"
+#include "network_power.h"
+#include "network_recorder.h"
+#include "network_startup.h"
+#include "network_tcp.h"
+#include "network_telemetry.h"
+#include "network_trace.h"
+#include "perf/perf.h"
 
 #define NETWORK_TCP_SERVER_STACK_SIZE 2048u
 
+/**
+ * @brief The TCP policy of the GDB port. Stepping exchanges many tiny packets, which must not be delayed.
+ */
+#define NETWORK_GDB_TCP_POLICY (&G_NETWORK_TCP_POLICY_INTERACTIVE)
+
+#if CONFIG_ENABLE != TRUE
+#error "The network settings are read from the configuration store."
+#endif
+
+#if MAC_USE_ZERO_COPY == TRUE
+#error "The lwIP pools are placed in CCM (see lwipopts.h), which the Ethernet DMA cannot access."
+#endif
+
+#if NETWORK_PROFILE_BULK
+/**
+ * @brief The lwIP heap of the bulk network profile, which does not fit into CCM next to the pools.
+ */
+unsigned char g_network_lwip_heap[NETWORK_LWIP_HEAP_SIZE] __attribute__((aligned(MEM_ALIGNMENT)));
+#endif
+
 static struct network_gdb_session {
     struct netconn *p_conn;  ///< A pointer to the netconn structure, on which the GDB client is served.
     err_t           err;
 } g_network_gdb_session;
 
-static bool network_gdb_write_cb(char *p_data, size_t size) {
-    g_network_gdb_session.err = netconn_write(g_network_gdb_session.p_conn, p_data, size, NETCONN_COPY);
+/**
+ * @brief Write GDB output to the client.
+ * @details Data that is followed by more right away is written without the push flag. The policy of the GDB port
+ * disables Nagle's algorithm, so that every write is still sent immediately.
+ *
+ * @param p_data A pointer to the data to write.
+ * @param size The size of the data.
+ * @param b_more True, if more data follows right away.
+ * @return bool True, if the data was written.
+ */
+static bool network_gdb_write_cb(char *p_data, size_t size, bool b_more) {
+    const uint8_t FLAGS = NETCONN_COPY | (b_more ? NETCONN_MORE : 0u);
+
+    TRACE(TRACE_ID_NETWORK_WRITE, size, 0u);
+    PERF_TRANSMIT(g_network_gdb_session.err = netconn_write(g_network_gdb_session.p_conn, p_data, size, FLAGS));
+    TRACE(TRACE_ID_NETWORK_WRITTEN, size, (int32_t)g_network_gdb_session.err);
     return (g_network_gdb_session.err == ERR_OK) ? true : false;
 }
 
@@ -73,10 +119,23 @@ static void network_serve(void) {
     err_t          err = ERR_OK;
     struct netbuf *p_netbuf;
 
+    // Wake up regularly, for polling a running target.
+    netconn_set_recvtimeout(g_network_gdb_session.p_conn, GDB_SESSION_POLL_INTERVAL_MS);
+
     while (err == ERR_OK) {
         err = netconn_recv(g_network_gdb_session.p_conn, &p_netbuf);
 
+        if (err == ERR_TIMEOUT) {
+            gdb_session_poll();
+
+            err = (gdb_session_get_state() == GDB_SESSION_STATE_ABORTED) ? ERR_ABRT : ERR_OK;
+            continue;
+        }
+
         if (err == ERR_OK) {
+            PERF_MARK(PERF_MARK_RECEIVED);
+            TRACE(TRACE_ID_NETWORK_RECEIVE, netbuf_len(p_netbuf), 0u);
+            network_tcp_received(g_network_gdb_session.p_conn, NETWORK_GDB_TCP_POLICY);
             err = network_serve_gdb(p_netbuf);
         }
 
@@ -84,7 +143,7 @@ static void network_serve(void) {
     }
 }
 
-THD_WORKING_AREA(wa_network_tcp_server, NETWORK_TCP_SERVER_STACK_SIZE);
+MEMORY_CCM_NOINIT THD_WORKING_AREA(wa_network_tcp_server, NETWORK_TCP_SERVER_STACK_SIZE);
 
 /**
  * @brief The TCP server thread.
@@ -101,16 +160,18 @@ THD_FUNCTION(network_tcp_server, p_arg) {
     p_tcp_conn = netconn_new(NETCONN_TCP);
     LWIP_ERROR("tcp: invalid conn", (p_tcp_conn != NULL), chThdExit(MSG_RESET););
 
-    err = netconn_bind(p_tcp_conn, IP4_ADDR_ANY, NETWORK_FIRST_TCP_PORT);
+    err = netconn_bind(p_tcp_conn, IP4_ADDR_ANY, (u16_t)config_get_u32(CONFIG_KEY_GDB_PORT));
     LWIP_ERROR("tcp: could not bind", (err == ERR_OK), chThdExit(MSG_RESET););
 
     netconn_listen(p_tcp_conn);
+    network_startup_mark_listening();
 
     // Set final thread priority.
     chThdSetPriority(LOWPRIO + 2);
 
     while (true) {
         g_network_gdb_session.p_conn = NULL;
+        g_network_gdb_session.err    = ERR_OK;
 
         err = netconn_accept(p_tcp_conn, &g_network_gdb_session.p_conn);
         if (err != ERR_OK) {
@@ -124,6 +185,7 @@ THD_FUNCTION(network_tcp_server, p_arg) {
             continue;
         }
 
+        network_tcp_apply_policy(g_network_gdb_session.p_conn, NETWORK_GDB_TCP_POLICY);
         network_serve();
         netconn_close(g_network_gdb_session.p_conn);
         netconn_delete(g_network_gdb_session.p_conn);
@@ -133,12 +195,39 @@ THD_FUNCTION(network_tcp_server, p_arg) {
 }
 
 /**
- * @brief Initialize the networking thread.
+ * @brief Initialize the networking thread. The configuration store must be loaded.
  */
 void network_init(void) {
-    lwipInit(NULL);
+    lwipthread_opts_t opts;
+
+    network_startup_configure(&opts);
+    lwipInit(&opts);
 
     chThdCreateStatic(wa_network_tcp_server, sizeof(wa_network_tcp_server), NORMALPRIO + 1, network_tcp_server, NULL);
+
+#if PERF_ENABLE == TRUE
+    network_telemetry_init();
+#endif
+
+#if TRACE_ENABLE == TRUE
+    network_trace_init();
+#endif
+
+#if NETWORK_BENCHMARK_ENABLE == TRUE
+    network_benchmark_init();
+#endif
+
+#if NETWORK_GDB_UDP_ENABLE == TRUE
+    network_gdb_udp_init();
+#endif
+
+#if POWER_PROFILE_ENABLE == TRUE
+    network_power_init();
+#endif
+
+#if RECORDER_ENABLE == TRUE
+    network_recorder_init();
+#endif
 }
 
 /**
@@ -0,0 +1,132 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The network benchmark module.
+ * @details Measures the sustained TCP throughput of the network stack, independent of the GDB protocol and of the
+ * target, e.g. for comparing network profiles (see tools/tcp_throughput.py). Data is written with \a NETCONN_COPY,
+ * like replies of the GDB server, so that it passes through the lwIP heap and send buffer.
+ *
+ * @addtogroup network
+ * @{
+ */
+
+#include "network_benchmark.h"
+
+#include "common/memory.h"
+#include "config/config.h"
+#include "lwip/api.h"
+#include "network_tcp.h"
+
+#if NETWORK_BENCHMARK_ENABLE == TRUE
+
+#define NETWORK_BENCHMARK_STACK_SIZE 1024u
+
+/**
+ * @brief The data that is sent in source mode. Its content is irrelevant.
+ */
+static char g_network_benchmark_data[TCP_MSS];
+
+/**
+ * @brief Send data, until the connection fails.
+ *
+ * @param p_conn A pointer to the client connection.
+ */
+static void network_benchmark_source(struct netconn* p_conn) {
+    err_t err = ERR_OK;
+
+    while (err == ERR_OK) {
+        err = netconn_write(p_conn, g_network_benchmark_data, sizeof(g_network_benchmark_data), NETCONN_COPY);
+    }
+}
+
+/**
+ * @brief Receive and discard data, until the connection fails.
+ *
+ * @param p_conn A pointer to the client connection.
+ */
+static void network_benchmark_discard(struct netconn* p_conn) {
+    struct pbuf* p_pbuf = NULL;
+
+    while (netconn_recv_tcp_pbuf(p_conn, &p_pbuf) == ERR_OK) {
+        pbuf_free(p_pbuf);
+    }
+}
+
+/**
+ * @brief Serve a client in the mode that it selects with its first byte (see \a enum network_benchmark_mode).
+ *
+ * @param p_conn A pointer to the client connection.
+ */
+static void network_benchmark_serve(struct netconn* p_conn) {
+    struct pbuf* p_pbuf = NULL;
+
+    if (netconn_recv_tcp_pbuf(p_conn, &p_pbuf) != ERR_OK) {
+        return;
+    }
+
+    const uint8_t MODE = pbuf_get_at(p_pbuf, 0u);
+    pbuf_free(p_pbuf);
+
+    switch (MODE) {
+        case NETWORK_BENCHMARK_MODE_SOURCE:
+            network_benchmark_source(p_conn);
+            break;
+
+        case NETWORK_BENCHMARK_MODE_DISCARD:
+            network_benchmark_discard(p_conn);
+            break;
+
+        default:
+            break;
+    }
+}
+
+MEMORY_CCM_NOINIT THD_WORKING_AREA(wa_network_benchmark, NETWORK_BENCHMARK_STACK_SIZE);
+
+/**
+ * @brief The benchmark server thread.
+ *
+ * @param p_arg A pointer to arguments to the benchmark server, unused.
+ */
+THD_FUNCTION(network_benchmark, p_arg) {
+    (void)p_arg;
+    struct netconn* p_listen_conn = NULL;
+    err_t           err;
+
+    chRegSetThreadName("network_benchmark");
+
+    p_listen_conn = netconn_new(NETCONN_TCP);
+    LWIP_ERROR("benchmark: invalid conn", (p_listen_conn != NULL), chThdExit(MSG_RESET););
+
+    err = netconn_bind(p_listen_conn, IP4_ADDR_ANY, (u16_t)config_get_u32(CONFIG_KEY_BENCHMARK_PORT));
+    LWIP_ERROR("benchmark: could not bind", (err == ERR_OK), chThdExit(MSG_RESET););
+
+    netconn_listen(p_listen_conn);
+
+    while (true) {
+        struct netconn* p_conn = NULL;
+
+        if (netconn_accept(p_listen_conn, &p_conn) != ERR_OK) {
+            continue;
+        }
+
+        network_tcp_apply_policy(p_conn, &G_NETWORK_TCP_POLICY_BULK);
+        network_benchmark_serve(p_conn);
+        netconn_close(p_conn);
+        netconn_delete(p_conn);
+    }
+}
+
+/**
+ * @brief Start the benchmark server thread. Must be called after the initialization of lwIP.
+ */
+void network_benchmark_init(void) {
+    chThdCreateStatic(wa_network_benchmark, sizeof(wa_network_benchmark), LOWPRIO + 1, network_benchmark, NULL);
+}
+
+#endif  // NETWORK_BENCHMARK_ENABLE == TRUE
+
+/**
+ * @}
+ */
@@ -0,0 +1,42 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The network benchmark module headers.
+ *
+ * @addtogroup network
+ * @{
+ */
+
+#ifndef SOURCE_NETWORK_NETWORK_BENCHMARK_H_
+#define SOURCE_NETWORK_NETWORK_BENCHMARK_H_
+
+#include "common/common.h"
+
+/**
+ * @brief Enables the TCP throughput benchmark service.
+ */
+#ifndef NETWORK_BENCHMARK_ENABLE
+#define NETWORK_BENCHMARK_ENABLE FALSE
+#endif
+
+/**
+ * @brief The TCP port of the benchmark service.
+ */
+#define NETWORK_BENCHMARK_TCP_PORT 2003
+
+/**
+ * @brief The first byte that a client sends selects the direction of the transfer.
+ */
+enum network_benchmark_mode {
+    NETWORK_BENCHMARK_MODE_SOURCE  = 'S',  ///< The probe sends data, until the client disconnects.
+    NETWORK_BENCHMARK_MODE_DISCARD = 'D',  ///< The probe receives and discards data, until the client disconnects.
+};
+
+void network_benchmark_init(void);
+
+#endif  // SOURCE_NETWORK_NETWORK_BENCHMARK_H_
+
+/**
+ * @}
+ */
@@ -0,0 +1,256 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The network GDB UDP transport module.
+ * @details Serves a GDB session over UDP on the GDB UDP port (\a NETWORK_GDB_UDP_PORT by default). Without TCP, a
+ * lost segment does not hold back the packets behind it, and there are no delayed ACKs - a step costs one datagram in
+ * each direction. Stock GDB connects through the relay in tools/gdb_udp_relay.py.
+ *
+ * Datagrams carry the plain RSP byte stream. Lost data is recovered by the acknowledgements of the protocol, so the
+ * no-ACK mode is refused on this transport: the client sends a rejected or unanswered packet again, and a rejection
+ * ('-') makes the probe send its last reply again. The acknowledgement and the reply to a packet share one datagram.
+ *
+ * The first client that sends a datagram owns the session, and datagrams of other clients are dropped. The session is
+ * released, when the client sends a single EOT character, or after \a NETWORK_GDB_UDP_IDLE_TIMEOUT_MS without a
+ * datagram. Empty datagrams keep it alive.
+ *
+ * @addtogroup network
+ * @{
+ */
+
+#include "network_gdb_udp.h"
+
+#include <string.h>
+
+#include "common/memory.h"
+#include "config/config.h"
+#include "gdb/gdb_session.h"
+#include "lwip/api.h"
+#include "perf/perf.h"
+#include "trace/trace.h"
+
+#if NETWORK_GDB_UDP_ENABLE == TRUE
+
+#define NETWORK_GDB_UDP_STACK_SIZE 2048u
+
+/**
+ * @brief The size of an outgoing datagram: a reply, preceded by the acknowledgement of the request.
+ */
+#define NETWORK_GDB_UDP_DATAGRAM_SIZE (GDB_PACKET_MAX_BUFFER_LENGTH + 1u)
+
+/**
+ * @brief The state of the UDP transport.
+ */
+static struct network_gdb_udp {
+    struct netconn* p_conn;           ///< A pointer to the netconn structure of the GDB UDP port.
+    bool            b_active;         ///< True, if this transport owns the GDB session.
+    ip_addr_t       peer_address;     ///< The address of the client that owns the session.
+    u16_t           peer_port;        ///< The port of the client that owns the session.
+    systime_t       last_receive;     ///< The time of the last datagram from the client.
+    size_t          datagram_length;  ///< The length of the pending outgoing datagram.
+    char            datagram[NETWORK_GDB_UDP_DATAGRAM_SIZE];  ///< The pending outgoing datagram.
+} g_network_gdb_udp;
+
+/**
+ * @brief Send the pending outgoing datagram to the client.
+ *
+ * @return bool True, if the datagram was sent.
+ */
+static bool network_gdb_udp_send(void) {
+    struct netbuf* p_netbuf = netbuf_new();
+    err_t          err      = ERR_MEM;
+
+    if (p_netbuf != NULL) {
+        err = netbuf_ref(p_netbuf, g_network_gdb_udp.datagram, (u16_t)g_network_gdb_udp.datagram_length);
+
+        if (err == ERR_OK) {
+            TRACE(TRACE_ID_NETWORK_WRITE, g_network_gdb_udp.datagram_length, 0u);
+            PERF_TRANSMIT(err = netconn_sendto(g_network_gdb_udp.p_conn, p_netbuf, &g_network_gdb_udp.peer_address,
+                                               g_network_gdb_udp.peer_port));
+            TRACE(TRACE_ID_NETWORK_WRITTEN, g_network_gdb_udp.datagram_length, (int32_t)err);
+        }
+
+        netbuf_delete(p_netbuf);
+    }
+
+    g_network_gdb_udp.datagram_length = 0u;
+    return (err == ERR_OK) ? true : false;
+}
+
+/**
+ * @brief Write GDB output to the client.
+ * @details Data that is followed by more right away is collected, and sent in one datagram with the rest.
+ *
+ * @param p_data A pointer to the data to write.
+ * @param size The size of the data.
+ * @param b_more True, if more data follows right away.
+ * @return bool True, if the data was written. A lost datagram is not detected, and recovered by the client.
+ */
+static bool network_gdb_udp_write_cb(char* p_data, size_t size, bool b_more) {
+    ASSERT_VERBOSE(size <= NETWORK_GDB_UDP_DATAGRAM_SIZE, "Packet exceeds the datagram size.");
+
+    bool b_success = true;
+
+    if ((g_network_gdb_udp.datagram_length + size) > NETWORK_GDB_UDP_DATAGRAM_SIZE) {
+        b_success = network_gdb_udp_send();
+    }
+
+    memcpy(&g_network_gdb_udp.datagram[g_network_gdb_udp.datagram_length], p_data, size);
+    g_network_gdb_udp.datagram_length += size;
+
+    if (b_more) {
+        return b_success;
+    }
+
+    return network_gdb_udp_send() && b_success;
+}
+
+/**
+ * @brief Release the GDB session, if this transport owns it.
+ */
+static void network_gdb_udp_release(void) {
+    if (!g_network_gdb_udp.b_active) {
+        return;
+    }
+
+    gdb_session_release();
+    g_network_gdb_udp.b_active = false;
+}
+
+/**
+ * @brief Check, if a datagram belongs to the session. The first client that sends a datagram locks the session.
+ *
+ * @param p_netbuf A pointer to the received netbuf.
+ * @return bool True, if the datagram belongs to the session.
+ */
+static bool network_gdb_udp_accept(struct netbuf* p_netbuf) {
+    const ip_addr_t* p_address = netbuf_fromaddr(p_netbuf);
+    const u16_t      PORT      = netbuf_fromport(p_netbuf);
+
+    if (g_network_gdb_udp.b_active) {
+        return ip_addr_cmp(p_address, &g_network_gdb_udp.peer_address) && (PORT == g_network_gdb_udp.peer_port);
+    }
+
+    if (!gdb_session_lock(GDB_SESSION_TRANSPORT_UDP_IP, network_gdb_udp_write_cb)) {
+        // Session is already locked by another transport.
+        return false;
+    }
+
+    ip_addr_copy(g_network_gdb_udp.peer_address, *p_address);
+    g_network_gdb_udp.peer_port       = PORT;
+    g_network_gdb_udp.datagram_length = 0u;
+    g_network_gdb_udp.b_active        = true;
+    return true;
+}
+
+/**
+ * @brief Serve GDB with a received datagram.
+ *
+ * @param p_netbuf A pointer to the received netbuf.
+ */
+static void network_gdb_udp_serve(struct netbuf* p_netbuf) {
+    if (!network_gdb_udp_accept(p_netbuf)) {
+        return;
+    }
+
+    g_network_gdb_udp.last_receive = chVTGetSystemTimeX();
+    PERF_MARK(PERF_MARK_RECEIVED);
+    TRACE(TRACE_ID_NETWORK_RECEIVE, netbuf_len(p_netbuf), 0u);
+
+    if ((netbuf_len(p_netbuf) == 1u) && (pbuf_get_at(p_netbuf->p, 0u) == GDB_PACKET_CHAR_EOT)) {
+        // The client ends the session.
+        network_gdb_udp_release();
+        return;
+    }
+
+    // A fragmented datagram is received as a chain of buffers.
+    netbuf_first(p_netbuf);
+
+    do {
+        char*    p_data    = NULL;
+        uint16_t data_size = 0u;
+
+        if (netbuf_data(p_netbuf, (void**)&p_data, &data_size) != ERR_OK) {
+            break;
+        }
+
+        size_t total_consumed_size = 0u;
+        while ((total_consumed_size < data_size) && (gdb_session_get_state() == GDB_SESSION_STATE_ACTIVE)) {
+            total_consumed_size += gdb_session_handle(&p_data[total_consumed_size], data_size - total_consumed_size);
+        }
+    } while (netbuf_next(p_netbuf) >= 0);
+
+    if (g_network_gdb_udp.datagram_length > 0u) {
+        // An acknowledgement without a reply yet (e.g. when resuming the target) must not wait for one.
+        (void)network_gdb_udp_send();
+    }
+
+    if (gdb_session_get_state() == GDB_SESSION_STATE_ABORTED) {
+        network_gdb_udp_release();
+    }
+}
+
+/**
+ * @brief Poll a running target, and release the session, if the client went away.
+ */
+static void network_gdb_udp_idle(void) {
+    if (!g_network_gdb_udp.b_active) {
+        return;
+    }
+
+    gdb_session_poll();
+
+    if ((gdb_session_get_state() == GDB_SESSION_STATE_ABORTED) ||
+        (chVTTimeElapsedSinceX(g_network_gdb_udp.last_receive) >= TIME_MS2I(NETWORK_GDB_UDP_IDLE_TIMEOUT_MS))) {
+        network_gdb_udp_release();
+    }
+}
+
+MEMORY_CCM_NOINIT THD_WORKING_AREA(wa_network_gdb_udp, NETWORK_GDB_UDP_STACK_SIZE);
+
+/**
+ * @brief The GDB UDP server thread.
+ *
+ * @param p_arg A pointer to arguments to the GDB UDP server, unused.
+ */
+THD_FUNCTION(network_gdb_udp, p_arg) {
+    (void)p_arg;
+    err_t err;
+
+    chRegSetThreadName("network_gdb_udp");
+
+    g_network_gdb_udp.p_conn = netconn_new(NETCONN_UDP);
+    LWIP_ERROR("gdb udp: invalid conn", (g_network_gdb_udp.p_conn != NULL), chThdExit(MSG_RESET););
+
+    err = netconn_bind(g_network_gdb_udp.p_conn, IP4_ADDR_ANY, (u16_t)config_get_u32(CONFIG_KEY_GDB_UDP_PORT));
+    LWIP_ERROR("gdb udp: could not bind", (err == ERR_OK), chThdExit(MSG_RESET););
+
+    // Wake up regularly, for polling a running target.
+    netconn_set_recvtimeout(g_network_gdb_udp.p_conn, GDB_SESSION_POLL_INTERVAL_MS);
+
+    while (true) {
+        struct netbuf* p_netbuf = NULL;
+
+        if (netconn_recv(g_network_gdb_udp.p_conn, &p_netbuf) != ERR_OK) {
+            network_gdb_udp_idle();
+            continue;
+        }
+
+        network_gdb_udp_serve(p_netbuf);
+        netbuf_delete(p_netbuf);
+    }
+}
+
+/**
+ * @brief Start the GDB UDP server thread. Must be called after the initialization of lwIP.
+ */
+void network_gdb_udp_init(void) {
+    chThdCreateStatic(wa_network_gdb_udp, sizeof(wa_network_gdb_udp), LOWPRIO + 2, network_gdb_udp, NULL);
+}
+
+#endif  // NETWORK_GDB_UDP_ENABLE == TRUE
+
+/**
+ * @}
+ */
@@ -0,0 +1,40 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The network GDB UDP transport module headers.
+ *
+ * @addtogroup network
+ * @{
+ */
+
+#ifndef SOURCE_NETWORK_NETWORK_GDB_UDP_H_
+#define SOURCE_NETWORK_NETWORK_GDB_UDP_H_
+
+#include "common/common.h"
+
+/**
+ * @brief Enables the GDB UDP transport.
+ */
+#ifndef NETWORK_GDB_UDP_ENABLE
+#define NETWORK_GDB_UDP_ENABLE FALSE
+#endif
+
+/**
+ * @brief The UDP port, on which GDB sessions are served.
+ */
+#define NETWORK_GDB_UDP_PORT 2004
+
+/**
+ * @brief The time without datagrams from the client, after which the session is released. Clients send empty
+ * datagrams to keep an otherwise quiet session (e.g. with a running target) alive.
+ */
+#define NETWORK_GDB_UDP_IDLE_TIMEOUT_MS 5000u
+
+void network_gdb_udp_init(void);
+
+#endif  // SOURCE_NETWORK_NETWORK_GDB_UDP_H_
+
+/**
+ * @}
+ */
@@ -0,0 +1,153 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The network mDNS responder module.
+ * @details Announces the probe as "<hostname>.local", and its services with DNS-SD, such that probes can be found
+ * without maintaining DNS entries (e.g. "avahi-browse _gdbremote._tcp"). The instance names contain the serial number
+ * of the MCU, which keeps them unique in a fleet. The host name is taken from the configuration store, and has to be
+ * unique as well.
+ *
+ * The lwIP responder runs in the lwIP thread. It is started on the first link up, and re-announces on address changes,
+ * both driven by the callbacks of the network startup - no polling is involved.
+ *
+ * @addtogroup network
+ * @{
+ */
+
+#include "network_mdns.h"
+
+#include "common/common.h"
+#include "config/config.h"
+#include "gdb/gdb_session.h"
+#include "lwip/apps/mdns.h"
+#include "lwip/igmp.h"
+#include "perf/perf.h"
+#include "trace/trace.h"
+
+#if LWIP_MDNS_RESPONDER
+
+/**
+ * @brief The length of the serial number: the 96 bit unique ID of the MCU in hexadecimal.
+ */
+#define NETWORK_MDNS_SERIAL_NUMBER_LENGTH 24u
+
+/**
+ * @brief The state of the responder.
+ */
+static struct {
+    bool b_started;                                              ///< True, if the responder was started.
+    char serial_number[NETWORK_MDNS_SERIAL_NUMBER_LENGTH + 1u];  ///< The serial number.
+    char instance_name[MDNS_LABEL_MAXLEN + 1u];                  ///< The service instance name.
+} g_network_mdns;
+
+/**
+ * @brief Add a TXT item to a service.
+ *
+ * @param p_service A pointer to the service.
+ * @param p_key A pointer to the key.
+ * @param p_value A pointer to the value.
+ */
+static void network_mdns_add_txt(struct mdns_service* p_service, const char* p_key, const char* p_value) {
+    char         item[64];
+    const size_t LENGTH = (size_t)SNPRINTF(item, ARRAY_LENGTH(item), "%s=%s", p_key, p_value);
+
+    (void)mdns_resp_add_service_txtitem(p_service, item,
+                                        (u8_t)((LENGTH < sizeof(item)) ? LENGTH : (sizeof(item) - 1u)));
+}
+
+/**
+ * @brief Provide the TXT records of a service. Called by the responder for every answer, so the attached target is
+ * always current.
+ * @details The lwIP thread has a higher priority than the GDB session thread, so the target cannot be destroyed while
+ * its name is read.
+ *
+ * @param p_service A pointer to the service.
+ * @param p_userdata Unused.
+ */
+static void network_mdns_txt_cb(struct mdns_service* p_service, void* p_userdata) {
+    (void)p_userdata;
+
+    target_s* p_target = gdb_session_get_target();
+
+    network_mdns_add_txt(p_service, "sn", g_network_mdns.serial_number);
+    network_mdns_add_txt(p_service, "fw", VERSION "-" COMMIT_HASH);
+    network_mdns_add_txt(p_service, "target", (p_target != NULL) ? target_driver_name(p_target) : "none");
+}
+
+/**
+ * @brief Add a service to the responder.
+ *
+ * @param p_netif A pointer to the network interface.
+ * @param p_service A pointer to the service type.
+ * @param protocol The service protocol.
+ * @param port_key The configuration key of the service port.
+ */
+static void network_mdns_add_service(struct netif* p_netif, const char* p_service, enum mdns_sd_proto protocol,
+                                     enum config_key port_key) {
+    (void)mdns_resp_add_service(p_netif, g_network_mdns.instance_name, p_service, protocol,
+                                (u16_t)config_get_u32(port_key), NETWORK_MDNS_TTL_S, network_mdns_txt_cb, NULL);
+}
+
+/**
+ * @brief Start the responder on the first link up, or announce again on later ones. Called in the lwIP thread.
+ *
+ * @param p_netif A pointer to the network interface.
+ */
+void network_mdns_link_up(struct netif* p_netif) {
+    if (g_network_mdns.b_started) {
+        mdns_resp_netif_settings_changed(p_netif);
+        return;
+    }
+
+    const uint32_t* p_uid = (const uint32_t*)UID_BASE;
+
+    SNPRINTF(g_network_mdns.serial_number, ARRAY_LENGTH(g_network_mdns.serial_number), "%08lX%08lX%08lX",
+             (unsigned long)p_uid[0u], (unsigned long)p_uid[1u], (unsigned long)p_uid[2u]);
+    SNPRINTF(g_network_mdns.instance_name, ARRAY_LENGTH(g_network_mdns.instance_name), "%s (%s)",
+             config_get_string(CONFIG_KEY_HOSTNAME), g_network_mdns.serial_number);
+
+    // The responder joins the mDNS multicast group.
+    if ((p_netif->flags & NETIF_FLAG_IGMP) == 0u) {
+        netif_set_flags(p_netif, NETIF_FLAG_IGMP);
+        igmp_start(p_netif);
+    }
+
+    mdns_resp_init();
+    g_network_mdns.b_started = true;
+
+    if (mdns_resp_add_netif(p_netif, config_get_string(CONFIG_KEY_HOSTNAME), NETWORK_MDNS_TTL_S) != ERR_OK) {
+        return;
+    }
+
+    network_mdns_add_service(p_netif, NETWORK_MDNS_SERVICE_GDB, DNSSD_PROTO_TCP, CONFIG_KEY_GDB_PORT);
+#if TRACE_ENABLE == TRUE
+    network_mdns_add_service(p_netif, NETWORK_MDNS_SERVICE_TRACE, DNSSD_PROTO_TCP, CONFIG_KEY_TRACE_PORT);
+#endif
+#if PERF_ENABLE == TRUE
+    network_mdns_add_service(p_netif, NETWORK_MDNS_SERVICE_TELEMETRY, DNSSD_PROTO_UDP, CONFIG_KEY_TELEMETRY_PORT);
+#endif
+#if POWER_PROFILE_ENABLE == TRUE
+    network_mdns_add_service(p_netif, NETWORK_MDNS_SERVICE_POWER, DNSSD_PROTO_TCP, CONFIG_KEY_POWER_PORT);
+#endif
+#if RECORDER_ENABLE == TRUE
+    network_mdns_add_service(p_netif, NETWORK_MDNS_SERVICE_RECORDER, DNSSD_PROTO_TCP, CONFIG_KEY_RECORDER_PORT);
+#endif
+}
+
+/**
+ * @brief Announce a new address. Called in the lwIP thread.
+ *
+ * @param p_netif A pointer to the network interface.
+ */
+void network_mdns_address_changed(struct netif* p_netif) {
+    if (g_network_mdns.b_started) {
+        mdns_resp_netif_settings_changed(p_netif);
+    }
+}
+
+#endif  // LWIP_MDNS_RESPONDER
+
+/**
+ * @}
+ */
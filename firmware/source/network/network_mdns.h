@@ -0,0 +1,39 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The network mDNS responder module headers.
+ *
+ * @addtogroup network
+ * @{
+ */
+
+#ifndef SOURCE_NETWORK_NETWORK_MDNS_H_
+#define SOURCE_NETWORK_NETWORK_MDNS_H_
+
+#include "lwip/netif.h"
+
+/**
+ * @brief The time to live of the announced records in seconds.
+ */
+#define NETWORK_MDNS_TTL_S 120u
+
+/**
+ * @brief The DNS-SD service types, without the protocol.
+ */
+#define NETWORK_MDNS_SERVICE_GDB       "_gdbremote"
+#define NETWORK_MDNS_SERVICE_TRACE     "_bmp-trace"
+#define NETWORK_MDNS_SERVICE_TELEMETRY "_bmp-telemetry"
+#define NETWORK_MDNS_SERVICE_POWER     "_bmp-power"
+#define NETWORK_MDNS_SERVICE_RECORDER  "_bmp-recorder"
+
+#if LWIP_MDNS_RESPONDER
+void network_mdns_link_up(struct netif* p_netif);
+void network_mdns_address_changed(struct netif* p_netif);
+#endif
+
+#endif  // SOURCE_NETWORK_NETWORK_MDNS_H_
+
+/**
+ * @}
+ */
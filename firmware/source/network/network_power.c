@@ -0,0 +1,115 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The network power profile drain module.
+ * @details Streams the target power profile to a client on the power port (\a NETWORK_POWER_TCP_PORT by default, see
+ * tools/power_profile.py). Sampling runs while a client is connected. The stream starts with a header, followed by
+ * blocks of records. Blocks that the drain could not keep up with are skipped, which shows in their sequence numbers.
+ *
+ * @addtogroup network
+ * @{
+ */
+
+#include "network_power.h"
+
+#include "common/common.h"
+#include "common/memory.h"
+#include "config/config.h"
+#include "lwip/api.h"
+#include "network_tcp.h"
+
+#if POWER_PROFILE_ENABLE == TRUE
+
+#define NETWORK_POWER_STACK_SIZE       1024u
+#define NETWORK_POWER_POLL_INTERVAL_MS 5u
+
+/**
+ * @brief The block that is written to the client. Static, in order to keep the stack usage low.
+ */
+static struct power_profile_block g_network_power_block;
+
+/**
+ * @brief Stream the power profile to a client, until the connection fails.
+ *
+ * @param p_conn A pointer to the client connection.
+ * @param p_tail A pointer to the number of blocks that were taken, as set by \a power_profile_start().
+ */
+static void network_power_serve(struct netconn* p_conn, uint32_t* p_tail) {
+    const struct network_power_header HEADER = {
+        .magic             = NETWORK_POWER_MAGIC,
+        .version           = NETWORK_POWER_VERSION,
+        .block_size        = sizeof(struct power_profile_block),
+        .counter_frequency = STM32_SYSCLK,
+        .sample_rate       = POWER_PROFILE_SAMPLE_RATE_HZ,
+        .decimation        = POWER_PROFILE_DECIMATION,
+        .record_count      = POWER_PROFILE_BLOCK_RECORD_COUNT,
+    };
+
+    if (netconn_write(p_conn, &HEADER, sizeof(HEADER), NETCONN_COPY) != ERR_OK) {
+        return;
+    }
+
+    while (true) {
+        if (!power_profile_read(p_tail, &g_network_power_block)) {
+            chThdSleepMilliseconds(NETWORK_POWER_POLL_INTERVAL_MS);
+            continue;
+        }
+
+        if (netconn_write(p_conn, &g_network_power_block, sizeof(g_network_power_block), NETCONN_COPY) != ERR_OK) {
+            return;
+        }
+    }
+}
+
+MEMORY_CCM_NOINIT THD_WORKING_AREA(wa_network_power, NETWORK_POWER_STACK_SIZE);
+
+/**
+ * @brief The power profile drain thread.
+ *
+ * @param p_arg A pointer to arguments to the power profile drain, unused.
+ */
+THD_FUNCTION(network_power, p_arg) {
+    (void)p_arg;
+    struct netconn* p_listen_conn = NULL;
+    err_t           err;
+
+    chRegSetThreadName("network_power");
+
+    p_listen_conn = netconn_new(NETCONN_TCP);
+    LWIP_ERROR("power: invalid conn", (p_listen_conn != NULL), chThdExit(MSG_RESET););
+
+    err = netconn_bind(p_listen_conn, IP4_ADDR_ANY, (u16_t)config_get_u32(CONFIG_KEY_POWER_PORT));
+    LWIP_ERROR("power: could not bind", (err == ERR_OK), chThdExit(MSG_RESET););
+
+    netconn_listen(p_listen_conn);
+
+    while (true) {
+        struct netconn* p_conn = NULL;
+        uint32_t        tail   = 0u;
+
+        if (netconn_accept(p_listen_conn, &p_conn) != ERR_OK) {
+            continue;
+        }
+
+        network_tcp_apply_policy(p_conn, &G_NETWORK_TCP_POLICY_BULK);
+        power_profile_start(&tail);
+        network_power_serve(p_conn, &tail);
+        power_profile_stop();
+        netconn_close(p_conn);
+        netconn_delete(p_conn);
+    }
+}
+
+/**
+ * @brief Start the power profile drain thread. Must be called after the initialization of lwIP.
+ */
+void network_power_init(void) {
+    chThdCreateStatic(wa_network_power, sizeof(wa_network_power), LOWPRIO + 1, network_power, NULL);
+}
+
+#endif  // POWER_PROFILE_ENABLE == TRUE
+
+/**
+ * @}
+ */
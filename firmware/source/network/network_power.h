@@ -0,0 +1,53 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The network power profile drain module headers.
+ *
+ * @addtogroup network
+ * @{
+ */
+
+#ifndef SOURCE_NETWORK_NETWORK_POWER_H_
+#define SOURCE_NETWORK_NETWORK_POWER_H_
+
+#include <stdint.h>
+
+#include "target_power/power_profile.h"
+
+/**
+ * @brief The TCP port, on which the power profile is streamed.
+ */
+#define NETWORK_POWER_TCP_PORT 2005
+
+/**
+ * @brief The magic value at the start of a power profile stream.
+ */
+#define NETWORK_POWER_MAGIC 0x50525750u  // "PWRP"
+
+/**
+ * @brief The version of the power profile stream format. Increment on changes.
+ */
+#define NETWORK_POWER_VERSION 1u
+
+/**
+ * @brief The header at the start of a power profile stream, which is followed by blocks (see
+ * \a struct power_profile_block). All fields are little endian.
+ */
+struct __attribute__((packed)) network_power_header {
+    uint32_t magic;              ///< Must be \a NETWORK_POWER_MAGIC.
+    uint16_t version;            ///< The stream format version, \a NETWORK_POWER_VERSION.
+    uint16_t block_size;         ///< The size of a block.
+    uint32_t counter_frequency;  ///< The frequency of the time stamp counter in Hz.
+    uint32_t sample_rate;        ///< The sample rate in Hz.
+    uint16_t decimation;         ///< The number of samples per record.
+    uint16_t record_count;       ///< The number of records per block.
+};
+
+void network_power_init(void);
+
+#endif  // SOURCE_NETWORK_NETWORK_POWER_H_
+
+/**
+ * @}
+ */
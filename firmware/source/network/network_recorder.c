@@ -0,0 +1,215 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The network recorder server module.
+ * @details Serves the sessions that the SD card recorder took on the recorder port (\a NETWORK_RECORDER_TCP_PORT by
+ * default, see tools/recorder_fetch.py), while recording goes on. A client sends commands as lines of text:
+ *
+ * - "list" answers with a line "<session> <first chunk> <chunk count>" per session, and an empty line.
+ * - "read <session>" answers with the chunk count (uint32_t, little endian), followed by the raw chunks of the session.
+ *   The count is zero for an unknown session.
+ *
+ * @addtogroup network
+ * @{
+ */
+
+#include "network_recorder.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/common.h"
+#include "common/memory.h"
+#include "config/config.h"
+#include "lwip/api.h"
+#include "network_tcp.h"
+
+#if RECORDER_ENABLE == TRUE
+
+#define NETWORK_RECORDER_STACK_SIZE   1024u
+#define NETWORK_RECORDER_LINE_LENGTH  32u
+#define NETWORK_RECORDER_READ_SECTORS 4u
+
+/**
+ * @brief The buffer for reading chunks from the card. It has to stay outside of the core coupled memory, for the DMA.
+ */
+static uint8_t g_network_recorder_buffer[NETWORK_RECORDER_READ_SECTORS * RECORDER_SECTOR_SIZE]
+    __attribute__((aligned(4)));
+
+/**
+ * @brief The state of the recorder server.
+ */
+static struct {
+    char   line[NETWORK_RECORDER_LINE_LENGTH];  ///< The command line that is being received.
+    size_t line_length;                         ///< The length of the command line.
+} g_network_recorder;
+
+/**
+ * @brief Answer the "list" command.
+ *
+ * @param p_conn A pointer to the client connection.
+ * @return err_t An error code.
+ */
+static err_t network_recorder_list(struct netconn* p_conn) {
+    struct recorder_session session;
+    uint32_t                index = 1u;
+
+    while (recorder_find_session(index, &session)) {
+        char         line[NETWORK_RECORDER_LINE_LENGTH];
+        const size_t LENGTH = (size_t)SNPRINTF(line, ARRAY_LENGTH(line), "%lu %lu %lu\n",
+                                               (unsigned long)session.session, (unsigned long)session.first_index,
+                                               (unsigned long)session.chunk_count);
+
+        RETURN_IF_NOT(netconn_write(p_conn, line, LENGTH, NETCONN_COPY), ERR_OK);
+        index = session.first_index + session.chunk_count;
+    }
+
+    return netconn_write(p_conn, "\n", 1u, NETCONN_COPY);
+}
+
+/**
+ * @brief Answer the "read" command.
+ *
+ * @param p_conn A pointer to the client connection.
+ * @param session_number The session to read.
+ * @return err_t An error code.
+ */
+static err_t network_recorder_read(struct netconn* p_conn, uint32_t session_number) {
+    struct recorder_session session = {.session = 0u, .first_index = 0u, .chunk_count = 0u};
+    uint32_t                index   = 1u;
+
+    while (recorder_find_session(index, &session) && (session.session != session_number)) {
+        index = session.first_index + session.chunk_count;
+    }
+
+    const uint32_t CHUNK_COUNT = (session.session == session_number) ? session.chunk_count : 0u;
+
+    RETURN_IF_NOT(netconn_write(p_conn, &CHUNK_COUNT, sizeof(CHUNK_COUNT), NETCONN_COPY), ERR_OK);
+
+    for (uint32_t chunk_index = 0u; chunk_index < CHUNK_COUNT; chunk_index++) {
+        for (uint32_t sector_offset = 0u; sector_offset < RECORDER_CHUNK_SECTORS;
+             sector_offset += NETWORK_RECORDER_READ_SECTORS) {
+            // A chunk that cannot be read is sent as zeros, which the client finds invalid.
+            if (!recorder_read(session.first_index + chunk_index, sector_offset, g_network_recorder_buffer,
+                               NETWORK_RECORDER_READ_SECTORS)) {
+                memset(g_network_recorder_buffer, 0, sizeof(g_network_recorder_buffer));
+            }
+
+            RETURN_IF_NOT(netconn_write(p_conn, g_network_recorder_buffer, sizeof(g_network_recorder_buffer),
+                                        NETCONN_COPY),
+                          ERR_OK);
+        }
+    }
+
+    return ERR_OK;
+}
+
+/**
+ * @brief Execute a command line.
+ *
+ * @param p_conn A pointer to the client connection.
+ * @param p_line A pointer to the command line, without its line end.
+ * @return err_t An error code.
+ */
+static err_t network_recorder_execute(struct netconn* p_conn, const char* p_line) {
+    if (0 == strcmp(p_line, "list")) {
+        return network_recorder_list(p_conn);
+    }
+
+    if (0 == strncmp(p_line, "read ", 5u)) {
+        return network_recorder_read(p_conn, (uint32_t)strtoul(&p_line[5u], NULL, 10));
+    }
+
+    return netconn_write(p_conn, "?\n", 2u, NETCONN_COPY);
+}
+
+/**
+ * @brief Serve a client, until the connection closes.
+ *
+ * @param p_conn A pointer to the client connection.
+ */
+static void network_recorder_serve(struct netconn* p_conn) {
+    struct netbuf* p_netbuf = NULL;
+
+    g_network_recorder.line_length = 0u;
+
+    while (netconn_recv(p_conn, &p_netbuf) == ERR_OK) {
+        err_t err = ERR_OK;
+
+        do {
+            char*    p_data    = NULL;
+            uint16_t data_size = 0u;
+
+            netbuf_data(p_netbuf, (void**)&p_data, &data_size);
+
+            for (uint16_t data_index = 0u; (data_index < data_size) && (err == ERR_OK); data_index++) {
+                const char CHARACTER = p_data[data_index];
+
+                if (CHARACTER == '\n') {
+                    g_network_recorder.line[g_network_recorder.line_length] = '\0';
+                    g_network_recorder.line_length                          = 0u;
+                    err = network_recorder_execute(p_conn, g_network_recorder.line);
+                } else if ((CHARACTER != '\r') &&
+                           (g_network_recorder.line_length < (ARRAY_LENGTH(g_network_recorder.line) - 1u))) {
+                    g_network_recorder.line[g_network_recorder.line_length++] = CHARACTER;
+                }
+            }
+        } while ((err == ERR_OK) && (netbuf_next(p_netbuf) >= 0));
+
+        netbuf_delete(p_netbuf);
+
+        if (err != ERR_OK) {
+            return;
+        }
+    }
+}
+
+MEMORY_CCM_NOINIT THD_WORKING_AREA(wa_network_recorder, NETWORK_RECORDER_STACK_SIZE);
+
+/**
+ * @brief The recorder server thread.
+ *
+ * @param p_arg A pointer to arguments to the recorder server, unused.
+ */
+THD_FUNCTION(network_recorder, p_arg) {
+    (void)p_arg;
+    struct netconn* p_listen_conn = NULL;
+    err_t           err;
+
+    chRegSetThreadName("network_recorder");
+
+    p_listen_conn = netconn_new(NETCONN_TCP);
+    LWIP_ERROR("recorder: invalid conn", (p_listen_conn != NULL), chThdExit(MSG_RESET););
+
+    err = netconn_bind(p_listen_conn, IP4_ADDR_ANY, (u16_t)config_get_u32(CONFIG_KEY_RECORDER_PORT));
+    LWIP_ERROR("recorder: could not bind", (err == ERR_OK), chThdExit(MSG_RESET););
+
+    netconn_listen(p_listen_conn);
+
+    while (true) {
+        struct netconn* p_conn = NULL;
+
+        if (netconn_accept(p_listen_conn, &p_conn) != ERR_OK) {
+            continue;
+        }
+
+        network_tcp_apply_policy(p_conn, &G_NETWORK_TCP_POLICY_BULK);
+        network_recorder_serve(p_conn);
+        netconn_close(p_conn);
+        netconn_delete(p_conn);
+    }
+}
+
+/**
+ * @brief Start the recorder server thread. Must be called after the initialization of lwIP.
+ */
+void network_recorder_init(void) {
+    chThdCreateStatic(wa_network_recorder, sizeof(wa_network_recorder), LOWPRIO + 1, network_recorder, NULL);
+}
+
+#endif  // RECORDER_ENABLE == TRUE
+
+/**
+ * @}
+ */
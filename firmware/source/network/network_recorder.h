@@ -0,0 +1,27 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The network recorder server module headers.
+ *
+ * @addtogroup network
+ * @{
+ */
+
+#ifndef SOURCE_NETWORK_NETWORK_RECORDER_H_
+#define SOURCE_NETWORK_NETWORK_RECORDER_H_
+
+#include "recorder/recorder.h"
+
+/**
+ * @brief The TCP port, on which the recording is served.
+ */
+#define NETWORK_RECORDER_TCP_PORT 2006
+
+void network_recorder_init(void);
+
+#endif  // SOURCE_NETWORK_NETWORK_RECORDER_H_
+
+/**
+ * @}
+ */
@@ -0,0 +1,271 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The network startup module.
+ * @details Brings up the IPv4 address of the probe, as soon as the Ethernet link is up. Depending on the address mode,
+ * the static address is used right away, or DHCP is started. If no lease is bound within the DHCP timeout, DHCP is
+ * stopped, and the static address, or a link-local address is used instead. A DHCP server that appears later is only
+ * picked up after the next link up. The mode, addresses, timeout and host name are read from the configuration store.
+ *
+ * The link callbacks replace the default ones of the ChibiOS lwIP bindings, and run in the lwIP thread. Along the way,
+ * the startup milestones are recorded, for reporting the time from system start to accepting connections.
+ *
+ * @addtogroup network
+ * @{
+ */
+
+#include "network_startup.h"
+
+#include "common/common.h"
+#include "config/config.h"
+#include "lwip/autoip.h"
+#include "lwip/dhcp.h"
+#include "lwip/netif.h"
+#include "lwip/timeouts.h"
+#include "network_mdns.h"
+
+/**
+ * @brief The MAC address of the probe.
+ */
+static uint8_t g_network_startup_mac_address[ETHARP_HWADDR_LEN] = {
+    LWIP_ETHADDR_0, LWIP_ETHADDR_1, LWIP_ETHADDR_2, LWIP_ETHADDR_3, LWIP_ETHADDR_4, LWIP_ETHADDR_5,
+};
+
+/**
+ * @brief The startup milestones. Written by the lwIP and TCP server threads, so accessed under a critical section.
+ */
+static struct network_startup_times g_network_startup_times = {
+    .link_up_ms   = NETWORK_STARTUP_PENDING,
+    .address_ms   = NETWORK_STARTUP_PENDING,
+    .listening_ms = NETWORK_STARTUP_PENDING,
+    .source       = NETWORK_ADDRESS_SOURCE_NONE,
+};
+
+/**
+ * @brief The names of the address sources.
+ */
+static const char* const G_NETWORK_STARTUP_SOURCE_NAMES[] = {
+    [NETWORK_ADDRESS_SOURCE_NONE]       = "none",
+    [NETWORK_ADDRESS_SOURCE_STATIC]     = "static",
+    [NETWORK_ADDRESS_SOURCE_DHCP]       = "dhcp",
+    [NETWORK_ADDRESS_SOURCE_LINK_LOCAL] = "link-local",
+};
+
+/**
+ * @brief Get the configured address mode.
+ *
+ * @return enum network_address_mode The address mode.
+ */
+static inline enum network_address_mode network_startup_get_mode(void) {
+    return (enum network_address_mode)config_get_u32(CONFIG_KEY_ADDRESS_MODE);
+}
+
+/**
+ * @brief Record a startup milestone, if it was not reached before.
+ *
+ * @param p_time_ms A pointer to the milestone time.
+ */
+static void network_startup_record(uint32_t* p_time_ms) {
+    chSysLock();
+    if (*p_time_ms == NETWORK_STARTUP_PENDING) {
+        *p_time_ms = (uint32_t)TIME_I2MS(chVTGetSystemTimeX());
+    }
+    chSysUnlock();
+}
+
+/**
+ * @brief Called by lwIP, whenever the interface goes up or down, or its address changes.
+ *
+ * @param p_netif A pointer to the network interface.
+ */
+static void network_startup_status_cb(struct netif* p_netif) {
+    enum network_address_source source = NETWORK_ADDRESS_SOURCE_NONE;
+
+    if (netif_is_up(p_netif) && netif_is_link_up(p_netif) && !ip4_addr_isany(netif_ip4_addr(p_netif))) {
+        if (dhcp_supplied_address(p_netif)) {
+            source = NETWORK_ADDRESS_SOURCE_DHCP;
+        } else if (autoip_supplied_address(p_netif)) {
+            source = NETWORK_ADDRESS_SOURCE_LINK_LOCAL;
+        } else {
+            source = NETWORK_ADDRESS_SOURCE_STATIC;
+        }
+
+        network_startup_record(&g_network_startup_times.address_ms);
+#if LWIP_MDNS_RESPONDER
+        network_mdns_address_changed(p_netif);
+#endif
+    }
+
+    chSysLock();
+    g_network_startup_times.source = source;
+    chSysUnlock();
+}
+
+/**
+ * @brief Fall back from DHCP, if no lease was bound in time.
+ *
+ * @param p_arg A pointer to the network interface.
+ */
+static void network_startup_dhcp_timeout_cb(void* p_arg) {
+    struct netif* p_netif = (struct netif*)p_arg;
+
+    if (dhcp_supplied_address(p_netif)) {
+        return;
+    }
+
+    dhcp_release_and_stop(p_netif);
+
+    if (network_startup_get_mode() == NETWORK_ADDRESS_MODE_DHCP_LINK_LOCAL) {
+        autoip_start(p_netif);
+    } else {
+        ip4_addr_t address;
+        ip4_addr_t netmask;
+        ip4_addr_t gateway;
+
+        ip4_addr_set_u32(&address, lwip_htonl(config_get_u32(CONFIG_KEY_STATIC_ADDRESS)));
+        ip4_addr_set_u32(&netmask, lwip_htonl(config_get_u32(CONFIG_KEY_STATIC_NETMASK)));
+        ip4_addr_set_u32(&gateway, lwip_htonl(config_get_u32(CONFIG_KEY_STATIC_GATEWAY)));
+        netif_set_addr(p_netif, &address, &netmask, &gateway);
+    }
+}
+
+/**
+ * @brief Adjust the MAC, after the MAC driver configured it. The lwIP thread starts the driver before it polls the
+ * link, and the driver rewrites the frame filter and operation mode registers on start, so this runs on every link up.
+ */
+static void network_startup_configure_mac(void) {
+#if LWIP_IGMP
+    // The MAC driver drops multicast frames, unless they match its perfect filter. Accept them for mDNS.
+    ETH->MACFFR |= ETH_MACFFR_PAM;
+    ASSERT_VERBOSE((ETH->MACFFR & ETH_MACFFR_PAM) != 0u, "Multicast frames are not accepted.");
+#endif
+
+#if STM32_MAC_IP_CHECKSUM_OFFLOAD != 0
+    // lwIP does not check checksums with offload enabled. Make the MAC drop frames that fail its checksum checks,
+    // instead of only flagging them in the receive descriptor, which the MAC driver ignores.
+    ETH->DMAOMR &= ~ETH_DMAOMR_DTCEFD;
+    ASSERT_VERBOSE((ETH->DMAOMR & ETH_DMAOMR_DTCEFD) == 0u, "Checksum errors are not dropped.");
+#endif
+}
+
+/**
+ * @brief Called in the lwIP thread, when the link goes up.
+ *
+ * @param p_arg A pointer to the network interface.
+ */
+static void network_startup_link_up_cb(void* p_arg) {
+    struct netif* p_netif = (struct netif*)p_arg;
+
+    network_startup_configure_mac();
+    network_startup_record(&g_network_startup_times.link_up_ms);
+    netif_set_status_callback(p_netif, network_startup_status_cb);
+#if LWIP_MDNS_RESPONDER
+    network_mdns_link_up(p_netif);
+#endif
+
+    if (network_startup_get_mode() == NETWORK_ADDRESS_MODE_STATIC) {
+        // The address was assigned on initialization, and is usable right away.
+        network_startup_status_cb(p_netif);
+        return;
+    }
+
+    dhcp_start(p_netif);
+
+    if (network_startup_get_mode() != NETWORK_ADDRESS_MODE_DHCP) {
+        sys_timeout(config_get_u32(CONFIG_KEY_DHCP_TIMEOUT_MS), network_startup_dhcp_timeout_cb, p_netif);
+    }
+}
+
+/**
+ * @brief Called in the lwIP thread, when the link goes down.
+ *
+ * @param p_arg A pointer to the network interface.
+ */
+static void network_startup_link_down_cb(void* p_arg) {
+    struct netif* p_netif = (struct netif*)p_arg;
+
+    if (network_startup_get_mode() != NETWORK_ADDRESS_MODE_STATIC) {
+        sys_untimeout(network_startup_dhcp_timeout_cb, p_netif);
+        dhcp_release_and_stop(p_netif);
+        autoip_stop(p_netif);
+    }
+
+    network_startup_status_cb(p_netif);
+}
+
+/**
+ * @brief Fill the lwIP thread options for the configured address mode. The configuration store must be loaded.
+ *
+ * @param p_opts A pointer to the options to fill.
+ */
+void network_startup_configure(lwipthread_opts_t* p_opts) {
+    ASSERT_PTR_NOT_NULL(p_opts);
+
+    p_opts->macaddress = g_network_startup_mac_address;
+    p_opts->address    = 0u;
+    p_opts->netmask    = 0u;
+    p_opts->gateway    = 0u;
+    p_opts->addrMode   = NET_ADDRESS_DHCP;
+#if LWIP_NETIF_HOSTNAME
+    p_opts->ourHostName = config_get_string(CONFIG_KEY_HOSTNAME);
+#endif
+    p_opts->link_up_cb   = network_startup_link_up_cb;
+    p_opts->link_down_cb = network_startup_link_down_cb;
+
+    if (network_startup_get_mode() == NETWORK_ADDRESS_MODE_STATIC) {
+        p_opts->address  = lwip_htonl(config_get_u32(CONFIG_KEY_STATIC_ADDRESS));
+        p_opts->netmask  = lwip_htonl(config_get_u32(CONFIG_KEY_STATIC_NETMASK));
+        p_opts->gateway  = lwip_htonl(config_get_u32(CONFIG_KEY_STATIC_GATEWAY));
+        p_opts->addrMode = NET_ADDRESS_STATIC;
+    }
+}
+
+/**
+ * @brief Record that the GDB port is listening.
+ */
+void network_startup_mark_listening(void) { network_startup_record(&g_network_startup_times.listening_ms); }
+
+/**
+ * @brief Get a consistent copy of the startup milestones. Can be called from any thread.
+ *
+ * @param p_times A pointer to the milestones to fill.
+ */
+void network_startup_get_times(struct network_startup_times* p_times) {
+    ASSERT_PTR_NOT_NULL(p_times);
+
+    chSysLock();
+    *p_times = g_network_startup_times;
+    chSysUnlock();
+}
+
+/**
+ * @brief Get the time, from which on the GDB port accepted connections: it is listening, and an address is usable.
+ *
+ * @param p_times A pointer to the milestones.
+ * @return uint32_t The time in milliseconds since the system start, or \a NETWORK_STARTUP_PENDING.
+ */
+uint32_t network_startup_get_accepting_ms(const struct network_startup_times* p_times) {
+    ASSERT_PTR_NOT_NULL(p_times);
+
+    if ((p_times->address_ms == NETWORK_STARTUP_PENDING) || (p_times->listening_ms == NETWORK_STARTUP_PENDING)) {
+        return NETWORK_STARTUP_PENDING;
+    }
+
+    return (p_times->address_ms > p_times->listening_ms) ? p_times->address_ms : p_times->listening_ms;
+}
+
+/**
+ * @brief Get the name of an address source.
+ *
+ * @param source The address source.
+ * @return const char* A pointer to the name.
+ */
+const char* network_startup_get_source_name(enum network_address_source source) {
+    ASSERT_VERBOSE(source <= NETWORK_ADDRESS_SOURCE_LINK_LOCAL, "Invalid address source.");
+    return G_NETWORK_STARTUP_SOURCE_NAMES[source];
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,94 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The network startup module headers.
+ *
+ * @addtogroup network
+ * @{
+ */
+
+#ifndef SOURCE_NETWORK_NETWORK_STARTUP_H_
+#define SOURCE_NETWORK_NETWORK_STARTUP_H_
+
+#include <stdint.h>
+
+#include "lwip/def.h"
+#include "lwipthread.h"
+
+/**
+ * @brief The ways, in which the probe gets its IPv4 address.
+ */
+enum network_address_mode {
+    NETWORK_ADDRESS_MODE_STATIC,           ///< Use the static address, as soon as the link is up.
+    NETWORK_ADDRESS_MODE_DHCP,             ///< Wait for a DHCP lease, without a fallback.
+    NETWORK_ADDRESS_MODE_DHCP_STATIC,      ///< Try DHCP, and fall back to the static address after the timeout.
+    NETWORK_ADDRESS_MODE_DHCP_LINK_LOCAL,  ///< Try DHCP, and fall back to a link-local address (169.254/16).
+};
+
+/**
+ * @brief The source of the current IPv4 address.
+ */
+enum network_address_source {
+    NETWORK_ADDRESS_SOURCE_NONE,        ///< No address yet.
+    NETWORK_ADDRESS_SOURCE_STATIC,      ///< The static address.
+    NETWORK_ADDRESS_SOURCE_DHCP,        ///< A DHCP lease.
+    NETWORK_ADDRESS_SOURCE_LINK_LOCAL,  ///< A link-local address (AutoIP).
+};
+
+/**
+ * @brief The default address mode. Selected with USE_NETWORK_ADDRESS in the Makefile, and changed at runtime in the
+ * configuration store.
+ */
+#ifndef NETWORK_ADDRESS_MODE
+#define NETWORK_ADDRESS_MODE NETWORK_ADDRESS_MODE_DHCP_LINK_LOCAL
+#endif
+
+/**
+ * @brief The default time after link up, within which a DHCP lease must be bound, before falling back.
+ */
+#ifndef NETWORK_DHCP_TIMEOUT_MS
+#define NETWORK_DHCP_TIMEOUT_MS 3000u
+#endif
+
+/**
+ * @brief The default static address, netmask and gateway, in host byte order.
+ */
+#ifndef NETWORK_STATIC_ADDRESS
+#define NETWORK_STATIC_ADDRESS LWIP_MAKEU32(192, 168, 1, 10)
+#endif
+
+#ifndef NETWORK_STATIC_NETMASK
+#define NETWORK_STATIC_NETMASK LWIP_MAKEU32(255, 255, 255, 0)
+#endif
+
+#ifndef NETWORK_STATIC_GATEWAY
+#define NETWORK_STATIC_GATEWAY LWIP_MAKEU32(192, 168, 1, 1)
+#endif
+
+/**
+ * @brief Marks a startup milestone that was not reached yet.
+ */
+#define NETWORK_STARTUP_PENDING UINT32_MAX
+
+/**
+ * @brief The startup milestones, in milliseconds since the system start.
+ */
+struct network_startup_times {
+    uint32_t                    link_up_ms;    ///< The first link up.
+    uint32_t                    address_ms;    ///< The first usable address, with the link up.
+    uint32_t                    listening_ms;  ///< The GDB port started listening.
+    enum network_address_source source;        ///< The source of the current address.
+};
+
+void        network_startup_configure(lwipthread_opts_t* p_opts);
+void        network_startup_mark_listening(void);
+void        network_startup_get_times(struct network_startup_times* p_times);
+uint32_t    network_startup_get_accepting_ms(const struct network_startup_times* p_times);
+const char* network_startup_get_source_name(enum network_address_source source);
+
+#endif  // SOURCE_NETWORK_NETWORK_STARTUP_H_
+
+/**
+ * @}
+ */
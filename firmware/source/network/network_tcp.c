@@ -0,0 +1,102 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The network TCP policy module.
+ * @details Interactive sessions, such as GDB stepping, exchange many tiny packets - there, Nagle's algorithm and
+ * delayed ACKs add up to hundreds of milliseconds per round trip. Bulk streams (e.g. the trace) rather benefit from
+ * fewer, full segments. Every listening port therefore selects a policy for its connections.
+ *
+ * Options that change the TCP control block are applied in the context of the tcpip thread, which owns it.
+ *
+ * @addtogroup network
+ * @{
+ */
+
+#include "network_tcp.h"
+
+#include "common/common.h"
+#include "lwip/tcp.h"
+#include "lwip/tcpip.h"
+
+/**
+ * @brief The policy for interactive sessions: every reply is sent, and every request is acknowledged immediately.
+ */
+const struct network_tcp_policy G_NETWORK_TCP_POLICY_INTERACTIVE = {
+    .b_no_delay  = true,
+    .b_quick_ack = true,
+};
+
+/**
+ * @brief The policy for bulk streams: the lwIP defaults, which favor full segments.
+ */
+const struct network_tcp_policy G_NETWORK_TCP_POLICY_BULK = {
+    .b_no_delay  = false,
+    .b_quick_ack = false,
+};
+
+/**
+ * @brief Disable Nagle's algorithm on a connection. Runs in the tcpip thread.
+ *
+ * @param p_arg A pointer to the connection.
+ */
+static void network_tcp_no_delay_cb(void* p_arg) {
+    struct netconn* p_conn = (struct netconn*)p_arg;
+
+    if (p_conn->pcb.tcp != NULL) {
+        tcp_nagle_disable(p_conn->pcb.tcp);
+    }
+}
+
+/**
+ * @brief Send an ACK for all received data right away. Runs in the tcpip thread.
+ *
+ * @param p_arg A pointer to the connection.
+ */
+static void network_tcp_quick_ack_cb(void* p_arg) {
+    struct netconn* p_conn = (struct netconn*)p_arg;
+
+    if (p_conn->pcb.tcp != NULL) {
+        tcp_set_flags(p_conn->pcb.tcp, TF_ACK_NOW);
+        tcp_output(p_conn->pcb.tcp);
+    }
+}
+
+/**
+ * @brief Apply a policy to a newly accepted connection.
+ * @details The callback is queued before any later operation on the connection, including its deletion, so the
+ * connection is still valid when it runs.
+ *
+ * @param p_conn A pointer to the connection.
+ * @param p_policy A pointer to the policy.
+ */
+void network_tcp_apply_policy(struct netconn* p_conn, const struct network_tcp_policy* p_policy) {
+    ASSERT_PTR_NOT_NULL(p_conn);
+    ASSERT_PTR_NOT_NULL(p_policy);
+
+    if (p_policy->b_no_delay) {
+        tcpip_callback(network_tcp_no_delay_cb, p_conn);
+    }
+}
+
+/**
+ * @brief Notify the policy of received data, e.g. for acknowledging it immediately.
+ * @details Without a quick ACK, the client's stack may hold back its next small packet until the delayed ACK
+ * arrives, if the probe does not send a reply right away (e.g. to a GDB acknowledgement).
+ *
+ * @param p_conn A pointer to the connection.
+ * @param p_policy A pointer to the policy.
+ */
+void network_tcp_received(struct netconn* p_conn, const struct network_tcp_policy* p_policy) {
+    ASSERT_PTR_NOT_NULL(p_conn);
+    ASSERT_PTR_NOT_NULL(p_policy);
+
+    if (p_policy->b_quick_ack) {
+        // Dropping the ACK, if the tcpip mailbox is full, only delays it.
+        (void)tcpip_try_callback(network_tcp_quick_ack_cb, p_conn);
+    }
+}
+
+/**
+ * @}
+ */
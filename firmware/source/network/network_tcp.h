@@ -0,0 +1,36 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The network TCP policy module headers.
+ *
+ * @addtogroup network
+ * @{
+ */
+
+#ifndef SOURCE_NETWORK_NETWORK_TCP_H_
+#define SOURCE_NETWORK_NETWORK_TCP_H_
+
+#include <stdbool.h>
+
+#include "lwip/api.h"
+
+/**
+ * @brief The TCP policy of a listening port, which applies to all of its connections.
+ */
+struct network_tcp_policy {
+    bool b_no_delay;   ///< Disable Nagle's algorithm, such that small replies do not wait for outstanding ACKs.
+    bool b_quick_ack;  ///< Acknowledge received data immediately, instead of delaying the ACK.
+};
+
+extern const struct network_tcp_policy G_NETWORK_TCP_POLICY_INTERACTIVE;
+extern const struct network_tcp_policy G_NETWORK_TCP_POLICY_BULK;
+
+void network_tcp_apply_policy(struct netconn* p_conn, const struct network_tcp_policy* p_policy);
+void network_tcp_received(struct netconn* p_conn, const struct network_tcp_policy* p_policy);
+
+#endif  // SOURCE_NETWORK_NETWORK_TCP_H_
+
+/**
+ * @}
+ */
@@ -0,0 +1,112 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The network telemetry module.
+ * @details Answers every datagram on the telemetry port (\a NETWORK_TELEMETRY_UDP_PORT by default) with a snapshot
+ * of the request latency histograms (see \a struct network_telemetry_packet), for machine-readable monitoring (see
+ * tools/perf_telemetry.py). The content of the request is ignored.
+ *
+ * @addtogroup network
+ * @{
+ */
+
+#include "network_telemetry.h"
+
+#include <string.h>
+
+#include "common/common.h"
+#include "common/memory.h"
+#include "config/config.h"
+#include "lwip/api.h"
+
+#if PERF_ENABLE == TRUE
+
+#define NETWORK_TELEMETRY_STACK_SIZE 1024u
+
+/**
+ * @brief The telemetry packet that is sent in reply.
+ */
+static struct network_telemetry_packet g_network_telemetry_packet;
+
+/**
+ * @brief Fill the telemetry packet with the latest histograms.
+ */
+static void network_telemetry_fill(void) {
+    struct perf_histogram histograms[PERF_STAGE_COUNT];
+    perf_get_stage_histograms(histograms);
+
+    struct network_telemetry_header* p_header = &g_network_telemetry_packet.header;
+
+    p_header->magic             = NETWORK_TELEMETRY_MAGIC;
+    p_header->version           = NETWORK_TELEMETRY_VERSION;
+    p_header->stage_count       = PERF_STAGE_COUNT;
+    p_header->bucket_count      = PERF_BUCKET_COUNT;
+    p_header->counter_frequency = STM32_SYSCLK;
+    p_header->uptime_ms         = (uint32_t)TIME_I2MS(chVTGetSystemTimeX());
+
+    for (size_t stage_index = 0u; stage_index < PERF_STAGE_COUNT; stage_index++) {
+        struct network_telemetry_stage* p_stage = &g_network_telemetry_packet.stages[stage_index];
+
+        p_stage->count = histograms[stage_index].count;
+        p_stage->min   = histograms[stage_index].min;
+        p_stage->max   = histograms[stage_index].max;
+        memcpy(p_stage->buckets, histograms[stage_index].buckets, sizeof(p_stage->buckets));
+    }
+}
+
+MEMORY_CCM_NOINIT THD_WORKING_AREA(wa_network_telemetry, NETWORK_TELEMETRY_STACK_SIZE);
+
+/**
+ * @brief The telemetry server thread.
+ *
+ * @param p_arg A pointer to arguments to the telemetry server, unused.
+ */
+THD_FUNCTION(network_telemetry, p_arg) {
+    (void)p_arg;
+    struct netconn* p_conn = NULL;
+    err_t           err;
+
+    chRegSetThreadName("network_telemetry");
+
+    p_conn = netconn_new(NETCONN_UDP);
+    LWIP_ERROR("telemetry: invalid conn", (p_conn != NULL), chThdExit(MSG_RESET););
+
+    err = netconn_bind(p_conn, IP4_ADDR_ANY, (u16_t)config_get_u32(CONFIG_KEY_TELEMETRY_PORT));
+    LWIP_ERROR("telemetry: could not bind", (err == ERR_OK), chThdExit(MSG_RESET););
+
+    while (true) {
+        struct netbuf* p_request = NULL;
+
+        if (netconn_recv(p_conn, &p_request) != ERR_OK) {
+            continue;
+        }
+
+        struct netbuf* p_reply = netbuf_new();
+
+        if (p_reply != NULL) {
+            network_telemetry_fill();
+
+            if (netbuf_ref(p_reply, &g_network_telemetry_packet, sizeof(g_network_telemetry_packet)) == ERR_OK) {
+                netconn_sendto(p_conn, p_reply, netbuf_fromaddr(p_request), netbuf_fromport(p_request));
+            }
+
+            netbuf_delete(p_reply);
+        }
+
+        netbuf_delete(p_request);
+    }
+}
+
+/**
+ * @brief Start the telemetry server thread. Must be called after the initialization of lwIP.
+ */
+void network_telemetry_init(void) {
+    chThdCreateStatic(wa_network_telemetry, sizeof(wa_network_telemetry), LOWPRIO + 1, network_telemetry, NULL);
+}
+
+#endif  // PERF_ENABLE == TRUE
+
+/**
+ * @}
+ */
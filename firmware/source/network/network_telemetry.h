@@ -0,0 +1,69 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The network telemetry module headers.
+ *
+ * @addtogroup network
+ * @{
+ */
+
+#ifndef SOURCE_NETWORK_NETWORK_TELEMETRY_H_
+#define SOURCE_NETWORK_NETWORK_TELEMETRY_H_
+
+#include <stdint.h>
+
+#include "perf/perf.h"
+
+/**
+ * @brief The UDP port, on which telemetry requests are answered.
+ */
+#define NETWORK_TELEMETRY_UDP_PORT 2001
+
+/**
+ * @brief The magic value of a telemetry packet.
+ */
+#define NETWORK_TELEMETRY_MAGIC 0x4D4C4554u  // "TELM"
+
+/**
+ * @brief The version of the telemetry packet layout. Increment on changes.
+ */
+#define NETWORK_TELEMETRY_VERSION 1u
+
+/**
+ * @brief The header of a telemetry packet. All fields are little endian.
+ */
+struct __attribute__((packed)) network_telemetry_header {
+    uint32_t magic;              ///< Must be \a NETWORK_TELEMETRY_MAGIC.
+    uint16_t version;            ///< The layout version, \a NETWORK_TELEMETRY_VERSION.
+    uint8_t  stage_count;        ///< The number of stage records that follow (see \a enum perf_stage).
+    uint8_t  bucket_count;       ///< The number of buckets per stage record.
+    uint32_t counter_frequency;  ///< The frequency of the cycle counter in Hz.
+    uint32_t uptime_ms;          ///< The system uptime in milliseconds.
+};
+
+/**
+ * @brief The latency histogram of a stage, as part of a telemetry packet.
+ */
+struct __attribute__((packed)) network_telemetry_stage {
+    uint32_t count;                       ///< The number of measurements.
+    uint32_t min;                         ///< The shortest duration in cycles.
+    uint32_t max;                         ///< The longest duration in cycles.
+    uint32_t buckets[PERF_BUCKET_COUNT];  ///< The logarithmic buckets (see \a struct perf_histogram).
+};
+
+/**
+ * @brief A telemetry packet.
+ */
+struct __attribute__((packed)) network_telemetry_packet {
+    struct network_telemetry_header header;                    ///< The packet header.
+    struct network_telemetry_stage  stages[PERF_STAGE_COUNT];  ///< The stage histograms.
+};
+
+void network_telemetry_init(void);
+
+#endif  // SOURCE_NETWORK_NETWORK_TELEMETRY_H_
+
+/**
+ * @}
+ */
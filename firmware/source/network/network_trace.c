@@ -0,0 +1,180 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The network trace drain module.
+ * @details Streams the event trace to a client on the trace port (\a NETWORK_TRACE_TCP_PORT by default, see
+ * tools/trace_decode.py). The stream starts with a header, followed by the post-mortem trace of the last halt (if any),
+ * the backlog of the trace ring, and then live events. Events that the drain could not keep up with are reported as
+ * lost.
+ *
+ * @addtogroup network
+ * @{
+ */
+
+#include "network_trace.h"
+
+#include <string.h>
+
+#include "common/common.h"
+#include "common/memory.h"
+#include "config/config.h"
+#include "lwip/api.h"
+#include "network_tcp.h"
+
+#if TRACE_ENABLE == TRUE
+
+#define NETWORK_TRACE_STACK_SIZE       1024u
+#define NETWORK_TRACE_BATCH_COUNT      32u
+#define NETWORK_TRACE_POLL_INTERVAL_MS 10u
+
+/**
+ * @brief A section of the stream, for events.
+ */
+static struct __attribute__((packed)) {
+    struct network_trace_section section;                             ///< The section header.
+    struct trace_event           events[NETWORK_TRACE_BATCH_COUNT];  ///< The events.
+} g_network_trace_batch;
+
+/**
+ * @brief Write a section to the client.
+ *
+ * @param p_conn A pointer to the client connection.
+ * @param type The section type.
+ * @param p_content A pointer to the section content.
+ * @param length The length of the section content.
+ * @return err_t The lwIP error code.
+ */
+static err_t network_trace_write_section(struct netconn* p_conn, enum network_trace_section_type type,
+                                         const void* p_content, size_t length) {
+    struct network_trace_section section = {.type = (uint32_t)type, .length = (uint32_t)length};
+
+    RETURN_IF_NOT(netconn_write_partly(p_conn, &section, sizeof(section), NETCONN_COPY | NETCONN_MORE, NULL), ERR_OK);
+    return netconn_write(p_conn, p_content, length, NETCONN_COPY);
+}
+
+/**
+ * @brief Write the stream header, and the post-mortem trace, if there is one.
+ *
+ * @param p_conn A pointer to the client connection.
+ * @return err_t The lwIP error code.
+ */
+static err_t network_trace_write_preamble(struct netconn* p_conn) {
+    const struct network_trace_header HEADER = {
+        .magic             = NETWORK_TRACE_MAGIC,
+        .version           = NETWORK_TRACE_VERSION,
+        .event_size        = sizeof(struct trace_event),
+        .counter_frequency = STM32_SYSCLK,
+    };
+
+    RETURN_IF_NOT(netconn_write(p_conn, &HEADER, sizeof(HEADER), NETCONN_COPY), ERR_OK);
+
+    const struct trace_post_mortem* p_post_mortem = trace_get_post_mortem();
+
+    if (p_post_mortem == NULL) {
+        return ERR_OK;
+    }
+
+    RETURN_IF_NOT(network_trace_write_section(p_conn, NETWORK_TRACE_SECTION_POST_MORTEM_REASON, p_post_mortem->reason,
+                                              strnlen(p_post_mortem->reason, sizeof(p_post_mortem->reason))),
+                  ERR_OK);
+
+    return network_trace_write_section(p_conn, NETWORK_TRACE_SECTION_POST_MORTEM_EVENTS, p_post_mortem->events,
+                                       p_post_mortem->event_count * sizeof(struct trace_event));
+}
+
+/**
+ * @brief Stream the trace to a client, until the connection fails.
+ *
+ * @param p_conn A pointer to the client connection.
+ */
+static void network_trace_serve(struct netconn* p_conn) {
+    if (network_trace_write_preamble(p_conn) != ERR_OK) {
+        return;
+    }
+
+    // Start with the backlog that the ring still holds.
+    const uint32_t HEAD            = g_trace_ring.head;
+    uint32_t       tail            = (HEAD > TRACE_EVENT_COUNT) ? (HEAD - TRACE_EVENT_COUNT) : 0u;
+    uint32_t       lost_count      = 0u;
+    uint32_t       sent_lost_count = 0u;
+
+    while (true) {
+        size_t count = trace_read(&tail, g_network_trace_batch.events, NETWORK_TRACE_BATCH_COUNT, &lost_count);
+
+        if (lost_count != sent_lost_count) {
+            const uint32_t NEWLY_LOST_COUNT = lost_count - sent_lost_count;
+
+            if (network_trace_write_section(p_conn, NETWORK_TRACE_SECTION_LOST, &NEWLY_LOST_COUNT,
+                                            sizeof(NEWLY_LOST_COUNT)) != ERR_OK) {
+                return;
+            }
+
+            sent_lost_count = lost_count;
+        }
+
+        if (count == 0u) {
+            chThdSleepMilliseconds(NETWORK_TRACE_POLL_INTERVAL_MS);
+            continue;
+        }
+
+        const size_t LENGTH = count * sizeof(struct trace_event);
+
+        g_network_trace_batch.section.type   = NETWORK_TRACE_SECTION_EVENTS;
+        g_network_trace_batch.section.length = LENGTH;
+
+        if (netconn_write(p_conn, &g_network_trace_batch, sizeof(g_network_trace_batch.section) + LENGTH,
+                          NETCONN_COPY) != ERR_OK) {
+            return;
+        }
+    }
+}
+
+MEMORY_CCM_NOINIT THD_WORKING_AREA(wa_network_trace, NETWORK_TRACE_STACK_SIZE);
+
+/**
+ * @brief The trace drain thread.
+ *
+ * @param p_arg A pointer to arguments to the trace drain, unused.
+ */
+THD_FUNCTION(network_trace, p_arg) {
+    (void)p_arg;
+    struct netconn* p_listen_conn = NULL;
+    err_t           err;
+
+    chRegSetThreadName("network_trace");
+
+    p_listen_conn = netconn_new(NETCONN_TCP);
+    LWIP_ERROR("trace: invalid conn", (p_listen_conn != NULL), chThdExit(MSG_RESET););
+
+    err = netconn_bind(p_listen_conn, IP4_ADDR_ANY, (u16_t)config_get_u32(CONFIG_KEY_TRACE_PORT));
+    LWIP_ERROR("trace: could not bind", (err == ERR_OK), chThdExit(MSG_RESET););
+
+    netconn_listen(p_listen_conn);
+
+    while (true) {
+        struct netconn* p_conn = NULL;
+
+        if (netconn_accept(p_listen_conn, &p_conn) != ERR_OK) {
+            continue;
+        }
+
+        network_tcp_apply_policy(p_conn, &G_NETWORK_TCP_POLICY_BULK);
+        network_trace_serve(p_conn);
+        netconn_close(p_conn);
+        netconn_delete(p_conn);
+    }
+}
+
+/**
+ * @brief Start the trace drain thread. Must be called after the initialization of lwIP.
+ */
+void network_trace_init(void) {
+    chThdCreateStatic(wa_network_trace, sizeof(wa_network_trace), LOWPRIO + 1, network_trace, NULL);
+}
+
+#endif  // TRACE_ENABLE == TRUE
+
+/**
+ * @}
+ */
@@ -0,0 +1,67 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The network trace drain module headers.
+ *
+ * @addtogroup network
+ * @{
+ */
+
+#ifndef SOURCE_NETWORK_NETWORK_TRACE_H_
+#define SOURCE_NETWORK_NETWORK_TRACE_H_
+
+#include <stdint.h>
+
+#include "trace/trace.h"
+
+/**
+ * @brief The TCP port, on which the trace is streamed.
+ */
+#define NETWORK_TRACE_TCP_PORT 2002
+
+/**
+ * @brief The magic value at the start of a trace stream.
+ */
+#define NETWORK_TRACE_MAGIC 0x45435254u  // "TRCE"
+
+/**
+ * @brief The version of the trace stream format. Increment on changes.
+ */
+#define NETWORK_TRACE_VERSION 1u
+
+/**
+ * @brief The header at the start of a trace stream. All fields are little endian.
+ */
+struct __attribute__((packed)) network_trace_header {
+    uint32_t magic;              ///< Must be \a NETWORK_TRACE_MAGIC.
+    uint16_t version;            ///< The stream format version, \a NETWORK_TRACE_VERSION.
+    uint16_t event_size;         ///< The size of a trace event (see \a struct trace_event).
+    uint32_t counter_frequency;  ///< The frequency of the time stamp counter in Hz.
+};
+
+/**
+ * @brief The types of sections that follow the stream header.
+ */
+enum network_trace_section_type {
+    NETWORK_TRACE_SECTION_EVENTS             = 1,  ///< Live trace events.
+    NETWORK_TRACE_SECTION_LOST               = 2,  ///< The number of events that were lost (uint32_t).
+    NETWORK_TRACE_SECTION_POST_MORTEM_REASON = 3,  ///< The halt reason of the post-mortem trace (text).
+    NETWORK_TRACE_SECTION_POST_MORTEM_EVENTS = 4,  ///< The events of the post-mortem trace.
+};
+
+/**
+ * @brief The header of a section of the trace stream.
+ */
+struct __attribute__((packed)) network_trace_section {
+    uint32_t type;    ///< The section type (see \a enum network_trace_section_type).
+    uint32_t length;  ///< The length of the section content in bytes.
+};
+
+void network_trace_init(void);
+
+#endif  // SOURCE_NETWORK_NETWORK_TRACE_H_
+
+/**
+ * @}
+ */
@@ -0,0 +1,374 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The performance measurement module.
+ * @details Collects execution time histograms of GDB commands and subcommands. Histograms are allocated on first
+ * use, and identified by their command character and subcommand string pointer - subcommand strings are entries of
+ * constant tables, so comparing pointers is sufficient. Recording happens in the GDB session thread only, so no
+ * locking is required.
+ *
+ * In addition, the latency of every request is split into stages (see \a enum perf_stage), based on time stamps that
+ * the transport and the GDB core take. Stage histograms can be read from other threads - they are copied under a
+ * critical section.
+ *
+ * Both sets of histograms are printed as tables to a report output, such as the GDB console or the shell.
+ *
+ * @addtogroup perf
+ * @{
+ */
+
+#include "perf.h"
+
+#include <string.h>
+
+#if PERF_ENABLE == TRUE
+
+/**
+ * @brief The histograms in order of allocation.
+ */
+static struct perf_histogram g_perf_histograms[PERF_HISTOGRAM_COUNT];
+
+/**
+ * @brief The number of allocated histograms.
+ */
+static size_t g_perf_histogram_count;
+
+/**
+ * @brief The number of measurements that were dropped, because no histogram was left for allocation.
+ */
+static uint32_t g_perf_dropped_count;
+
+/**
+ * @brief The stage latency histograms.
+ */
+static struct perf_histogram g_perf_stage_histograms[PERF_STAGE_COUNT];
+
+/**
+ * @brief The stage names.
+ */
+static const char* const G_PERF_STAGE_NAMES[PERF_STAGE_COUNT] = {
+    [PERF_STAGE_RECEIVE] = "receive",   [PERF_STAGE_PARSE] = "parse", [PERF_STAGE_EXECUTE] = "execute",
+    [PERF_STAGE_TRANSMIT] = "transmit", [PERF_STAGE_TOTAL] = "total",
+};
+
+/**
+ * @brief The state of the current request.
+ */
+static struct {
+    rtcnt_t  marks[PERF_MARK_COUNT];     ///< The latest time stamps.
+    bool     b_marked[PERF_MARK_COUNT];  ///< True, if the corresponding time stamp was taken.
+    uint32_t transmit_cycles;            ///< The accumulated transmission time since the packet completed.
+} g_perf_request;
+
+/**
+ * @brief Get the logarithmic bucket index for a duration.
+ *
+ * @param cycles The duration in core clock cycles.
+ * @return size_t The bucket index.
+ */
+static inline size_t perf_get_bucket_index(uint32_t cycles) {
+    if (cycles == 0u) {
+        return 0u;
+    }
+
+    size_t index = 31u - (size_t)__builtin_clz(cycles);
+    return (index < PERF_BUCKET_COUNT) ? index : (PERF_BUCKET_COUNT - 1u);
+}
+
+/**
+ * @brief Add a duration to a histogram.
+ *
+ * @param p_histogram A pointer to the histogram.
+ * @param cycles The duration in core clock cycles.
+ */
+static void perf_add_to_histogram(struct perf_histogram* p_histogram, uint32_t cycles) {
+    if (p_histogram->count == 0u) {
+        p_histogram->min = UINT32_MAX;
+    }
+
+    p_histogram->count++;
+    p_histogram->buckets[perf_get_bucket_index(cycles)]++;
+
+    if (cycles < p_histogram->min) {
+        p_histogram->min = cycles;
+    }
+
+    if (cycles > p_histogram->max) {
+        p_histogram->max = cycles;
+    }
+}
+
+/**
+ * @brief Find the histogram of a (sub)command, and allocate it, if it does not exist yet.
+ *
+ * @param command The command character.
+ * @param p_subcommand The subcommand string, or NULL for the command itself.
+ * @return struct perf_histogram* A pointer to the histogram, or NULL, if none is left.
+ */
+static struct perf_histogram* perf_find_histogram(char command, const char* p_subcommand) {
+    for (size_t histogram_index = 0u; histogram_index < g_perf_histogram_count; histogram_index++) {
+        struct perf_histogram* p_histogram = &g_perf_histograms[histogram_index];
+
+        if ((p_histogram->command == command) && (p_histogram->p_subcommand == p_subcommand)) {
+            return p_histogram;
+        }
+    }
+
+    if (g_perf_histogram_count >= PERF_HISTOGRAM_COUNT) {
+        return NULL;
+    }
+
+    struct perf_histogram* p_histogram = &g_perf_histograms[g_perf_histogram_count++];
+
+    p_histogram->command      = command;
+    p_histogram->p_subcommand = p_subcommand;
+
+    return p_histogram;
+}
+
+/**
+ * @brief Record the execution time of a (sub)command.
+ *
+ * @param command The command character.
+ * @param p_subcommand The subcommand string, or NULL for the command itself.
+ * @param cycles The execution time in core clock cycles.
+ */
+void perf_record(char command, const char* p_subcommand, uint32_t cycles) {
+    struct perf_histogram* p_histogram = perf_find_histogram(command, p_subcommand);
+
+    if (p_histogram == NULL) {
+        g_perf_dropped_count++;
+        return;
+    }
+
+    perf_add_to_histogram(p_histogram, cycles);
+}
+
+/**
+ * @brief Reset all histograms.
+ */
+void perf_reset(void) {
+    memset(g_perf_histograms, 0, sizeof(g_perf_histograms));
+    g_perf_histogram_count = 0u;
+    g_perf_dropped_count   = 0u;
+}
+
+/**
+ * @brief Get a histogram by its index.
+ *
+ * @param index The index of the histogram.
+ * @return const struct perf_histogram* A pointer to the histogram, or NULL, if the index is not allocated.
+ */
+const struct perf_histogram* perf_get_histogram(size_t index) {
+    return (index < g_perf_histogram_count) ? &g_perf_histograms[index] : NULL;
+}
+
+/**
+ * @brief Get the number of measurements that were dropped, because all histograms were allocated.
+ *
+ * @return uint32_t The number of dropped measurements.
+ */
+uint32_t perf_get_dropped_count(void) { return g_perf_dropped_count; }
+
+/**
+ * @brief Record the stage latencies of a request, whose handler just returned.
+ * @details Stages are only recorded, if their start was marked. The reception mark is kept, as further packets may
+ * follow in the same received data.
+ *
+ * @param now The time stamp of the handler exit.
+ */
+static void perf_record_stages(rtcnt_t now) {
+    const rtcnt_t* p_marks  = g_perf_request.marks;
+    const uint32_t EXECUTED = (uint32_t)(now - p_marks[PERF_MARK_PARSED]);
+
+    chSysLock();
+    perf_add_to_histogram(&g_perf_stage_histograms[PERF_STAGE_TRANSMIT], g_perf_request.transmit_cycles);
+    perf_add_to_histogram(&g_perf_stage_histograms[PERF_STAGE_EXECUTE],
+                          (EXECUTED > g_perf_request.transmit_cycles) ? (EXECUTED - g_perf_request.transmit_cycles)
+                                                                      : 0u);
+
+    if (g_perf_request.b_marked[PERF_MARK_RECEIVED]) {
+        perf_add_to_histogram(&g_perf_stage_histograms[PERF_STAGE_PARSE],
+                              (uint32_t)(p_marks[PERF_MARK_PARSED] - p_marks[PERF_MARK_RECEIVED]));
+        perf_add_to_histogram(&g_perf_stage_histograms[PERF_STAGE_TOTAL],
+                              (uint32_t)(now - p_marks[PERF_MARK_RECEIVED]));
+    }
+    chSysUnlock();
+
+    g_perf_request.b_marked[PERF_MARK_PARSED] = false;
+}
+
+/**
+ * @brief Take a time stamp for the stage latencies of the current request.
+ *
+ * @param mark The point in time that was reached.
+ */
+void perf_mark(enum perf_mark mark) {
+    const rtcnt_t NOW = chSysGetRealtimeCounterX();
+
+    switch (mark) {
+        case PERF_MARK_RECEIVED:
+            if (g_perf_request.b_marked[PERF_MARK_TRANSMITTED]) {
+                chSysLock();
+                perf_add_to_histogram(&g_perf_stage_histograms[PERF_STAGE_RECEIVE],
+                                      (uint32_t)(NOW - g_perf_request.marks[PERF_MARK_TRANSMITTED]));
+                chSysUnlock();
+
+                g_perf_request.b_marked[PERF_MARK_TRANSMITTED] = false;
+            }
+            break;
+
+        case PERF_MARK_PARSED:
+            g_perf_request.transmit_cycles = 0u;
+            break;
+
+        case PERF_MARK_EXECUTED:
+            if (g_perf_request.b_marked[PERF_MARK_PARSED]) {
+                perf_record_stages(NOW);
+            }
+            return;
+
+        default:
+            break;
+    }
+
+    g_perf_request.marks[mark]    = NOW;
+    g_perf_request.b_marked[mark] = true;
+}
+
+/**
+ * @brief Forget all time stamps, e.g. when a new session starts.
+ */
+void perf_clear_marks(void) { memset(&g_perf_request, 0, sizeof(g_perf_request)); }
+
+/**
+ * @brief Record the time that was spent in writing to the transport, and mark the completion of the transmission.
+ *
+ * @param cycles The duration of the write in core clock cycles.
+ */
+void perf_record_transmit(uint32_t cycles) {
+    g_perf_request.transmit_cycles += cycles;
+    perf_mark(PERF_MARK_TRANSMITTED);
+}
+
+/**
+ * @brief Reset the stage latency histograms.
+ */
+void perf_reset_stages(void) {
+    chSysLock();
+    memset(g_perf_stage_histograms, 0, sizeof(g_perf_stage_histograms));
+    chSysUnlock();
+}
+
+/**
+ * @brief Get a consistent copy of the stage latency histograms. Can be called from any thread.
+ *
+ * @param p_histograms A pointer to an array of \a PERF_STAGE_COUNT histograms to fill.
+ */
+void perf_get_stage_histograms(struct perf_histogram* p_histograms) {
+    ASSERT_PTR_NOT_NULL(p_histograms);
+
+    chSysLock();
+    memcpy(p_histograms, g_perf_stage_histograms, sizeof(g_perf_stage_histograms));
+    chSysUnlock();
+}
+
+/**
+ * @brief Get the name of a stage.
+ *
+ * @param stage The stage.
+ * @return const char* A pointer to the name.
+ */
+const char* perf_get_stage_name(enum perf_stage stage) {
+    ASSERT_VERBOSE(stage < PERF_STAGE_COUNT, "Invalid stage.");
+    return G_PERF_STAGE_NAMES[stage];
+}
+
+/**
+ * @brief Print the header of a histogram table.
+ *
+ * @param p_output A pointer to the report output.
+ * @param p_title A pointer to the title of the first column.
+ */
+static void perf_report_header(const struct report_output* p_output, const char* p_title) {
+    report_printf(p_output, "Durations in cycles at %lu MHz. Buckets are log2(cycles):count.\n",
+                  (unsigned long)(STM32_SYSCLK / 1000000u));
+    report_printf(p_output, "%-20s %10s %10s %10s  %s\n", p_title, "Count", "Min", "Max", "Buckets");
+}
+
+/**
+ * @brief Print a histogram on one line, followed by its non-empty buckets as "n:count", where bucket n holds
+ * durations of [2^n, 2^(n+1)) cycles.
+ *
+ * @param p_output A pointer to the report output.
+ * @param p_label A pointer to the label of the histogram.
+ * @param p_histogram A pointer to the histogram.
+ */
+static void perf_report_histogram(const struct report_output* p_output, const char* p_label,
+                                  const struct perf_histogram* p_histogram) {
+    char   line[PERF_REPORT_LINE_LENGTH];
+    size_t length = (size_t)SNPRINTF(line, ARRAY_LENGTH(line), "%-20s %10lu %10lu %10lu ", p_label,
+                                     (unsigned long)p_histogram->count, (unsigned long)p_histogram->min,
+                                     (unsigned long)p_histogram->max);
+
+    for (size_t bucket_index = 0u; (bucket_index < PERF_BUCKET_COUNT) && (length < ARRAY_LENGTH(line));
+         bucket_index++) {
+        if (p_histogram->buckets[bucket_index] > 0u) {
+            length += (size_t)SNPRINTF(&line[length], ARRAY_LENGTH(line) - length, " %u:%lu",
+                                       (unsigned int)bucket_index, (unsigned long)p_histogram->buckets[bucket_index]);
+        }
+    }
+
+    report_printf(p_output, "%s\n", line);
+}
+
+/**
+ * @brief Print the execution time histograms of all commands. Subcommands are listed with their parent command
+ * character.
+ * @details The histograms are read while the GDB session thread may still record to them, such that a line can be off
+ * by the measurement in progress.
+ *
+ * @param p_output A pointer to the report output.
+ */
+void perf_report(const struct report_output* p_output) {
+    const struct perf_histogram* p_histogram = NULL;
+
+    perf_report_header(p_output, "Command");
+
+    for (size_t histogram_index = 0u; (p_histogram = perf_get_histogram(histogram_index)) != NULL;
+         histogram_index++) {
+        char label[PERF_REPORT_LABEL_LENGTH];
+
+        SNPRINTF(label, ARRAY_LENGTH(label), "%c %s", p_histogram->command,
+                 (p_histogram->p_subcommand != NULL) ? p_histogram->p_subcommand : "");
+        perf_report_histogram(p_output, label, p_histogram);
+    }
+
+    if (perf_get_dropped_count() > 0u) {
+        report_printf(p_output, "%lu measurements dropped, out of histograms.\n",
+                      (unsigned long)perf_get_dropped_count());
+    }
+}
+
+/**
+ * @brief Print the request latency histograms per stage.
+ *
+ * @param p_output A pointer to the report output.
+ */
+void perf_report_stages(const struct report_output* p_output) {
+    struct perf_histogram histograms[PERF_STAGE_COUNT];
+    perf_get_stage_histograms(histograms);
+
+    perf_report_header(p_output, "Stage");
+
+    for (size_t stage_index = 0u; stage_index < PERF_STAGE_COUNT; stage_index++) {
+        perf_report_histogram(p_output, perf_get_stage_name((enum perf_stage)stage_index), &histograms[stage_index]);
+    }
+}
+
+#endif  // PERF_ENABLE == TRUE
+
+/**
+ * @}
+ */
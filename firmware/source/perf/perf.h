@@ -0,0 +1,158 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The performance measurement module headers.
+ *
+ * @addtogroup perf
+ * @{
+ */
+
+#ifndef SOURCE_PERF_PERF_H_
+#define SOURCE_PERF_PERF_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/common.h"
+#include "common/report.h"
+
+/**
+ * @brief Enables the measurement of GDB command execution times. When disabled, all measurements are compiled out.
+ */
+#ifndef PERF_ENABLE
+#define PERF_ENABLE FALSE
+#endif
+
+/**
+ * @brief The number of logarithmic histogram buckets. Bucket n counts durations of [2^n, 2^(n+1)) cycles, the last
+ * bucket also counts all longer ones.
+ */
+#define PERF_BUCKET_COUNT 24u
+
+/**
+ * @brief The maximum number of distinct (sub)commands, for which histograms are recorded.
+ */
+#define PERF_HISTOGRAM_COUNT 48u
+
+/**
+ * @brief The maximum length of a histogram line in reports, and of its label.
+ */
+#define PERF_REPORT_LINE_LENGTH  256u
+#define PERF_REPORT_LABEL_LENGTH 64u
+
+/**
+ * @brief The stages of a request, from reception to the reply, for which latency histograms are recorded.
+ */
+enum perf_stage {
+    PERF_STAGE_RECEIVE,   ///< From the completed transmission of the previous reply, to the reception of new data.
+    PERF_STAGE_PARSE,     ///< From the reception of the data, to the completion of the packet.
+    PERF_STAGE_EXECUTE,   ///< From the completion of the packet, to the exit of its handler, without transmission.
+    PERF_STAGE_TRANSMIT,  ///< The time spent in writing the acknowledgement and reply to the transport.
+    PERF_STAGE_TOTAL,     ///< From the reception of the data, to the exit of the handler.
+    PERF_STAGE_COUNT
+};
+
+/**
+ * @brief The points in time during the handling of a request, at which time stamps are taken.
+ */
+enum perf_mark {
+    PERF_MARK_RECEIVED,     ///< The transport received data.
+    PERF_MARK_PARSED,       ///< A packet was completed.
+    PERF_MARK_EXECUTED,     ///< The handler of the packet returned.
+    PERF_MARK_TRANSMITTED,  ///< The transport completed writing data.
+    PERF_MARK_COUNT
+};
+
+/**
+ * @brief A histogram of execution times in core clock cycles.
+ */
+struct perf_histogram {
+    char        command;       ///< The command character.
+    const char* p_subcommand;  ///< The subcommand string, or NULL for the command itself.
+
+    uint32_t count;                       ///< The number of measurements.
+    uint32_t min;                         ///< The shortest duration.
+    uint32_t max;                         ///< The longest duration.
+    uint32_t buckets[PERF_BUCKET_COUNT];  ///< The number of measurements per logarithmic bucket.
+};
+
+#if PERF_ENABLE == TRUE
+
+/**
+ * @brief Measure the execution time of a statement in core clock cycles, and record it.
+ * @details The ChibiOS realtime counter is the DWT cycle counter (CYCCNT).
+ *
+ * @param _command The command character.
+ * @param _p_subcommand The subcommand string, or NULL for the command itself.
+ * @param _statement The statement to measure.
+ */
+#define PERF_MEASURE(_command, _p_subcommand, _statement)                                                              \
+    do {                                                                                                               \
+        const rtcnt_t PERF_START = chSysGetRealtimeCounterX();                                                         \
+        _statement;                                                                                                    \
+        perf_record((_command), (_p_subcommand), (uint32_t)(chSysGetRealtimeCounterX() - PERF_START));                 \
+    } while (false)
+
+/**
+ * @brief Take a time stamp for the stage latencies of the current request.
+ *
+ * @param _mark The point in time (see \a enum perf_mark).
+ */
+#define PERF_MARK(_mark) perf_mark(_mark)
+
+/**
+ * @brief Forget all time stamps, e.g. when a new session starts.
+ */
+#define PERF_CLEAR_MARKS() perf_clear_marks()
+
+/**
+ * @brief Measure the time that a statement spends in transmitting data, and mark its completion.
+ *
+ * @param _statement The statement to measure.
+ */
+#define PERF_TRANSMIT(_statement)                                                                                      \
+    do {                                                                                                               \
+        const rtcnt_t PERF_START = chSysGetRealtimeCounterX();                                                         \
+        _statement;                                                                                                    \
+        perf_record_transmit((uint32_t)(chSysGetRealtimeCounterX() - PERF_START));                                     \
+    } while (false)
+
+void                         perf_record(char command, const char* p_subcommand, uint32_t cycles);
+void                         perf_reset(void);
+const struct perf_histogram* perf_get_histogram(size_t index);
+uint32_t                     perf_get_dropped_count(void);
+
+void        perf_mark(enum perf_mark mark);
+void        perf_clear_marks(void);
+void        perf_record_transmit(uint32_t cycles);
+void        perf_reset_stages(void);
+void        perf_get_stage_histograms(struct perf_histogram* p_histograms);
+const char* perf_get_stage_name(enum perf_stage stage);
+
+void perf_report(const struct report_output* p_output);
+void perf_report_stages(const struct report_output* p_output);
+
+#else
+
+#define PERF_MEASURE(_command, _p_subcommand, _statement)                                                              \
+    do {                                                                                                               \
+        _statement;                                                                                                    \
+    } while (false)
+
+#define PERF_MARK(_mark)
+#define PERF_CLEAR_MARKS()
+
+#define PERF_TRANSMIT(_statement)                                                                                      \
+    do {                                                                                                               \
+        _statement;                                                                                                    \
+    } while (false)
+
+#endif  // PERF_ENABLE == TRUE
+
+#endif  // SOURCE_PERF_PERF_H_
+
+/**
+ * @}
+ */
@@ -0,0 +1,801 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The SD card recorder module.
+ * @details Records the event trace, the power profile and the target serial port to an SD card, without a host. The
+ * card holds no file system, but an append-only container (see recorder.h): a volume header in chunk 0, followed by
+ * chunks of records. A card is only written, after it was formatted by the recorder, such that other data on it is
+ * left alone. Recording resumes after the last valid chunk on every boot, which starts a new session.
+ *
+ * Two threads share a pair of chunk buffers. The filler thread takes records from the streams, and hands a buffer on,
+ * when it is full, or after \a RECORDER_FLUSH_INTERVAL_MS. The writer thread writes it to the card with a multi-sector
+ * DMA transfer. If the card stalls for longer than the streams can buffer, their own loss reporting shows the gap:
+ * lost trace events, gaps in the power profile sequence, and serial port overruns.
+ *
+ * The recording is served over the network (see network/network_recorder.h).
+ *
+ * @addtogroup recorder
+ * @{
+ */
+
+#include "recorder.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "ch.h"
+#include "common/crc.h"
+#include "common/memory.h"
+#include "config/config.h"
+#include "hal.h"
+#include "network/network_power.h"
+#include "network/network_trace.h"
+
+#if RECORDER_ENABLE == TRUE
+
+#define RECORDER_WRITER_STACK_SIZE 1024u
+#define RECORDER_FILLER_STACK_SIZE 1024u
+#define RECORDER_BUFFER_COUNT      2u
+#define RECORDER_POLL_INTERVAL_MS  10u
+#define RECORDER_FLUSH_INTERVAL_MS 1000u
+#define RECORDER_CARD_INTERVAL_MS  1000u
+#define RECORDER_TRACE_BATCH_COUNT 64u
+#define RECORDER_UART_BATCH_SIZE   256u
+
+/**
+ * @brief A chunk buffer. The filler thread appends records to it, and the writer thread writes it to the card.
+ */
+struct recorder_buffer {
+    uint8_t   data[RECORDER_CHUNK_SIZE] __attribute__((aligned(4)));  ///< The chunk, starting with its header.
+    size_t    length;             ///< The length of the chunk header and the records.
+    uint32_t  generation;         ///< The session generation, in which the records were taken.
+    systime_t first_record_time;  ///< The time, at which the first record was appended.
+};
+
+/**
+ * @brief The chunk buffers. They have to stay outside of the core coupled memory, for the DMA.
+ */
+static struct recorder_buffer g_recorder_buffers[RECORDER_BUFFER_COUNT];
+
+/**
+ * @brief A sector buffer for reading and writing headers. Guarded by \a g_recorder_card_mutex.
+ */
+static uint8_t g_recorder_sector[RECORDER_SECTOR_SIZE] __attribute__((aligned(4)));
+
+/**
+ * @brief Guards the card, and the recorder state.
+ */
+static MUTEX_DECL(g_recorder_card_mutex);
+
+/**
+ * @brief The state of the recorder.
+ */
+static struct {
+    volatile enum recorder_state state;               ///< The recorder state.
+    volatile uint32_t            generation;          ///< Changes with every session, such that the streams restart.
+    uint32_t                     volume;              ///< The volume identifier of the card.
+    uint32_t                     session;             ///< The current session.
+    uint32_t                     next_index;          ///< The index of the next chunk to write.
+    uint32_t                     chunk_count;         ///< The number of chunks that fit on the card.
+    uint32_t                     written_count;       ///< The number of chunks that were written.
+    uint32_t                     dropped_count;       ///< The number of chunks that were dropped, without a card.
+    uint32_t                     error_count;         ///< The number of failed writes.
+    uint32_t                     max_write_time_ms;   ///< The longest time that writing a chunk took.
+    uint32_t                     uart_overrun_count;  ///< The number of serial port overruns.
+    mailbox_t                    free_buffers;        ///< Buffers that the filler thread can take.
+    mailbox_t                    full_buffers;        ///< Buffers that the writer thread writes.
+    msg_t free_messages[RECORDER_BUFFER_COUNT];       ///< The storage of \a free_buffers.
+    msg_t full_messages[RECORDER_BUFFER_COUNT];       ///< The storage of \a full_buffers.
+} g_recorder;
+
+/**
+ * @brief The state of the filler thread.
+ */
+static struct {
+    struct recorder_buffer* p_buffer;    ///< The buffer that is being filled.
+    uint32_t                generation;  ///< The session generation, for which the streams were started.
+#if TRACE_ENABLE == TRUE
+    uint32_t trace_tail;             ///< The number of trace events that were taken.
+    uint32_t trace_lost_count;       ///< The number of trace events that were lost.
+    uint32_t trace_sent_lost_count;  ///< The number of lost trace events that were recorded.
+#endif
+#if POWER_PROFILE_ENABLE == TRUE
+    uint32_t power_tail;       ///< The number of power profile blocks that were taken.
+    bool     b_power_started;  ///< True, if the power profile is sampled for the recorder.
+#endif
+} g_recorder_filler;
+
+#if TRACE_ENABLE == TRUE
+/**
+ * @brief A section of the trace stream, for events. Stream data is staged, and then copied into records, which have no
+ * alignment.
+ */
+static struct __attribute__((packed)) {
+    struct network_trace_section section;                              ///< The section header.
+    struct trace_event           events[RECORDER_TRACE_BATCH_COUNT];  ///< The events.
+} g_recorder_trace_batch MEMORY_CCM_NOINIT;
+#endif
+
+#if POWER_PROFILE_ENABLE == TRUE
+/**
+ * @brief A power profile block, staged for a record.
+ */
+static struct power_profile_block g_recorder_power_block MEMORY_CCM_NOINIT;
+#endif
+
+/**
+ * @brief Serial port data, staged for a record.
+ */
+static uint8_t g_recorder_uart_data[RECORDER_UART_BATCH_SIZE] MEMORY_CCM_NOINIT;
+
+/**
+ * @brief The names of the recorder states, for reports.
+ */
+static const char* const G_RECORDER_STATE_NAMES[] = {
+    [RECORDER_STATE_NO_CARD]     = "no card",
+    [RECORDER_STATE_UNFORMATTED] = "card not formatted",
+    [RECORDER_STATE_RECORDING]   = "recording",
+    [RECORDER_STATE_FULL]        = "card full",
+    [RECORDER_STATE_ERROR]       = "write error",
+};
+
+/**
+ * @brief The configuration of the card. Only the first data line is connected.
+ */
+static const SDCConfig G_RECORDER_SDC_CONFIG = {
+    .bus_width = SDC_MODE_1BIT,
+};
+
+/**
+ * @brief The configuration of the target serial port. The baud rate is set from the configuration store.
+ */
+static SerialConfig g_recorder_uart_config = {
+    .speed = RECORDER_UART_BAUD_RATE,
+    .cr1   = 0u,
+    .cr2   = USART_CR2_STOP1_BITS,
+    .cr3   = 0u,
+};
+
+/**
+ * @brief Read the header of a chunk, and check that it belongs to the volume.
+ * @note Called with the card mutex held.
+ *
+ * @param index The index of the chunk.
+ * @param p_header A pointer to the header to fill.
+ * @return bool True, if the chunk was read, and belongs to the volume.
+ */
+static bool recorder_read_chunk_header(uint32_t index, struct recorder_chunk_header* p_header) {
+    if (sdcRead(&SDCD1, index * RECORDER_CHUNK_SECTORS, g_recorder_sector, 1u) != HAL_SUCCESS) {
+        return false;
+    }
+
+    memcpy(p_header, g_recorder_sector, sizeof(*p_header));
+
+    return (p_header->magic == RECORDER_CHUNK_MAGIC) && (p_header->volume == g_recorder.volume) &&
+           (p_header->index == index);
+}
+
+/**
+ * @brief Check the CRC of a whole chunk, which is read sector by sector.
+ * @note Called with the card mutex held.
+ *
+ * @param index The index of the chunk.
+ * @return bool True, if the chunk is complete.
+ */
+static bool recorder_is_chunk_complete(uint32_t index) {
+    struct recorder_chunk_header header;
+    uint32_t                     crc = CRC_32_INIT;
+
+    for (uint32_t sector_index = 0u; sector_index < RECORDER_CHUNK_SECTORS; sector_index++) {
+        if (sdcRead(&SDCD1, index * RECORDER_CHUNK_SECTORS + sector_index, g_recorder_sector, 1u) != HAL_SUCCESS) {
+            return false;
+        }
+
+        if (sector_index == 0u) {
+            memcpy(&header, g_recorder_sector, sizeof(header));
+            memset(&g_recorder_sector[offsetof(struct recorder_chunk_header, crc)], 0, sizeof(header.crc));
+        }
+
+        crc = crc_32_update(crc, g_recorder_sector, RECORDER_SECTOR_SIZE);
+    }
+
+    return crc == header.crc;
+}
+
+/**
+ * @brief Find the end of the recording, the first chunk that is not valid. Valid chunks follow each other from chunk 1
+ * on, so it takes a binary search.
+ * @note Called with the card mutex held.
+ *
+ * @return uint32_t The index of the first chunk that is not valid.
+ */
+static uint32_t recorder_find_end(void) {
+    struct recorder_chunk_header header;
+    uint32_t                     low  = 1u;
+    uint32_t                     high = g_recorder.chunk_count;
+
+    while (low < high) {
+        const uint32_t MIDDLE = low + (high - low) / 2u;
+
+        if (recorder_read_chunk_header(MIDDLE, &header)) {
+            low = MIDDLE + 1u;
+        } else {
+            high = MIDDLE;
+        }
+    }
+
+    return low;
+}
+
+/**
+ * @brief Open the volume on the card, and start a new session after the last complete chunk.
+ * @note Called with the card mutex held.
+ *
+ * @param volume The volume identifier.
+ */
+static void recorder_open_volume(uint32_t volume) {
+    struct recorder_chunk_header header;
+    uint32_t                     end = 1u;
+
+    g_recorder.volume = volume;
+    end               = recorder_find_end();
+
+    // A write may have been cut off by a power loss - the chunk is then overwritten.
+    if ((end > 1u) && !recorder_is_chunk_complete(end - 1u)) {
+        end--;
+    }
+
+    g_recorder.session    = ((end > 1u) && recorder_read_chunk_header(end - 1u, &header)) ? (header.session + 1u) : 1u;
+    g_recorder.next_index = end;
+    g_recorder.generation++;
+    g_recorder.state = (end < g_recorder.chunk_count) ? RECORDER_STATE_RECORDING : RECORDER_STATE_FULL;
+}
+
+/**
+ * @brief Read the volume header of the card.
+ * @note Called with the card mutex held.
+ *
+ * @param p_header A pointer to the header to fill.
+ * @return bool True, if the card holds a valid volume header.
+ */
+static bool recorder_read_volume_header(struct recorder_volume_header* p_header) {
+    if (sdcRead(&SDCD1, 0u, g_recorder_sector, 1u) != HAL_SUCCESS) {
+        return false;
+    }
+
+    memcpy(p_header, g_recorder_sector, sizeof(*p_header));
+
+    return (p_header->magic == RECORDER_VOLUME_MAGIC) && (p_header->version == RECORDER_VERSION) &&
+           (p_header->chunk_sectors == RECORDER_CHUNK_SECTORS) &&
+           (p_header->crc == crc_32(p_header, offsetof(struct recorder_volume_header, crc)));
+}
+
+/**
+ * @brief Connect an inserted card, and open its volume.
+ * @note Called with the card mutex held.
+ */
+static void recorder_mount(void) {
+    struct recorder_volume_header header;
+    BlockDeviceInfo               info;
+
+    if (!blkIsInserted(&SDCD1) || (sdcConnect(&SDCD1) != HAL_SUCCESS)) {
+        return;
+    }
+
+    if (blkGetInfo(&SDCD1, &info) != HAL_SUCCESS) {
+        sdcDisconnect(&SDCD1);
+        return;
+    }
+
+    g_recorder.chunk_count = info.blk_num / RECORDER_CHUNK_SECTORS;
+
+    if (!recorder_read_volume_header(&header)) {
+        g_recorder.state = RECORDER_STATE_UNFORMATTED;
+        return;
+    }
+
+    recorder_open_volume(header.volume);
+}
+
+/**
+ * @brief Follow card insertion and removal.
+ */
+static void recorder_check_card(void) {
+    chMtxLock(&g_recorder_card_mutex);
+
+    if (g_recorder.state == RECORDER_STATE_NO_CARD) {
+        recorder_mount();
+    } else if (!blkIsInserted(&SDCD1)) {
+        sdcDisconnect(&SDCD1);
+        g_recorder.state = RECORDER_STATE_NO_CARD;
+    }
+
+    chMtxUnlock(&g_recorder_card_mutex);
+}
+
+/**
+ * @brief Complete the header of a chunk buffer, and write it to the card.
+ *
+ * @param p_buffer A pointer to the chunk buffer.
+ */
+static void recorder_write(struct recorder_buffer* p_buffer) {
+    chMtxLock(&g_recorder_card_mutex);
+
+    if ((g_recorder.state != RECORDER_STATE_RECORDING) || (p_buffer->generation != g_recorder.generation)) {
+        g_recorder.dropped_count++;
+        chMtxUnlock(&g_recorder_card_mutex);
+        return;
+    }
+
+    const struct recorder_chunk_header HEADER = {
+        .magic          = RECORDER_CHUNK_MAGIC,
+        .volume         = g_recorder.volume,
+        .index          = g_recorder.next_index,
+        .session        = g_recorder.session,
+        .uptime_ms      = (uint32_t)TIME_I2MS(chVTGetSystemTimeX()),
+        .payload_length = p_buffer->length - sizeof(struct recorder_chunk_header),
+        .crc            = 0u,
+    };
+
+    memcpy(p_buffer->data, &HEADER, sizeof(HEADER));
+    memset(&p_buffer->data[p_buffer->length], 0, RECORDER_CHUNK_SIZE - p_buffer->length);
+
+    const uint32_t CRC = crc_32(p_buffer->data, RECORDER_CHUNK_SIZE);
+    memcpy(&p_buffer->data[offsetof(struct recorder_chunk_header, crc)], &CRC, sizeof(CRC));
+
+    const systime_t START = chVTGetSystemTimeX();
+    const bool      b_failed =
+        (sdcWrite(&SDCD1, g_recorder.next_index * RECORDER_CHUNK_SECTORS, p_buffer->data, RECORDER_CHUNK_SECTORS) !=
+         HAL_SUCCESS);
+    const uint32_t WRITE_TIME_MS = (uint32_t)TIME_I2MS(chVTTimeElapsedSinceX(START));
+
+    g_recorder.max_write_time_ms = (WRITE_TIME_MS > g_recorder.max_write_time_ms) ? WRITE_TIME_MS
+                                                                                  : g_recorder.max_write_time_ms;
+
+    if (b_failed) {
+        g_recorder.error_count++;
+        g_recorder.state = RECORDER_STATE_ERROR;
+    } else {
+        g_recorder.written_count++;
+        g_recorder.next_index++;
+
+        if (g_recorder.next_index >= g_recorder.chunk_count) {
+            g_recorder.state = RECORDER_STATE_FULL;
+        }
+    }
+
+    chMtxUnlock(&g_recorder_card_mutex);
+}
+
+/**
+ * @brief Take an empty chunk buffer for the filler thread. Waits for the writer thread, if it has none.
+ */
+static void recorder_take_buffer(void) {
+    msg_t message = 0;
+
+    (void)chMBFetchTimeout(&g_recorder.free_buffers, &message, TIME_INFINITE);
+
+    g_recorder_filler.p_buffer             = (struct recorder_buffer*)message;
+    g_recorder_filler.p_buffer->length     = sizeof(struct recorder_chunk_header);
+    g_recorder_filler.p_buffer->generation = g_recorder_filler.generation;
+}
+
+/**
+ * @brief Hand the chunk buffer of the filler thread to the writer thread, and take the next one.
+ */
+static void recorder_flush(void) {
+    (void)chMBPostTimeout(&g_recorder.full_buffers, (msg_t)g_recorder_filler.p_buffer, TIME_INFINITE);
+    recorder_take_buffer();
+}
+
+/**
+ * @brief Append a record to the chunk buffer of the filler thread. If it does not fit, the buffer is flushed first.
+ *
+ * @param stream The stream of the record.
+ * @param p_data A pointer to the record data.
+ * @param length The length of the record data.
+ */
+static void recorder_append(enum recorder_stream stream, const void* p_data, size_t length) {
+    const struct recorder_record_header RECORD = {.stream = (uint16_t)stream, .length = (uint16_t)length};
+    const size_t RECORD_SIZE = sizeof(RECORD) + length;
+
+    ASSERT_VERBOSE(RECORD_SIZE <= (RECORDER_CHUNK_SIZE - sizeof(struct recorder_chunk_header)), "Record too long.");
+
+    if ((g_recorder_filler.p_buffer->length + RECORD_SIZE) > RECORDER_CHUNK_SIZE) {
+        recorder_flush();
+    }
+
+    struct recorder_buffer* p_buffer = g_recorder_filler.p_buffer;
+
+    if (p_buffer->length == sizeof(struct recorder_chunk_header)) {
+        p_buffer->first_record_time = chVTGetSystemTimeX();
+    }
+
+    memcpy(&p_buffer->data[p_buffer->length], &RECORD, sizeof(RECORD));
+    memcpy(&p_buffer->data[p_buffer->length + sizeof(RECORD)], p_data, length);
+    p_buffer->length += RECORD_SIZE;
+}
+
+#if TRACE_ENABLE == TRUE
+/**
+ * @brief Start the trace stream of a session with its header, and the backlog that the trace ring still holds.
+ */
+static void recorder_start_trace(void) {
+    const struct network_trace_header HEADER = {
+        .magic             = NETWORK_TRACE_MAGIC,
+        .version           = NETWORK_TRACE_VERSION,
+        .event_size        = sizeof(struct trace_event),
+        .counter_frequency = STM32_SYSCLK,
+    };
+    const uint32_t HEAD = g_trace_ring.head;
+
+    g_recorder_filler.trace_tail            = (HEAD > TRACE_EVENT_COUNT) ? (HEAD - TRACE_EVENT_COUNT) : 0u;
+    g_recorder_filler.trace_lost_count      = 0u;
+    g_recorder_filler.trace_sent_lost_count = 0u;
+
+    recorder_append(RECORDER_STREAM_TRACE, &HEADER, sizeof(HEADER));
+}
+
+/**
+ * @brief Take new trace events, and report lost ones.
+ */
+static void recorder_fill_trace(void) {
+    size_t count = 0u;
+
+    do {
+        count = trace_read(&g_recorder_filler.trace_tail, g_recorder_trace_batch.events, RECORDER_TRACE_BATCH_COUNT,
+                           &g_recorder_filler.trace_lost_count);
+
+        if (g_recorder_filler.trace_lost_count != g_recorder_filler.trace_sent_lost_count) {
+            const struct __attribute__((packed)) {
+                struct network_trace_section section;
+                uint32_t                     newly_lost_count;
+            } LOST = {
+                .section          = {.type = NETWORK_TRACE_SECTION_LOST, .length = sizeof(uint32_t)},
+                .newly_lost_count = g_recorder_filler.trace_lost_count - g_recorder_filler.trace_sent_lost_count,
+            };
+
+            recorder_append(RECORDER_STREAM_TRACE, &LOST, sizeof(LOST));
+            g_recorder_filler.trace_sent_lost_count = g_recorder_filler.trace_lost_count;
+        }
+
+        if (count > 0u) {
+            const size_t LENGTH = count * sizeof(struct trace_event);
+
+            g_recorder_trace_batch.section.type   = NETWORK_TRACE_SECTION_EVENTS;
+            g_recorder_trace_batch.section.length = LENGTH;
+            recorder_append(RECORDER_STREAM_TRACE, &g_recorder_trace_batch,
+                            sizeof(g_recorder_trace_batch.section) + LENGTH);
+        }
+    } while (count == RECORDER_TRACE_BATCH_COUNT);
+}
+#endif  // TRACE_ENABLE == TRUE
+
+#if POWER_PROFILE_ENABLE == TRUE
+/**
+ * @brief Start the power profile stream of a session with its header. Sampling starts, if it does not run yet.
+ */
+static void recorder_start_power(void) {
+    const struct network_power_header HEADER = {
+        .magic             = NETWORK_POWER_MAGIC,
+        .version           = NETWORK_POWER_VERSION,
+        .block_size        = sizeof(struct power_profile_block),
+        .counter_frequency = STM32_SYSCLK,
+        .sample_rate       = POWER_PROFILE_SAMPLE_RATE_HZ,
+        .decimation        = POWER_PROFILE_DECIMATION,
+        .record_count      = POWER_PROFILE_BLOCK_RECORD_COUNT,
+    };
+
+    if (!g_recorder_filler.b_power_started) {
+        power_profile_start(&g_recorder_filler.power_tail);
+        g_recorder_filler.b_power_started = true;
+    }
+
+    recorder_append(RECORDER_STREAM_POWER, &HEADER, sizeof(HEADER));
+}
+
+/**
+ * @brief Stop sampling for the recorder.
+ */
+static void recorder_stop_power(void) {
+    if (g_recorder_filler.b_power_started) {
+        power_profile_stop();
+        g_recorder_filler.b_power_started = false;
+    }
+}
+
+/**
+ * @brief Take new power profile blocks.
+ */
+static void recorder_fill_power(void) {
+    while (power_profile_read(&g_recorder_filler.power_tail, &g_recorder_power_block)) {
+        recorder_append(RECORDER_STREAM_POWER, &g_recorder_power_block, sizeof(g_recorder_power_block));
+    }
+}
+#endif  // POWER_PROFILE_ENABLE == TRUE
+
+/**
+ * @brief Take the bytes that the target sent on its serial port.
+ *
+ * @param p_listener A pointer to the listener of serial port events, for overruns.
+ */
+static void recorder_fill_uart(event_listener_t* p_listener) {
+    size_t length = 0u;
+
+    if ((chEvtGetAndClearFlags(p_listener) & (SD_OVERRUN_ERROR | SD_QUEUE_FULL_ERROR)) != 0u) {
+        g_recorder.uart_overrun_count++;
+    }
+
+    do {
+        length = chnReadTimeout(&SD2, g_recorder_uart_data, ARRAY_LENGTH(g_recorder_uart_data), TIME_IMMEDIATE);
+
+        if (length > 0u) {
+            recorder_append(RECORDER_STREAM_UART, g_recorder_uart_data, length);
+        }
+    } while (length == ARRAY_LENGTH(g_recorder_uart_data));
+}
+
+/**
+ * @brief Start the streams of a new session. Records of the previous session, which were not written, are dropped.
+ */
+static void recorder_start_session(void) {
+    g_recorder_filler.generation           = g_recorder.generation;
+    g_recorder_filler.p_buffer->length     = sizeof(struct recorder_chunk_header);
+    g_recorder_filler.p_buffer->generation = g_recorder_filler.generation;
+
+#if TRACE_ENABLE == TRUE
+    recorder_start_trace();
+#endif
+#if POWER_PROFILE_ENABLE == TRUE
+    recorder_start_power();
+#endif
+}
+
+static MEMORY_CCM_NOINIT THD_WORKING_AREA(wa_recorder_filler, RECORDER_FILLER_STACK_SIZE);
+
+/**
+ * @brief The recorder filler thread, which takes records from the streams.
+ *
+ * @param p_arg A pointer to arguments to the filler, unused.
+ */
+static THD_FUNCTION(recorder_filler, p_arg) {
+    (void)p_arg;
+    event_listener_t uart_listener;
+
+    chRegSetThreadName("recorder_filler");
+    chEvtRegisterMaskWithFlags(chnGetEventSource(&SD2), &uart_listener, EVENT_MASK(0),
+                               SD_OVERRUN_ERROR | SD_QUEUE_FULL_ERROR);
+    recorder_take_buffer();
+
+    while (true) {
+        chThdSleepMilliseconds(RECORDER_POLL_INTERVAL_MS);
+
+        if (g_recorder.state != RECORDER_STATE_RECORDING) {
+#if POWER_PROFILE_ENABLE == TRUE
+            recorder_stop_power();
+#endif
+            g_recorder_filler.generation = 0u;
+            continue;
+        }
+
+        if (g_recorder_filler.generation != g_recorder.generation) {
+            recorder_start_session();
+        }
+
+#if TRACE_ENABLE == TRUE
+        recorder_fill_trace();
+#endif
+#if POWER_PROFILE_ENABLE == TRUE
+        recorder_fill_power();
+#endif
+        recorder_fill_uart(&uart_listener);
+
+        const struct recorder_buffer* p_buffer = g_recorder_filler.p_buffer;
+
+        if ((p_buffer->length > sizeof(struct recorder_chunk_header)) &&
+            (chVTTimeElapsedSinceX(p_buffer->first_record_time) >= TIME_MS2I(RECORDER_FLUSH_INTERVAL_MS))) {
+            recorder_flush();
+        }
+    }
+}
+
+static MEMORY_CCM_NOINIT THD_WORKING_AREA(wa_recorder_writer, RECORDER_WRITER_STACK_SIZE);
+
+/**
+ * @brief The recorder writer thread, which writes full chunk buffers to the card, and follows the card.
+ *
+ * @param p_arg A pointer to arguments to the writer, unused.
+ */
+static THD_FUNCTION(recorder_writer, p_arg) {
+    (void)p_arg;
+    chRegSetThreadName("recorder_writer");
+
+    while (true) {
+        msg_t message = 0;
+
+        if (chMBFetchTimeout(&g_recorder.full_buffers, &message, TIME_MS2I(RECORDER_CARD_INTERVAL_MS)) == MSG_OK) {
+            recorder_write((struct recorder_buffer*)message);
+            (void)chMBPostTimeout(&g_recorder.free_buffers, message, TIME_INFINITE);
+        }
+
+        recorder_check_card();
+    }
+}
+
+/**
+ * @brief Get the state of the recorder.
+ *
+ * @return enum recorder_state The state.
+ */
+enum recorder_state recorder_get_state(void) { return g_recorder.state; }
+
+/**
+ * @brief Format the card for recording, which discards all data on it. A new volume and session start.
+ *
+ * @return bool True, if the card was formatted.
+ */
+bool recorder_format(void) {
+    struct recorder_volume_header header;
+    bool                          b_formatted = false;
+
+    chMtxLock(&g_recorder_card_mutex);
+
+    if ((g_recorder.state == RECORDER_STATE_NO_CARD) || (g_recorder.state == RECORDER_STATE_ERROR)) {
+        chMtxUnlock(&g_recorder_card_mutex);
+        return false;
+    }
+
+    // Chunks of the previous volume no longer match, such that the recording starts from chunk 1 again.
+    const uint32_t VOLUME =
+        recorder_read_volume_header(&header) ? (header.volume + 1u) : (uint32_t)chSysGetRealtimeCounterX();
+
+    header = (struct recorder_volume_header){
+        .magic         = RECORDER_VOLUME_MAGIC,
+        .version       = RECORDER_VERSION,
+        .chunk_sectors = RECORDER_CHUNK_SECTORS,
+        .volume        = VOLUME,
+    };
+    header.crc = crc_32(&header, offsetof(struct recorder_volume_header, crc));
+
+    memset(g_recorder_sector, 0, sizeof(g_recorder_sector));
+    memcpy(g_recorder_sector, &header, sizeof(header));
+
+    if (sdcWrite(&SDCD1, 0u, g_recorder_sector, 1u) == HAL_SUCCESS) {
+        g_recorder.volume     = VOLUME;
+        g_recorder.session    = 1u;
+        g_recorder.next_index = 1u;
+        g_recorder.generation++;
+        g_recorder.state = RECORDER_STATE_RECORDING;
+        b_formatted      = true;
+    } else {
+        g_recorder.error_count++;
+        g_recorder.state = RECORDER_STATE_ERROR;
+    }
+
+    chMtxUnlock(&g_recorder_card_mutex);
+    return b_formatted;
+}
+
+/**
+ * @brief Find the session that starts at a chunk, and the number of its chunks. Sessions follow each other, so the next
+ * one starts after the returned range.
+ *
+ * @param first_index The index of the first chunk of the session, starting with 1.
+ * @param p_session A pointer to the session to fill.
+ * @return bool True, if a session was found.
+ */
+bool recorder_find_session(uint32_t first_index, struct recorder_session* p_session) {
+    ASSERT_PTR_NOT_NULL(p_session);
+
+    struct recorder_chunk_header header;
+    bool                         b_found = false;
+
+    chMtxLock(&g_recorder_card_mutex);
+
+    if (((g_recorder.state == RECORDER_STATE_RECORDING) || (g_recorder.state == RECORDER_STATE_FULL)) &&
+        (first_index >= 1u) && (first_index < g_recorder.next_index) &&
+        recorder_read_chunk_header(first_index, &header)) {
+        uint32_t low  = first_index + 1u;
+        uint32_t high = g_recorder.next_index;
+
+        // Session numbers only increase along the card.
+        while (low < high) {
+            const uint32_t               MIDDLE = low + (high - low) / 2u;
+            struct recorder_chunk_header middle_header;
+
+            if (recorder_read_chunk_header(MIDDLE, &middle_header) && (middle_header.session == header.session)) {
+                low = MIDDLE + 1u;
+            } else {
+                high = MIDDLE;
+            }
+        }
+
+        p_session->session     = header.session;
+        p_session->first_index = first_index;
+        p_session->chunk_count = low - first_index;
+        b_found                = true;
+    }
+
+    chMtxUnlock(&g_recorder_card_mutex);
+    return b_found;
+}
+
+/**
+ * @brief Read sectors of a recorded chunk.
+ *
+ * @param index The index of the chunk.
+ * @param sector_offset The first sector to read, within the chunk.
+ * @param p_buffer A pointer to the buffer to fill, which the DMA can reach (not in the core coupled memory).
+ * @param sector_count The number of sectors to read.
+ * @return bool True, if the sectors were read.
+ */
+bool recorder_read(uint32_t index, uint32_t sector_offset, uint8_t* p_buffer, uint32_t sector_count) {
+    ASSERT_PTR_NOT_NULL(p_buffer);
+
+    bool b_read = false;
+
+    chMtxLock(&g_recorder_card_mutex);
+
+    if (((g_recorder.state == RECORDER_STATE_RECORDING) || (g_recorder.state == RECORDER_STATE_FULL)) &&
+        (index < g_recorder.next_index) && ((sector_offset + sector_count) <= RECORDER_CHUNK_SECTORS)) {
+        b_read = (sdcRead(&SDCD1, index * RECORDER_CHUNK_SECTORS + sector_offset, p_buffer, sector_count) ==
+                  HAL_SUCCESS);
+    }
+
+    chMtxUnlock(&g_recorder_card_mutex);
+    return b_read;
+}
+
+/**
+ * @brief Report the state of the recorder, and its statistics.
+ *
+ * @param p_output A pointer to the report output.
+ */
+void recorder_report(const struct report_output* p_output) {
+    ASSERT_PTR_NOT_NULL(p_output);
+
+    const enum recorder_state STATE = recorder_get_state();
+
+    report_printf(p_output, "Recorder: %s.\n", G_RECORDER_STATE_NAMES[STATE]);
+
+    if ((STATE == RECORDER_STATE_RECORDING) || (STATE == RECORDER_STATE_FULL)) {
+        report_printf(p_output, "Session %lu, %lu of %lu chunks of %lu bytes used.\n",
+                      (unsigned long)g_recorder.session, (unsigned long)g_recorder.next_index,
+                      (unsigned long)g_recorder.chunk_count, (unsigned long)RECORDER_CHUNK_SIZE);
+    }
+
+    report_printf(p_output, "Chunks: %lu written, %lu dropped, %lu write errors, longest write %lu ms.\n",
+                  (unsigned long)g_recorder.written_count, (unsigned long)g_recorder.dropped_count,
+                  (unsigned long)g_recorder.error_count, (unsigned long)g_recorder.max_write_time_ms);
+    report_printf(p_output, "UART: %lu baud, %lu overruns.\n", (unsigned long)g_recorder_uart_config.speed,
+                  (unsigned long)g_recorder.uart_overrun_count);
+}
+
+/**
+ * @brief Start the card and the target serial port, and the recorder threads. Recording starts, when a formatted card
+ * is inserted.
+ */
+void recorder_init(void) {
+    chMBObjectInit(&g_recorder.free_buffers, g_recorder.free_messages, RECORDER_BUFFER_COUNT);
+    chMBObjectInit(&g_recorder.full_buffers, g_recorder.full_messages, RECORDER_BUFFER_COUNT);
+
+    for (size_t buffer_index = 0u; buffer_index < RECORDER_BUFFER_COUNT; buffer_index++) {
+        (void)chMBPostTimeout(&g_recorder.free_buffers, (msg_t)&g_recorder_buffers[buffer_index], TIME_IMMEDIATE);
+    }
+
+    g_recorder.state              = RECORDER_STATE_NO_CARD;
+    g_recorder_uart_config.speed = config_get_u32(CONFIG_KEY_UART_BAUD_RATE);
+
+    sdcStart(&SDCD1, &G_RECORDER_SDC_CONFIG);
+    sdStart(&SD2, &g_recorder_uart_config);
+
+    chThdCreateStatic(wa_recorder_writer, sizeof(wa_recorder_writer), LOWPRIO + 1, recorder_writer, NULL);
+    chThdCreateStatic(wa_recorder_filler, sizeof(wa_recorder_filler), LOWPRIO + 1, recorder_filler, NULL);
+}
+
+#endif  // RECORDER_ENABLE == TRUE
+
+/**
+ * @}
+ */
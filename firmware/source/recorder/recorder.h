@@ -0,0 +1,137 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The SD card recorder module headers.
+ *
+ * @addtogroup recorder
+ * @{
+ */
+
+#ifndef SOURCE_RECORDER_RECORDER_H_
+#define SOURCE_RECORDER_RECORDER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/common.h"
+#include "common/report.h"
+
+/**
+ * @brief Enables the SD card recorder. It requires the SDC and serial drivers, so the host build leaves it disabled.
+ */
+#ifndef RECORDER_ENABLE
+#define RECORDER_ENABLE FALSE
+#endif
+
+/**
+ * @brief The size of a card sector.
+ */
+#define RECORDER_SECTOR_SIZE 512u
+
+/**
+ * @brief The number of sectors in a chunk, the unit in which the card is written. Chunks are aligned to their size on
+ * the card.
+ */
+#define RECORDER_CHUNK_SECTORS 16u
+
+/**
+ * @brief The size of a chunk.
+ */
+#define RECORDER_CHUNK_SIZE (RECORDER_CHUNK_SECTORS * RECORDER_SECTOR_SIZE)
+
+/**
+ * @brief The magic values of the volume header (chunk 0), and of the data chunks that follow it.
+ */
+#define RECORDER_VOLUME_MAGIC 0x56504D42u  // "BMPV"
+#define RECORDER_CHUNK_MAGIC  0x43504D42u  // "BMPC"
+
+/**
+ * @brief The version of the container format. Increment on changes.
+ */
+#define RECORDER_VERSION 1u
+
+/**
+ * @brief The UART baud rate of the target serial port, if not configured otherwise.
+ */
+#define RECORDER_UART_BAUD_RATE 115200u
+
+/**
+ * @brief The streams in a recording. The values are part of the container format.
+ */
+enum recorder_stream {
+    RECORDER_STREAM_TRACE = 1u,  ///< The event trace, in the format of the network trace drain.
+    RECORDER_STREAM_POWER = 2u,  ///< The power profile, in the format of the network power profile drain.
+    RECORDER_STREAM_UART  = 3u,  ///< The bytes that the target sent on its serial port.
+};
+
+/**
+ * @brief The states of the recorder.
+ */
+enum recorder_state {
+    RECORDER_STATE_NO_CARD,      ///< No card is inserted, or it could not be connected.
+    RECORDER_STATE_UNFORMATTED,  ///< The card holds no recorder volume, and is left alone until it is formatted.
+    RECORDER_STATE_RECORDING,    ///< Streams are appended to the card.
+    RECORDER_STATE_FULL,         ///< The card is full.
+    RECORDER_STATE_ERROR,        ///< Writing failed. The card is connected again, after it was reinserted.
+};
+
+/**
+ * @brief The volume header in the first sector of the card. All fields are little endian.
+ */
+struct __attribute__((packed)) recorder_volume_header {
+    uint32_t magic;          ///< Must be \a RECORDER_VOLUME_MAGIC.
+    uint16_t version;        ///< The container format version, \a RECORDER_VERSION.
+    uint16_t chunk_sectors;  ///< The number of sectors in a chunk.
+    uint32_t volume;         ///< Identifies the chunks of this volume. It changes with every format.
+    uint32_t crc;            ///< The CRC-32 of the fields above.
+};
+
+/**
+ * @brief The header at the start of each data chunk, followed by records. Chunk n starts at sector
+ * n * \a RECORDER_CHUNK_SECTORS. A chunk is valid, if its magic, volume and index match, and its CRC is correct. Valid
+ * chunks follow each other from chunk 1 on, such that the first invalid one marks the end of the recording.
+ */
+struct __attribute__((packed)) recorder_chunk_header {
+    uint32_t magic;           ///< Must be \a RECORDER_CHUNK_MAGIC.
+    uint32_t volume;          ///< The volume, to which the chunk belongs.
+    uint32_t index;           ///< The index of the chunk on the card.
+    uint32_t session;         ///< The recording session, which starts with every boot or format.
+    uint32_t uptime_ms;       ///< The uptime of the probe, when the chunk was written.
+    uint32_t payload_length;  ///< The length of the records after the header. The rest of the chunk is zero.
+    uint32_t crc;             ///< The CRC-32 of the whole chunk, while this field is zero.
+};
+
+/**
+ * @brief The header of a record in a chunk, followed by its data. Records do not cross chunk boundaries. The data of a
+ * stream in a session, concatenated, forms the stream - the first record of the trace and power streams carries
+ * their stream header.
+ */
+struct __attribute__((packed)) recorder_record_header {
+    uint16_t stream;  ///< The stream (see \a enum recorder_stream).
+    uint16_t length;  ///< The length of the data.
+};
+
+/**
+ * @brief A range of chunks that belong to a session.
+ */
+struct recorder_session {
+    uint32_t session;      ///< The session number.
+    uint32_t first_index;  ///< The index of the first chunk.
+    uint32_t chunk_count;  ///< The number of chunks.
+};
+
+#if RECORDER_ENABLE == TRUE
+void                recorder_init(void);
+enum recorder_state recorder_get_state(void);
+bool                recorder_format(void);
+bool                recorder_find_session(uint32_t first_index, struct recorder_session* p_session);
+bool                recorder_read(uint32_t index, uint32_t sector_offset, uint8_t* p_buffer, uint32_t sector_count);
+void                recorder_report(const struct report_output* p_output);
+#endif
+
+#endif  // SOURCE_RECORDER_RECORDER_H_
+
+/**
+ * @}
+ */
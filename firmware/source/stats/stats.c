@@ -0,0 +1,291 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The runtime statistics module.
+ * @details Reports the network interface, lwIP protocol and memory counters, per-thread CPU time and stack usage, and
+ * heap usage to a report output - the GDB console, or the shell. All counters are maintained by lwIP and ChibiOS
+ * anyway - nothing is added to the hot path. The lwIP counters are copied in a short critical section, and formatted
+ * afterwards.
+ *
+ * @addtogroup stats
+ * @{
+ */
+
+#include "stats.h"
+
+#include <string.h>
+
+#include "lwip/ip4_addr.h"
+#include "lwip/memp.h"
+#include "lwip/netif.h"
+#include "lwip/stats.h"
+#include "network/network_startup.h"
+
+#if STATS_ENABLE == TRUE
+
+/**
+ * @brief The names of the lwIP memory pools, in the order of \a memp_t.
+ */
+static const char* const G_STATS_MEMP_NAMES[] = {
+#define LWIP_MEMPOOL(_name, _num, _size, _desc) #_name,
+#include "lwip/priv/memp_std.h"
+};
+
+/**
+ * @brief The names of the thread states.
+ */
+static const char* const G_STATS_THREAD_STATES[] = {CH_STATE_NAMES};
+
+/**
+ * @brief A copy of the lwIP statistics, which is formatted outside of the critical section. Static, in order to keep
+ * the stack usage of the calling thread low.
+ */
+static struct stats_ g_stats_lwip;
+
+/**
+ * @brief A copy of the lwIP memory pool statistics.
+ */
+static struct stats_mem g_stats_memp[MEMP_MAX];
+
+/**
+ * @brief Guards the copies of the lwIP statistics, which the GDB session and the shell can report at the same time.
+ */
+static MUTEX_DECL(g_stats_mutex);
+
+/**
+ * @brief Report the counters of a protocol.
+ *
+ * @param p_output A pointer to the report output.
+ * @param p_name A pointer to the protocol name.
+ * @param p_proto A pointer to the protocol statistics.
+ */
+static void stats_report_proto(const struct report_output* p_output, const char* p_name,
+                               const struct stats_proto* p_proto) {
+    report_printf(p_output, "  %-5s xmit %lu recv %lu drop %lu chkerr %lu memerr %lu err %lu\n", p_name,
+                  (unsigned long)p_proto->xmit, (unsigned long)p_proto->recv, (unsigned long)p_proto->drop,
+                  (unsigned long)p_proto->chkerr, (unsigned long)p_proto->memerr, (unsigned long)p_proto->err);
+}
+
+/**
+ * @brief Report the lwIP protocol counters, and memory usage.
+ *
+ * @param p_output A pointer to the report output.
+ */
+void stats_report_lwip(const struct report_output* p_output) {
+    ASSERT_PTR_NOT_NULL(p_output);
+
+    chMtxLock(&g_stats_mutex);
+    chSysLock();
+    memcpy(&g_stats_lwip, &lwip_stats, sizeof(g_stats_lwip));
+
+    for (size_t pool_index = 0u; pool_index < MEMP_MAX; pool_index++) {
+        memcpy(&g_stats_memp[pool_index], lwip_stats.memp[pool_index], sizeof(g_stats_memp[pool_index]));
+    }
+    chSysUnlock();
+
+    report_printf(p_output, "lwIP:\n");
+    stats_report_proto(p_output, "link", &g_stats_lwip.link);
+    stats_report_proto(p_output, "ip", &g_stats_lwip.ip);
+    stats_report_proto(p_output, "udp", &g_stats_lwip.udp);
+    stats_report_proto(p_output, "tcp", &g_stats_lwip.tcp);
+    report_printf(p_output, "  tcp retransmitted segments %lu, failed connection attempts %lu\n",
+                  (unsigned long)g_stats_lwip.mib2.tcpretranssegs, (unsigned long)g_stats_lwip.mib2.tcpattemptfails);
+    report_printf(p_output, "  heap  used %lu max %lu avail %lu err %lu\n", (unsigned long)g_stats_lwip.mem.used,
+                  (unsigned long)g_stats_lwip.mem.max, (unsigned long)g_stats_lwip.mem.avail,
+                  (unsigned long)g_stats_lwip.mem.err);
+
+    for (size_t pool_index = 0u; pool_index < MEMP_MAX; pool_index++) {
+        const struct stats_mem* p_pool = &g_stats_memp[pool_index];
+
+        report_printf(p_output, "  %-16s used %lu max %lu avail %lu err %lu\n", G_STATS_MEMP_NAMES[pool_index],
+                      (unsigned long)p_pool->used, (unsigned long)p_pool->max, (unsigned long)p_pool->avail,
+                      (unsigned long)p_pool->err);
+    }
+
+    chMtxUnlock(&g_stats_mutex);
+}
+
+/**
+ * @brief The main thread stack limits, as provided by the ChibiOS linker rules.
+ */
+extern uint8_t __main_thread_stack_base__[];
+extern uint8_t __main_thread_stack_end__[];
+
+/**
+ * @brief Get the stack size of a thread.
+ * @details Thread structures are placed at the top of their working areas, so the distance to the working area base
+ * is the stack size. The main thread is the exception, as it runs on the stack that the startup code set up.
+ *
+ * @param p_thread A pointer to the thread.
+ * @return size_t The stack size in bytes.
+ */
+static size_t stats_get_stack_size(thread_t* p_thread) {
+    const uint8_t* p_base = (const uint8_t*)chThdGetWorkingAreaX(p_thread);
+
+    if (p_base == __main_thread_stack_base__) {
+        return (size_t)(__main_thread_stack_end__ - __main_thread_stack_base__);
+    }
+
+    return (size_t)((const uint8_t*)p_thread - p_base);
+}
+
+/**
+ * @brief Get the number of stack bytes that a thread never used.
+ * @details The stacks are filled with \a CH_DBG_STACK_FILL_VALUE on creation (\a CH_DBG_FILL_THREADS), so the unused
+ * part is the run of fill values at the stack base.
+ *
+ * @param p_thread A pointer to the thread.
+ * @param stack_size The stack size of the thread.
+ * @return size_t The number of unused bytes.
+ */
+static size_t stats_get_unused_stack_size(thread_t* p_thread, size_t stack_size) {
+    const uint8_t* p_base      = (const uint8_t*)chThdGetWorkingAreaX(p_thread);
+    size_t         unused_size = 0u;
+
+    while ((unused_size < stack_size) && (p_base[unused_size] == CH_DBG_STACK_FILL_VALUE)) {
+        unused_size++;
+    }
+
+    return unused_size;
+}
+
+/**
+ * @brief Report the CPU time and stack usage of all threads.
+ *
+ * @param p_output A pointer to the report output.
+ */
+void stats_report_threads(const struct report_output* p_output) {
+    ASSERT_PTR_NOT_NULL(p_output);
+
+    systime_t total_time = 0u;
+
+    for (thread_t* p_thread = chRegFirstThread(); p_thread != NULL; p_thread = chRegNextThread(p_thread)) {
+        total_time += p_thread->time;
+    }
+
+    report_printf(p_output, "Threads:\n  %-20s %4s %-8s %10s %6s %10s %10s\n", "name", "prio", "state",
+                  "time [ms]", "cpu %", "stack max", "stack size");
+
+    for (thread_t* p_thread = chRegFirstThread(); p_thread != NULL; p_thread = chRegNextThread(p_thread)) {
+        const size_t   STACK_SIZE  = stats_get_stack_size(p_thread);
+        const size_t   UNUSED_SIZE = stats_get_unused_stack_size(p_thread, STACK_SIZE);
+        const uint32_t CPU_PERMILLE =
+            (total_time > 0u) ? (uint32_t)(((uint64_t)p_thread->time * 1000u) / (uint64_t)total_time) : 0u;
+
+        report_printf(p_output, "  %-20s %4lu %-8s %10lu %4lu.%lu %10lu %10lu\n", chRegGetThreadNameX(p_thread),
+                      (unsigned long)p_thread->hdr.pqueue.prio, G_STATS_THREAD_STATES[p_thread->state],
+                      (unsigned long)TIME_I2MS(p_thread->time), (unsigned long)(CPU_PERMILLE / 10u),
+                      (unsigned long)(CPU_PERMILLE % 10u), (unsigned long)(STACK_SIZE - UNUSED_SIZE),
+                      (unsigned long)STACK_SIZE);
+    }
+}
+
+/**
+ * @brief Report the usage of the ChibiOS core allocator and heap.
+ *
+ * @param p_output A pointer to the report output.
+ */
+void stats_report_heap(const struct report_output* p_output) {
+    ASSERT_PTR_NOT_NULL(p_output);
+
+    size_t total_free_size   = 0u;
+    size_t largest_free_size = 0u;
+    size_t fragment_count    = chHeapStatus(NULL, &total_free_size, &largest_free_size);
+
+    report_printf(p_output, "Memory:\n  core free %lu\n  heap free %lu in %lu fragments, largest %lu\n",
+                  (unsigned long)chCoreGetStatusX(), (unsigned long)total_free_size, (unsigned long)fragment_count,
+                  (unsigned long)largest_free_size);
+}
+
+/**
+ * @brief Print a startup milestone.
+ *
+ * @param p_output A pointer to the report output.
+ * @param p_name A pointer to the milestone name.
+ * @param time_ms The milestone time in milliseconds, or \a NETWORK_STARTUP_PENDING.
+ */
+static void stats_report_milestone(const struct report_output* p_output, const char* p_name, uint32_t time_ms) {
+    if (time_ms == NETWORK_STARTUP_PENDING) {
+        report_printf(p_output, "  %-10s pending\n", p_name);
+    } else {
+        report_printf(p_output, "  %-10s %lu ms\n", p_name, (unsigned long)time_ms);
+    }
+}
+
+/**
+ * @brief Report the link state and the addresses of the network interface.
+ *
+ * @param p_output A pointer to the report output.
+ */
+static void stats_report_interface(const struct report_output* p_output) {
+    struct netif netif;
+    char         address[IP4ADDR_STRLEN_MAX];
+    char         netmask[IP4ADDR_STRLEN_MAX];
+    char         gateway[IP4ADDR_STRLEN_MAX];
+
+    chSysLock();
+    const bool B_PRESENT = (netif_default != NULL) ? true : false;
+
+    if (B_PRESENT) {
+        memcpy(&netif, netif_default, sizeof(netif));
+    }
+    chSysUnlock();
+
+    if (!B_PRESENT) {
+        report_printf(p_output, "Interface:\n  not present\n");
+        return;
+    }
+
+    report_printf(p_output, "Interface:\n  %c%c%u %s, link %s\n", netif.name[0], netif.name[1], (unsigned int)netif.num,
+                  netif_is_up(&netif) ? "up" : "down", netif_is_link_up(&netif) ? "up" : "down");
+    report_printf(p_output, "  mac %02x:%02x:%02x:%02x:%02x:%02x\n", netif.hwaddr[0], netif.hwaddr[1], netif.hwaddr[2],
+                  netif.hwaddr[3], netif.hwaddr[4], netif.hwaddr[5]);
+    report_printf(p_output, "  address %s netmask %s gateway %s\n",
+                  ip4addr_ntoa_r(netif_ip4_addr(&netif), address, sizeof(address)),
+                  ip4addr_ntoa_r(netif_ip4_netmask(&netif), netmask, sizeof(netmask)),
+                  ip4addr_ntoa_r(netif_ip4_gw(&netif), gateway, sizeof(gateway)));
+#if LWIP_NETIF_HOSTNAME
+    report_printf(p_output, "  hostname %s\n", (netif.hostname != NULL) ? netif.hostname : "");
+#endif
+}
+
+/**
+ * @brief Report the network startup milestones, from the system start to accepting GDB connections, and the state of
+ * the network interface.
+ *
+ * @param p_output A pointer to the report output.
+ */
+void stats_report_network(const struct report_output* p_output) {
+    ASSERT_PTR_NOT_NULL(p_output);
+
+    struct network_startup_times times;
+
+    network_startup_get_times(&times);
+
+    report_printf(p_output, "Startup:\n");
+    stats_report_milestone(p_output, "link up", times.link_up_ms);
+    stats_report_milestone(p_output, "address", times.address_ms);
+    stats_report_milestone(p_output, "listening", times.listening_ms);
+    stats_report_milestone(p_output, "accepting", network_startup_get_accepting_ms(&times));
+    report_printf(p_output, "  address source %s\n", network_startup_get_source_name(times.source));
+    stats_report_interface(p_output);
+}
+
+/**
+ * @brief Report all runtime statistics.
+ *
+ * @param p_output A pointer to the report output.
+ */
+void stats_report(const struct report_output* p_output) {
+    stats_report_network(p_output);
+    stats_report_lwip(p_output);
+    stats_report_threads(p_output);
+    stats_report_heap(p_output);
+}
+
+#endif  // STATS_ENABLE == TRUE
+
+/**
+ * @}
+ */
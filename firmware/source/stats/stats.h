@@ -0,0 +1,37 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The runtime statistics module headers.
+ *
+ * @addtogroup stats
+ * @{
+ */
+
+#ifndef SOURCE_STATS_STATS_H_
+#define SOURCE_STATS_STATS_H_
+
+#include "common/common.h"
+#include "common/report.h"
+
+/**
+ * @brief Enables the runtime statistics report. It requires lwIP and the ChibiOS registry, so the host build
+ * leaves it disabled.
+ */
+#ifndef STATS_ENABLE
+#define STATS_ENABLE FALSE
+#endif
+
+#if STATS_ENABLE == TRUE
+void stats_report_network(const struct report_output* p_output);
+void stats_report_lwip(const struct report_output* p_output);
+void stats_report_threads(const struct report_output* p_output);
+void stats_report_heap(const struct report_output* p_output);
+void stats_report(const struct report_output* p_output);
+#endif
+
+#endif  // SOURCE_STATS_STATS_H_
+
+/**
+ * @}
+ */
@@ -0,0 +1,230 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The target power profiling module.
+ * @details Samples the target voltage on VREF_SENSE with ADC2 at \a POWER_PROFILE_SAMPLE_RATE_HZ, triggered by TIM3,
+ * such that the sample spacing does not depend on software. The DMA fills a circular buffer, whose halves serve as a
+ * double buffer - while one half is filled, the other one is decimated into records of mean, minimum and maximum
+ * voltage.
+ *
+ * Each half makes a block, which is stamped with the same time stamp counter as the event trace, for correlating the
+ * profile with target activity. Blocks are kept in a small ring, from which readers (the network drain and the
+ * recorder) take them, each at its own pace. Sampling only runs, while a reader is active.
+ *
+ * ADC1 samples the same pin for the target voltage monitoring at the same time. The capacitor at VREF_SENSE (C1)
+ * supplies the charge for both sampling capacitors.
+ *
+ * @addtogroup target_power
+ * @{
+ */
+
+#include "power_profile.h"
+
+#include <string.h>
+
+#include "ch.h"
+#include "common/memory.h"
+#include "hal.h"
+
+#if POWER_PROFILE_ENABLE == TRUE
+
+/**
+ * @brief The number of samples in a half of the sample buffer, which is decimated into a block.
+ */
+#define POWER_PROFILE_HALF_SAMPLE_COUNT (POWER_PROFILE_BLOCK_RECORD_COUNT * POWER_PROFILE_DECIMATION)
+
+/**
+ * @brief The counting frequency of the trigger timer.
+ */
+#define POWER_PROFILE_TIMER_FREQUENCY_HZ 1000000u
+
+/**
+ * @brief The external trigger selection of TIM3 TRGO for regular conversions.
+ */
+#define POWER_PROFILE_ADC_EXTSEL_TIM3_TRGO 8u
+
+/**
+ * @brief The sample buffer, which the DMA fills. It has to stay outside of the core coupled memory.
+ */
+static adcsample_t g_power_profile_samples[2u * POWER_PROFILE_HALF_SAMPLE_COUNT];
+
+/**
+ * @brief The ring of completed blocks.
+ */
+static struct power_profile_block g_power_profile_blocks[POWER_PROFILE_BLOCK_COUNT] MEMORY_CCM_NOINIT;
+
+/**
+ * @brief The state of the power profiling.
+ */
+static struct {
+    volatile uint32_t head;          ///< The number of blocks that were completed since the start.
+    uint32_t          sequence;      ///< The number of records that were completed since the start.
+    uint32_t          reader_count;  ///< The number of active readers. Sampling runs, while there is any.
+} g_power_profile;
+
+/**
+ * @brief Guards starting and stopping of sampling.
+ */
+static MUTEX_DECL(g_power_profile_mutex);
+
+static void power_profile_adc_cb(ADCDriver* p_adc_driver);
+
+/**
+ * @brief The configuration of the trigger timer. Its update event is the trigger output (TRGO).
+ */
+static const GPTConfig G_POWER_PROFILE_TIMER_CONFIG = {
+    .frequency = POWER_PROFILE_TIMER_FREQUENCY_HZ,
+    .callback  = NULL,
+    .cr2       = TIM_CR2_MMS_1,
+    .dier      = 0u,
+};
+
+/**
+ * @brief The conversion group. Each rising edge of TIM3 TRGO converts VREF_SENSE once.
+ */
+static const ADCConversionGroup G_POWER_PROFILE_GROUP = {
+    .circular     = true,
+    .num_channels = 1u,
+    .end_cb       = power_profile_adc_cb,
+    .error_cb     = NULL,
+    .cr1          = 0u,
+    .cr2          = ADC_CR2_EXTEN_RISING | ADC_CR2_EXTSEL_SRC(POWER_PROFILE_ADC_EXTSEL_TIM3_TRGO),
+    .smpr1        = ADC_SMPR1_SMP_AN10(ADC_SAMPLE_56),
+    .smpr2        = 0u,
+    .htr          = 0u,
+    .ltr          = 0u,
+    .sqr1         = 0u,
+    .sqr2         = 0u,
+    .sqr3         = ADC_SQR3_SQ1_N(ADC_CHANNEL_IN10),
+};
+
+/**
+ * @brief Decimate samples into a record.
+ *
+ * @param p_samples A pointer to \a POWER_PROFILE_DECIMATION samples.
+ * @param p_record A pointer to the record to fill.
+ */
+static void power_profile_decimate(const adcsample_t* p_samples, struct power_profile_record* p_record) {
+    uint32_t    sum = 0u;
+    adcsample_t min = UINT16_MAX;
+    adcsample_t max = 0u;
+
+    for (size_t sample_index = 0u; sample_index < POWER_PROFILE_DECIMATION; sample_index++) {
+        const adcsample_t SAMPLE = p_samples[sample_index];
+
+        sum += SAMPLE;
+        min = (SAMPLE < min) ? SAMPLE : min;
+        max = (SAMPLE > max) ? SAMPLE : max;
+    }
+
+    p_record->mean_mv = (uint16_t)target_voltage_convert_mv(sum, POWER_PROFILE_DECIMATION);
+    p_record->min_mv  = (uint16_t)target_voltage_convert_mv(min, 1u);
+    p_record->max_mv  = (uint16_t)target_voltage_convert_mv(max, 1u);
+}
+
+/**
+ * @brief Decimate the half of the sample buffer that was completed into the next block of the ring.
+ *
+ * @param p_adc_driver A pointer to the ADC driver.
+ */
+static void power_profile_adc_cb(ADCDriver* p_adc_driver) {
+    const adcsample_t*          p_samples = g_power_profile_samples;
+    struct power_profile_block* p_block   = &g_power_profile_blocks[g_power_profile.head % POWER_PROFILE_BLOCK_COUNT];
+
+    if (adcIsBufferComplete(p_adc_driver)) {
+        p_samples = &g_power_profile_samples[POWER_PROFILE_HALF_SAMPLE_COUNT];
+    }
+
+    p_block->sequence  = g_power_profile.sequence;
+    p_block->timestamp = (uint32_t)chSysGetRealtimeCounterX();
+
+    for (size_t record_index = 0u; record_index < POWER_PROFILE_BLOCK_RECORD_COUNT; record_index++) {
+        power_profile_decimate(&p_samples[record_index * POWER_PROFILE_DECIMATION], &p_block->records[record_index]);
+    }
+
+    g_power_profile.sequence += POWER_PROFILE_BLOCK_RECORD_COUNT;
+    g_power_profile.head++;
+}
+
+/**
+ * @brief Take the next block from the ring. If the reader fell behind, the oldest blocks are skipped - their loss shows
+ * in the sequence numbers.
+ *
+ * @param p_tail A pointer to the number of blocks that the reader took so far, as set by \a power_profile_start().
+ * @param p_block A pointer to the block to fill.
+ * @return bool True, if a block was taken.
+ */
+bool power_profile_read(uint32_t* p_tail, struct power_profile_block* p_block) {
+    ASSERT_PTR_NOT_NULL(p_tail);
+    ASSERT_PTR_NOT_NULL(p_block);
+
+    chSysLock();
+    const uint32_t HEAD = g_power_profile.head;
+
+    if ((HEAD - *p_tail) > POWER_PROFILE_BLOCK_COUNT) {
+        *p_tail = HEAD - POWER_PROFILE_BLOCK_COUNT;
+    }
+
+    if (*p_tail == HEAD) {
+        chSysUnlock();
+        return false;
+    }
+
+    memcpy(p_block, &g_power_profile_blocks[*p_tail % POWER_PROFILE_BLOCK_COUNT], sizeof(*p_block));
+    (*p_tail)++;
+    chSysUnlock();
+
+    return true;
+}
+
+/**
+ * @brief Add a reader, and start sampling, if it is the first one. Then, the block and record counts start from zero.
+ *
+ * @param p_tail A pointer to the number of blocks that the reader took, which is set to the next block to come.
+ */
+void power_profile_start(uint32_t* p_tail) {
+    ASSERT_PTR_NOT_NULL(p_tail);
+
+    chMtxLock(&g_power_profile_mutex);
+
+    if (g_power_profile.reader_count++ == 0u) {
+        g_power_profile.head     = 0u;
+        g_power_profile.sequence = 0u;
+
+        adcStartConversion(&ADCD2, &G_POWER_PROFILE_GROUP, g_power_profile_samples,
+                           ARRAY_LENGTH(g_power_profile_samples));
+        gptStartContinuous(&GPTD3, POWER_PROFILE_TIMER_FREQUENCY_HZ / POWER_PROFILE_SAMPLE_RATE_HZ);
+    }
+
+    *p_tail = g_power_profile.head;
+    chMtxUnlock(&g_power_profile_mutex);
+}
+
+/**
+ * @brief Remove a reader, and stop sampling, if it was the last one.
+ */
+void power_profile_stop(void) {
+    chMtxLock(&g_power_profile_mutex);
+
+    if ((g_power_profile.reader_count > 0u) && (--g_power_profile.reader_count == 0u)) {
+        gptStopTimer(&GPTD3);
+        adcStopConversion(&ADCD2);
+    }
+
+    chMtxUnlock(&g_power_profile_mutex);
+}
+
+/**
+ * @brief Start the ADC and the trigger timer drivers. Sampling starts with \a power_profile_start().
+ */
+void power_profile_init(void) {
+    adcStart(&ADCD2, NULL);
+    gptStart(&GPTD3, &G_POWER_PROFILE_TIMER_CONFIG);
+}
+
+#endif  // POWER_PROFILE_ENABLE == TRUE
+
+/**
+ * @}
+ */
@@ -0,0 +1,81 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The target power profiling module headers.
+ *
+ * @addtogroup target_power
+ * @{
+ */
+
+#ifndef SOURCE_TARGET_POWER_POWER_PROFILE_H_
+#define SOURCE_TARGET_POWER_POWER_PROFILE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/common.h"
+#include "target_voltage.h"
+
+/**
+ * @brief Enables the power profiling. It requires the ADC, a timer, and the target voltage monitoring, so the host
+ * build leaves it disabled.
+ */
+#ifndef POWER_PROFILE_ENABLE
+#define POWER_PROFILE_ENABLE FALSE
+#endif
+
+#if (POWER_PROFILE_ENABLE == TRUE) && (TARGET_VOLTAGE_ENABLE != TRUE)
+#error "The power profiling requires the target voltage monitoring."
+#endif
+
+/**
+ * @brief The sample rate of the target voltage.
+ */
+#define POWER_PROFILE_SAMPLE_RATE_HZ 40000u
+
+/**
+ * @brief The number of samples that are decimated into a record.
+ */
+#define POWER_PROFILE_DECIMATION 10u
+
+/**
+ * @brief The number of records in a block. A block is completed every 10 ms.
+ */
+#define POWER_PROFILE_BLOCK_RECORD_COUNT 40u
+
+/**
+ * @brief The number of blocks that are buffered for the reader. Older blocks are overwritten, if it falls behind.
+ */
+#define POWER_PROFILE_BLOCK_COUNT 8u
+
+/**
+ * @brief The target voltage over \a POWER_PROFILE_DECIMATION samples.
+ */
+struct __attribute__((packed)) power_profile_record {
+    uint16_t mean_mv;  ///< The mean voltage.
+    uint16_t min_mv;   ///< The lowest voltage.
+    uint16_t max_mv;   ///< The highest voltage.
+};
+
+/**
+ * @brief A block of consecutive records. All fields are little endian.
+ */
+struct __attribute__((packed)) power_profile_block {
+    uint32_t sequence;   ///< The number of the first record since the start of profiling. Gaps show lost blocks.
+    uint32_t timestamp;  ///< The time stamp counter (the same as for trace events), when the block was completed.
+    struct power_profile_record records[POWER_PROFILE_BLOCK_RECORD_COUNT];  ///< The records, oldest first.
+};
+
+#if POWER_PROFILE_ENABLE == TRUE
+void power_profile_init(void);
+void power_profile_start(uint32_t* p_tail);
+void power_profile_stop(void);
+bool power_profile_read(uint32_t* p_tail, struct power_profile_block* p_block);
+#endif
+
+#endif  // SOURCE_TARGET_POWER_POWER_PROFILE_H_
+
+/**
+ * @}
+ */
@@ -0,0 +1,302 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The target voltage monitoring module.
+ * @details Samples the target reference voltage on VREF_SENSE continuously with ADC1 and DMA, together with the
+ * internal reference, which compensates for the tolerance of the analog supply. The DMA fills a circular buffer, and
+ * each half of it is averaged, when it is complete - no thread and no CPU time is needed in between.
+ *
+ * The target counts as powered, when its voltage stays above \a TARGET_VOLTAGE_PRESENT_MV for
+ * \a TARGET_VOLTAGE_SETTLE_TIME_MS, and as unpowered below \a TARGET_VOLTAGE_ABSENT_MV. Power-ups are counted, such
+ * that the GDB session can attach again to a target that was power cycled.
+ *
+ * @addtogroup target_power
+ * @{
+ */
+
+#include "target_voltage.h"
+
+#include "ch.h"
+#include "hal.h"
+
+#if TARGET_VOLTAGE_ENABLE == TRUE
+
+/**
+ * @brief The number of conversion sequences in the sample buffer. Each half is averaged, which is about every 6 ms.
+ */
+#define TARGET_VOLTAGE_SEQUENCE_COUNT 256u
+
+/**
+ * @brief The channels of a conversion sequence.
+ */
+enum target_voltage_channel {
+    TARGET_VOLTAGE_CHANNEL_SENSE,    ///< VREF_SENSE (PC0, ADC123_IN10).
+    TARGET_VOLTAGE_CHANNEL_VREFINT,  ///< The internal reference.
+    TARGET_VOLTAGE_CHANNEL_COUNT
+};
+
+/**
+ * @brief The factory calibration of the internal reference, taken at an analog supply of
+ * \a TARGET_VOLTAGE_VREFINT_CAL_MV.
+ */
+#define TARGET_VOLTAGE_VREFINT_CAL    (*(const uint16_t*)0x1FFF7A2Au)
+#define TARGET_VOLTAGE_VREFINT_CAL_MV 3300u
+
+/**
+ * @brief The full scale value of the ADC.
+ */
+#define TARGET_VOLTAGE_FULL_SCALE 4095u
+
+/**
+ * @brief The time after an ADC error, after which the conversion is started again.
+ */
+#define TARGET_VOLTAGE_RESTART_DELAY_MS 10u
+
+/**
+ * @brief The interval, at which a thread checks for the target to power up.
+ */
+#define TARGET_VOLTAGE_POLL_INTERVAL_MS 10u
+
+/**
+ * @brief The sample buffer, which the DMA fills. It has to stay outside of the core coupled memory.
+ */
+static adcsample_t g_target_voltage_samples[TARGET_VOLTAGE_SEQUENCE_COUNT * TARGET_VOLTAGE_CHANNEL_COUNT];
+
+/**
+ * @brief The state of the target voltage monitoring.
+ */
+static struct {
+    volatile uint32_t voltage_mv;      ///< The last averaged target voltage.
+    volatile uint32_t supply_mv;       ///< The last averaged analog supply voltage.
+    volatile bool     b_present;       ///< True, if the target counts as powered.
+    volatile uint32_t power_up_count;  ///< The number of times that the target powered up.
+    volatile uint32_t error_count;     ///< The number of ADC errors.
+    bool              b_settling;      ///< True, if the voltage is above the threshold, but not for long enough yet.
+    systime_t         settle_start;    ///< The time, at which the voltage rose above the threshold.
+    virtual_timer_t   restart_timer;   ///< Starts the conversion again, after an error.
+} g_target_voltage;
+
+static void target_voltage_adc_cb(ADCDriver* p_adc_driver);
+static void target_voltage_adc_error_cb(ADCDriver* p_adc_driver, adcerror_t error);
+
+/**
+ * @brief The conversion group. Without an external trigger, the ADC converts continuously. A sequence takes 984 ADC
+ * clock cycles (about 47 us).
+ */
+static const ADCConversionGroup G_TARGET_VOLTAGE_GROUP = {
+    .circular     = true,
+    .num_channels = TARGET_VOLTAGE_CHANNEL_COUNT,
+    .end_cb       = target_voltage_adc_cb,
+    .error_cb     = target_voltage_adc_error_cb,
+    .cr1          = 0u,
+    .cr2          = ADC_CR2_SWSTART,
+    .smpr1        = ADC_SMPR1_SMP_AN10(ADC_SAMPLE_480) | ADC_SMPR1_SMP_VREF(ADC_SAMPLE_480),
+    .smpr2        = 0u,
+    .htr          = 0u,
+    .ltr          = 0u,
+    .sqr1         = 0u,
+    .sqr2         = 0u,
+    .sqr3         = ADC_SQR3_SQ1_N(ADC_CHANNEL_IN10) | ADC_SQR3_SQ2_N(ADC_CHANNEL_VREFINT),
+};
+
+/**
+ * @brief Convert VREF_SENSE samples of any ADC to the target voltage, based on the last measured analog supply.
+ *
+ * @param sample_sum The sum of the samples.
+ * @param sample_count The number of samples.
+ * @return uint32_t The average target voltage in mV.
+ */
+uint32_t target_voltage_convert_mv(uint32_t sample_sum, uint32_t sample_count) {
+    const uint64_t NUMERATOR = (uint64_t)sample_sum * g_target_voltage.supply_mv * TARGET_VOLTAGE_DIVIDER_NUMERATOR;
+    const uint64_t DENOMINATOR =
+        (uint64_t)sample_count * TARGET_VOLTAGE_FULL_SCALE * TARGET_VOLTAGE_DIVIDER_DENOMINATOR;
+
+    return (sample_count > 0u) ? (uint32_t)(NUMERATOR / DENOMINATOR) : 0u;
+}
+
+/**
+ * @brief Update the power state of the target with a new voltage. Called from the ADC interrupt.
+ *
+ * @param voltage_mv The target voltage.
+ */
+static void target_voltage_update(uint32_t voltage_mv) {
+    g_target_voltage.voltage_mv = voltage_mv;
+
+    if (g_target_voltage.b_present) {
+        g_target_voltage.b_present = (voltage_mv >= TARGET_VOLTAGE_ABSENT_MV) ? true : false;
+        return;
+    }
+
+    if (voltage_mv < TARGET_VOLTAGE_PRESENT_MV) {
+        g_target_voltage.b_settling = false;
+        return;
+    }
+
+    if (!g_target_voltage.b_settling) {
+        g_target_voltage.b_settling   = true;
+        g_target_voltage.settle_start = chVTGetSystemTimeX();
+        return;
+    }
+
+    if (chVTTimeElapsedSinceX(g_target_voltage.settle_start) >= TIME_MS2I(TARGET_VOLTAGE_SETTLE_TIME_MS)) {
+        g_target_voltage.b_settling = false;
+        g_target_voltage.b_present  = true;
+        g_target_voltage.power_up_count++;
+    }
+}
+
+/**
+ * @brief Average the half of the sample buffer that was completed, and update the target voltage.
+ *
+ * @param p_adc_driver A pointer to the ADC driver.
+ */
+static void target_voltage_adc_cb(ADCDriver* p_adc_driver) {
+    const size_t       HALF_COUNT  = TARGET_VOLTAGE_SEQUENCE_COUNT / 2u;
+    const adcsample_t* p_samples   = g_target_voltage_samples;
+    uint32_t           sense_sum   = 0u;
+    uint32_t           vrefint_sum = 0u;
+
+    if (adcIsBufferComplete(p_adc_driver)) {
+        p_samples = &g_target_voltage_samples[HALF_COUNT * TARGET_VOLTAGE_CHANNEL_COUNT];
+    }
+
+    for (size_t sequence_index = 0u; sequence_index < HALF_COUNT; sequence_index++) {
+        sense_sum += p_samples[TARGET_VOLTAGE_CHANNEL_SENSE];
+        vrefint_sum += p_samples[TARGET_VOLTAGE_CHANNEL_VREFINT];
+        p_samples += TARGET_VOLTAGE_CHANNEL_COUNT;
+    }
+
+    if (vrefint_sum == 0u) {
+        return;
+    }
+
+    // The internal reference reads VREFINT_CAL at an analog supply of VREFINT_CAL_MV, and scales inversely with it.
+    g_target_voltage.supply_mv =
+        (uint32_t)(((uint64_t)TARGET_VOLTAGE_VREFINT_CAL_MV * TARGET_VOLTAGE_VREFINT_CAL * HALF_COUNT) / vrefint_sum);
+
+    target_voltage_update(target_voltage_convert_mv(sense_sum, HALF_COUNT));
+}
+
+/**
+ * @brief Start the continuous conversion.
+ * @note Called from a locked state.
+ */
+static void target_voltage_start_conversion(void) {
+    adcStartConversionI(&ADCD1, &G_TARGET_VOLTAGE_GROUP, g_target_voltage_samples, TARGET_VOLTAGE_SEQUENCE_COUNT);
+}
+
+/**
+ * @brief Start the conversion again, after an error.
+ *
+ * @param p_timer A pointer to the restart timer (unused).
+ * @param p_arg A pointer to arguments (unused).
+ */
+static void target_voltage_restart_cb(virtual_timer_t* p_timer, void* p_arg) {
+    (void)p_timer;
+    (void)p_arg;
+
+    chSysLockFromISR();
+    target_voltage_start_conversion();
+    chSysUnlockFromISR();
+}
+
+/**
+ * @brief Count an ADC error. The driver stops the conversion, so it is started again after a short delay.
+ *
+ * @param p_adc_driver A pointer to the ADC driver (unused).
+ * @param error The error (unused).
+ */
+static void target_voltage_adc_error_cb(ADCDriver* p_adc_driver, adcerror_t error) {
+    (void)p_adc_driver;
+    (void)error;
+
+    g_target_voltage.error_count++;
+
+    chSysLockFromISR();
+    chVTSetI(&g_target_voltage.restart_timer, TIME_MS2I(TARGET_VOLTAGE_RESTART_DELAY_MS), target_voltage_restart_cb,
+             NULL);
+    chSysUnlockFromISR();
+}
+
+/**
+ * @brief Get the averaged target voltage.
+ *
+ * @return uint32_t The target voltage in mV.
+ */
+uint32_t target_voltage_get_mv(void) { return g_target_voltage.voltage_mv; }
+
+/**
+ * @brief Check, if the target is powered.
+ *
+ * @return bool True, if the target is powered.
+ */
+bool target_voltage_is_present(void) { return g_target_voltage.b_present; }
+
+/**
+ * @brief Get the number of times that the target powered up. A change shows, that the target was power cycled.
+ *
+ * @return uint32_t The power-up count.
+ */
+uint32_t target_voltage_get_power_up_count(void) { return g_target_voltage.power_up_count; }
+
+/**
+ * @brief Wait for the target to be powered.
+ *
+ * @param timeout_ms The time to wait at most.
+ * @return bool True, if the target is powered.
+ */
+bool target_voltage_wait_present(uint32_t timeout_ms) {
+    const systime_t START = chVTGetSystemTimeX();
+
+    while (!target_voltage_is_present()) {
+        if (chVTTimeElapsedSinceX(START) >= TIME_MS2I(timeout_ms)) {
+            return false;
+        }
+
+        chThdSleepMilliseconds(TARGET_VOLTAGE_POLL_INTERVAL_MS);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Report the target voltage, and the power state.
+ *
+ * @param p_output A pointer to the report output.
+ */
+void target_voltage_report(const struct report_output* p_output) {
+    ASSERT_PTR_NOT_NULL(p_output);
+
+    const uint32_t VOLTAGE_MV = target_voltage_get_mv();
+
+    report_printf(p_output, "Target voltage %lu.%02lu V, %s, powered up %lu times.\n",
+                  (unsigned long)(VOLTAGE_MV / 1000u), (unsigned long)((VOLTAGE_MV % 1000u) / 10u),
+                  target_voltage_is_present() ? "powered" : "unpowered",
+                  (unsigned long)target_voltage_get_power_up_count());
+
+    if (g_target_voltage.error_count > 0u) {
+        report_printf(p_output, "%lu ADC errors.\n", (unsigned long)g_target_voltage.error_count);
+    }
+}
+
+/**
+ * @brief Start the target voltage monitoring.
+ */
+void target_voltage_init(void) {
+    chVTObjectInit(&g_target_voltage.restart_timer);
+    palSetPadMode(GPIOC, GPIOC_VREF_SENSE, PAL_MODE_INPUT_ANALOG);
+
+    adcStart(&ADCD1, NULL);
+    adcSTM32EnableTSVREFE();
+
+    chSysLock();
+    target_voltage_start_conversion();
+    chSysUnlock();
+}
+
+#endif  // TARGET_VOLTAGE_ENABLE == TRUE
+
+/**
+ * @}
+ */
@@ -0,0 +1,74 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The target voltage monitoring module headers.
+ *
+ * @addtogroup target_power
+ * @{
+ */
+
+#ifndef SOURCE_TARGET_POWER_TARGET_VOLTAGE_H_
+#define SOURCE_TARGET_POWER_TARGET_VOLTAGE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/common.h"
+#include "common/report.h"
+
+/**
+ * @brief Enables the target voltage monitoring. It requires the ADC, so the host build leaves it disabled.
+ */
+#ifndef TARGET_VOLTAGE_ENABLE
+#define TARGET_VOLTAGE_ENABLE FALSE
+#endif
+
+/**
+ * @brief The ratio of the target voltage divider in front of VREF_SENSE, as target voltage / sensed voltage. The
+ * divider is 5.1 kOhm over 10 kOhm (R36, R37).
+ */
+#ifndef TARGET_VOLTAGE_DIVIDER_NUMERATOR
+#define TARGET_VOLTAGE_DIVIDER_NUMERATOR 151u
+#endif
+#ifndef TARGET_VOLTAGE_DIVIDER_DENOMINATOR
+#define TARGET_VOLTAGE_DIVIDER_DENOMINATOR 100u
+#endif
+
+/**
+ * @brief The voltage, above which the target counts as powered.
+ */
+#define TARGET_VOLTAGE_PRESENT_MV 1000u
+
+/**
+ * @brief The voltage, below which the target counts as unpowered. Lower than \a TARGET_VOLTAGE_PRESENT_MV, for
+ * hysteresis.
+ */
+#define TARGET_VOLTAGE_ABSENT_MV 800u
+
+/**
+ * @brief The time, for which the target voltage has to stay above \a TARGET_VOLTAGE_PRESENT_MV, until the target counts
+ * as powered up. Lets the target supply and reset circuitry settle.
+ */
+#define TARGET_VOLTAGE_SETTLE_TIME_MS 50u
+
+/**
+ * @brief The time, for which an attach waits for the target to power up, before it is refused.
+ */
+#define TARGET_VOLTAGE_ATTACH_TIMEOUT_MS 500u
+
+#if TARGET_VOLTAGE_ENABLE == TRUE
+void     target_voltage_init(void);
+uint32_t target_voltage_get_mv(void);
+uint32_t target_voltage_convert_mv(uint32_t sample_sum, uint32_t sample_count);
+bool     target_voltage_is_present(void);
+uint32_t target_voltage_get_power_up_count(void);
+bool     target_voltage_wait_present(uint32_t timeout_ms);
+void     target_voltage_report(const struct report_output* p_output);
+#endif
+
+#endif  // SOURCE_TARGET_POWER_TARGET_VOLTAGE_H_
+
+/**
+ * @}
+ */
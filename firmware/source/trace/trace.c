@@ -0,0 +1,150 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The trace module.
+ * @details Keeps a binary log of events in a ring in CCM, which any thread or ISR writes to without locking (see
+ * \a trace_write). A reader follows the ring with its own tail index, and detects events that it lost, because they
+ * were overwritten before it could read them.
+ *
+ * When the system halts, e.g. on a failed assertion, the most recent events are saved to backup SRAM together with the
+ * halt reason, where they survive the following reset.
+ *
+ * @addtogroup trace
+ * @{
+ */
+
+#include "trace.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "common/crc.h"
+#include "common/memory.h"
+
+#if TRACE_ENABLE == TRUE
+
+/**
+ * @brief The trace ring.
+ */
+struct trace_ring g_trace_ring MEMORY_CCM;
+
+/**
+ * @brief The post-mortem trace, which is written when the system halts.
+ */
+static struct trace_post_mortem g_trace_post_mortem MEMORY_BACKUP_SRAM;
+
+/**
+ * @brief Read events from the trace.
+ * @details Stops at the first event that is still being written. Events that were overwritten before they were read
+ * are skipped, and counted as lost.
+ *
+ * @param p_tail A pointer to the index of the next event to read, which is updated.
+ * @param p_events A pointer to the array to fill with the events.
+ * @param max_count The maximum number of events to read.
+ * @param p_lost_count A pointer to the lost event counter, which is increased.
+ * @return size_t The number of events that were read.
+ */
+size_t trace_read(uint32_t* p_tail, struct trace_event* p_events, size_t max_count, uint32_t* p_lost_count) {
+    ASSERT_PTR_NOT_NULL(p_tail);
+    ASSERT_PTR_NOT_NULL(p_events);
+    ASSERT_PTR_NOT_NULL(p_lost_count);
+
+    const uint32_t HEAD  = __atomic_load_n(&g_trace_ring.head, __ATOMIC_ACQUIRE);
+    uint32_t       tail  = *p_tail;
+    size_t         count = 0u;
+
+    if ((HEAD - tail) > TRACE_EVENT_COUNT) {
+        // The writers lapped the reader.
+        *p_lost_count += HEAD - tail - TRACE_EVENT_COUNT;
+        tail = HEAD - TRACE_EVENT_COUNT;
+    }
+
+    while ((tail != HEAD) && (count < max_count)) {
+        const struct trace_event* p_slot   = &g_trace_ring.events[tail & (TRACE_EVENT_COUNT - 1u)];
+        const uint32_t            SEQUENCE = __atomic_load_n(&p_slot->sequence, __ATOMIC_ACQUIRE);
+
+        if ((SEQUENCE == 0u) || ((int32_t)(SEQUENCE - (tail + 1u)) < 0)) {
+            // The event is still being written.
+            break;
+        }
+
+        memcpy(&p_events[count], p_slot, sizeof(p_events[count]));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if ((SEQUENCE != (tail + 1u)) || (__atomic_load_n(&p_slot->sequence, __ATOMIC_RELAXED) != SEQUENCE)) {
+            // The event was overwritten by a newer one.
+            (*p_lost_count)++;
+        } else {
+            count++;
+        }
+
+        tail++;
+    }
+
+    *p_tail = tail;
+    return count;
+}
+
+/**
+ * @brief Calculate the CRC of the post-mortem trace.
+ *
+ * @return uint32_t The CRC.
+ */
+static uint32_t trace_get_post_mortem_crc(void) {
+    return crc_32(&g_trace_post_mortem, offsetof(struct trace_post_mortem, crc));
+}
+
+/**
+ * @brief Save the most recent events to backup SRAM. Called from the system halt hook, with interrupts disabled.
+ *
+ * @param p_reason A pointer to the halt reason, or NULL.
+ */
+void trace_save_post_mortem(const char* p_reason) {
+    trace_write(TRACE_ID_HALT, 0u, 0u);
+
+    uint32_t tail       = g_trace_ring.head - TRACE_POST_MORTEM_EVENT_COUNT;
+    uint32_t lost_count = 0u;
+
+    if (g_trace_ring.head < TRACE_POST_MORTEM_EVENT_COUNT) {
+        tail = 0u;
+    }
+
+    g_trace_post_mortem.magic = TRACE_POST_MORTEM_MAGIC;
+    g_trace_post_mortem.event_count =
+        trace_read(&tail, g_trace_post_mortem.events, TRACE_POST_MORTEM_EVENT_COUNT, &lost_count);
+
+    memset(g_trace_post_mortem.reason, 0, sizeof(g_trace_post_mortem.reason));
+
+    if (p_reason != NULL) {
+        strncpy(g_trace_post_mortem.reason, p_reason, sizeof(g_trace_post_mortem.reason) - 1u);
+    }
+
+    g_trace_post_mortem.crc = trace_get_post_mortem_crc();
+}
+
+/**
+ * @brief Get the post-mortem trace of the last halt.
+ *
+ * @return const struct trace_post_mortem* A pointer to the post-mortem trace, or NULL, if there is no valid one.
+ */
+const struct trace_post_mortem* trace_get_post_mortem(void) {
+    if ((g_trace_post_mortem.magic != TRACE_POST_MORTEM_MAGIC) ||
+        (g_trace_post_mortem.event_count > TRACE_POST_MORTEM_EVENT_COUNT) ||
+        (g_trace_post_mortem.crc != trace_get_post_mortem_crc())) {
+        return NULL;
+    }
+
+    return &g_trace_post_mortem;
+}
+
+/**
+ * @brief Discard the post-mortem trace.
+ */
+void trace_clear_post_mortem(void) { g_trace_post_mortem.magic = 0u; }
+
+#endif  // TRACE_ENABLE == TRUE
+
+/**
+ * @}
+ */
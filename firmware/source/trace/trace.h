@@ -0,0 +1,149 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The trace module headers.
+ *
+ * @addtogroup trace
+ * @{
+ */
+
+#ifndef SOURCE_TRACE_TRACE_H_
+#define SOURCE_TRACE_TRACE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/common.h"
+
+/**
+ * @brief Enables the event trace. When disabled, all trace points are compiled out.
+ */
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE FALSE
+#endif
+
+/**
+ * @brief The number of events in the trace ring. Must be a power of two.
+ */
+#define TRACE_EVENT_COUNT 512u
+
+/**
+ * @brief The number of most recent events that are saved to backup SRAM, when the system halts.
+ */
+#define TRACE_POST_MORTEM_EVENT_COUNT 128u
+
+/**
+ * @brief The maximum length of the halt reason that is saved with the post-mortem trace, including the terminator.
+ */
+#define TRACE_POST_MORTEM_REASON_LENGTH 64u
+
+/**
+ * @brief The magic value of a valid post-mortem trace.
+ */
+#define TRACE_POST_MORTEM_MAGIC 0x4D524F50u  // "PORM"
+
+/**
+ * @brief The trace event identifiers. The host decoder (tools/trace_decode.py) reads the names from here.
+ */
+enum trace_id {
+    TRACE_ID_NONE,               ///< An empty slot.
+    TRACE_ID_HALT,               ///< The system halted.
+    TRACE_ID_SESSION_LOCK,       ///< A GDB session was locked. arg0: transport.
+    TRACE_ID_SESSION_RELEASE,    ///< The GDB session was released.
+    TRACE_ID_NETWORK_RECEIVE,    ///< The network received data. arg0: length.
+    TRACE_ID_NETWORK_WRITE,      ///< The network starts writing data. arg0: length.
+    TRACE_ID_NETWORK_WRITTEN,    ///< The network finished writing data. arg0: length, arg1: lwIP error code.
+    TRACE_ID_USB_RECEIVE,        ///< The USB CDC interface received data. arg0: length.
+    TRACE_ID_USB_WRITE,          ///< The USB CDC interface starts writing data. arg0: length.
+    TRACE_ID_USB_WRITTEN,        ///< The USB CDC interface finished writing data. arg0: length, arg1: written length.
+    TRACE_ID_PACKET_COMPLETE,    ///< An input packet was completed. arg0: command character, arg1: length.
+    TRACE_ID_PACKET_CHECKSUM,    ///< An input packet had a checksum error.
+    TRACE_ID_PACKET_INTERRUPT,   ///< The client requested an interrupt.
+    TRACE_ID_PACKET_NACK,        ///< The client rejected the last packet, which is sent again.
+    TRACE_ID_PACKET_RETRANSMIT,  ///< A packet that was not acknowledged is sent again. arg0: attempt.
+    TRACE_ID_EXECUTED,           ///< A command was executed. arg0: command character.
+    TRACE_ID_TARGET_HALTED,      ///< A running target halted. arg0: halt reason, arg1: watch address.
+    TRACE_ID_TARGET_POWER_UP,    ///< The attached target powered up again. arg0: target number, arg1: power-up count.
+    TRACE_ID_USER,               ///< Free for temporary trace points during debugging. arg0, arg1: any.
+};
+
+/**
+ * @brief A trace event.
+ */
+struct trace_event {
+    volatile uint32_t sequence;   ///< One more than the index of the event in the trace. Zero, while being written.
+    uint32_t          timestamp;  ///< The realtime counter (DWT CYCCNT) value.
+    uint32_t          id;         ///< The event identifier (see \a enum trace_id).
+    uint32_t          arg0;       ///< The first argument.
+    uint32_t          arg1;       ///< The second argument.
+};
+
+/**
+ * @brief The trace ring.
+ */
+struct trace_ring {
+    volatile uint32_t  head;                       ///< The index of the next event to write. Only ever increases.
+    struct trace_event events[TRACE_EVENT_COUNT];  ///< The event slots, indexed by the event index modulo the count.
+};
+
+/**
+ * @brief A post-mortem trace, as saved in backup SRAM.
+ */
+struct trace_post_mortem {
+    uint32_t           magic;                                   ///< Must be \a TRACE_POST_MORTEM_MAGIC.
+    uint32_t           event_count;                             ///< The number of valid events.
+    char               reason[TRACE_POST_MORTEM_REASON_LENGTH];  ///< The halt reason.
+    struct trace_event events[TRACE_POST_MORTEM_EVENT_COUNT];   ///< The events, oldest first.
+    uint32_t           crc;                                     ///< The CRC over all preceding fields.
+};
+
+#if TRACE_ENABLE == TRUE
+
+extern struct trace_ring g_trace_ring;
+
+/**
+ * @brief Write an event to the trace. Can be called from any thread or ISR, and from critical sections.
+ * @details A slot is reserved by atomically incrementing the head, so concurrent writers never share a slot. The
+ * sequence number is invalidated first, and set last, such that readers can detect events that are incomplete, or
+ * were overwritten while reading.
+ *
+ * @param id The event identifier.
+ * @param arg0 The first argument.
+ * @param arg1 The second argument.
+ */
+static inline void trace_write(enum trace_id id, uint32_t arg0, uint32_t arg1) {
+    const uint32_t      INDEX   = __atomic_fetch_add(&g_trace_ring.head, 1u, __ATOMIC_RELAXED);
+    struct trace_event* p_event = &g_trace_ring.events[INDEX & (TRACE_EVENT_COUNT - 1u)];
+
+    __atomic_store_n(&p_event->sequence, 0u, __ATOMIC_RELAXED);
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+
+    p_event->timestamp = (uint32_t)chSysGetRealtimeCounterX();
+    p_event->id        = (uint32_t)id;
+    p_event->arg0      = arg0;
+    p_event->arg1      = arg1;
+
+    __atomic_store_n(&p_event->sequence, INDEX + 1u, __ATOMIC_RELEASE);
+}
+
+#define TRACE(_id, _arg0, _arg1) trace_write((_id), (uint32_t)(_arg0), (uint32_t)(_arg1))
+
+size_t                          trace_read(uint32_t* p_tail, struct trace_event* p_events, size_t max_count,
+                                           uint32_t* p_lost_count);
+void                            trace_save_post_mortem(const char* p_reason);
+const struct trace_post_mortem* trace_get_post_mortem(void);
+void                            trace_clear_post_mortem(void);
+
+#else
+
+#define TRACE(_id, _arg0, _arg1)
+
+#endif  // TRACE_ENABLE == TRUE
+
+#endif  // SOURCE_TRACE_TRACE_H_
+
+/**
+ * @}
+ */
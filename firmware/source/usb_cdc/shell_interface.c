@@ -3,7 +3,13 @@
 /**
  * @file
  * @brief   The shell interface module.
- * @details Allows communicating with the grinder via USB-CDC.
+ * @details Allows communicating with the probe via USB-CDC. The shell is an out-of-band channel for inspecting and
+ * tuning the probe, which also works when the network is saturated or misconfigured. Reports are shared with the GDB
+ * "monitor" commands (see common/report.h).
+ *
+ * The deepest command is "latency" - it holds a copy of the stage histograms and two line buffers, next to the
+ * formatting functions. The "threads" command shows the peak stack use of the shell thread, which is to be measured
+ * on the probe, before its stack size is reduced.
  *
  * @addtogroup shell_interface
  * @{
@@ -14,16 +20,289 @@
 #include <string.h>
 
 #include "chprintf.h"
+#include "common/memory.h"
+#include "common/report.h"
+#include "config/config.h"
+#include "perf/perf.h"
+#include "recorder/recorder.h"
 #include "shell.h"
+#include "stats/stats.h"
+#include "target_power/target_voltage.h"
 #include "usbcfg.h"
 
+/**
+ * @brief The maximum length of a report line on the shell, which fits a histogram line.
+ */
+#define SHELL_INTERFACE_LINE_LENGTH (PERF_REPORT_LINE_LENGTH + 2u)
+
+/**
+ * @brief The stack size of the shell thread.
+ */
+#define SHELL_INTERFACE_SHELL_STACK_SIZE 4096u
+
+#if (STATS_ENABLE == TRUE) || (PERF_ENABLE == TRUE) || (TARGET_VOLTAGE_ENABLE == TRUE) || (RECORDER_ENABLE == TRUE)
+/**
+ * @brief The report output callback of the shell. Line ends are converted to CR LF.
+ *
+ * @param p_context A pointer to the shell stream.
+ * @param p_format A pointer to the format string.
+ * @param arguments The format arguments.
+ */
+static void shell_interface_report_cb(void *p_context, const char *p_format, va_list arguments) {
+    BaseSequentialStream *p_stream = (BaseSequentialStream *)p_context;
+    char                  line[SHELL_INTERFACE_LINE_LENGTH];
+    size_t                length = (size_t)chvsnprintf(line, ARRAY_LENGTH(line), p_format, arguments);
+    size_t                start  = 0u;
+
+    length = (length < ARRAY_LENGTH(line)) ? length : (ARRAY_LENGTH(line) - 1u);
+
+    for (size_t index = 0u; index < length; index++) {
+        if (line[index] == '\n') {
+            streamWrite(p_stream, (const uint8_t *)&line[start], index - start);
+            streamWrite(p_stream, (const uint8_t *)"\r\n", 2u);
+            start = index + 1u;
+        }
+    }
+
+    streamWrite(p_stream, (const uint8_t *)&line[start], length - start);
+}
+
+/**
+ * @brief Get a report output, which writes to the shell.
+ *
+ * @param p_stream A pointer to the shell stream.
+ * @return struct report_output The report output.
+ */
+static struct report_output shell_interface_get_report_output(BaseSequentialStream *p_stream) {
+    const struct report_output OUTPUT = {.p_vprintf_cb = shell_interface_report_cb, .p_context = p_stream};
+
+    return OUTPUT;
+}
+#endif
+
+#if PERF_ENABLE == TRUE
+/**
+ * @brief Check, if the only argument of a shell command is "reset".
+ *
+ * @param argc The argument count.
+ * @param p_argv The list of argument string pointers.
+ * @return bool True, if a reset was requested.
+ */
+static bool shell_interface_is_reset(int argc, char *p_argv[]) {
+    return (argc == 1) && (0 == strcmp(p_argv[0], "reset"));
+}
+#endif
+
+#if STATS_ENABLE == TRUE
+/**
+ * @brief Show the network startup milestones, the link state and the addresses.
+ *
+ * @param p_stream A pointer to the shell stream.
+ * @param argc The argument count (unused).
+ * @param p_argv The list of argument string pointers (unused).
+ */
+static void shell_interface_net(BaseSequentialStream *p_stream, int argc, char *p_argv[]) {
+    (void)argc;
+    (void)p_argv;
+
+    const struct report_output OUTPUT = shell_interface_get_report_output(p_stream);
+
+    stats_report_network(&OUTPUT);
+}
+
+/**
+ * @brief Show the lwIP protocol counters, and memory pool usage.
+ *
+ * @param p_stream A pointer to the shell stream.
+ * @param argc The argument count (unused).
+ * @param p_argv The list of argument string pointers (unused).
+ */
+static void shell_interface_lwip(BaseSequentialStream *p_stream, int argc, char *p_argv[]) {
+    (void)argc;
+    (void)p_argv;
+
+    const struct report_output OUTPUT = shell_interface_get_report_output(p_stream);
+
+    stats_report_lwip(&OUTPUT);
+}
+
+/**
+ * @brief Show the CPU time and stack usage of all threads, and the heap usage.
+ *
+ * @param p_stream A pointer to the shell stream.
+ * @param argc The argument count (unused).
+ * @param p_argv The list of argument string pointers (unused).
+ */
+static void shell_interface_threads(BaseSequentialStream *p_stream, int argc, char *p_argv[]) {
+    (void)argc;
+    (void)p_argv;
+
+    const struct report_output OUTPUT = shell_interface_get_report_output(p_stream);
+
+    stats_report_threads(&OUTPUT);
+    stats_report_heap(&OUTPUT);
+}
+#endif
+
+#if PERF_ENABLE == TRUE
+/**
+ * @brief Show the execution time histograms of all GDB commands, or reset them with "perf reset".
+ *
+ * @param p_stream A pointer to the shell stream.
+ * @param argc The argument count.
+ * @param p_argv The list of argument string pointers.
+ */
+static void shell_interface_perf(BaseSequentialStream *p_stream, int argc, char *p_argv[]) {
+    if (shell_interface_is_reset(argc, p_argv)) {
+        perf_reset();
+        return;
+    }
+
+    const struct report_output OUTPUT = shell_interface_get_report_output(p_stream);
+
+    perf_report(&OUTPUT);
+}
+
+/**
+ * @brief Show the GDB request latency histograms per stage, or reset them with "latency reset".
+ *
+ * @param p_stream A pointer to the shell stream.
+ * @param argc The argument count.
+ * @param p_argv The list of argument string pointers.
+ */
+static void shell_interface_latency(BaseSequentialStream *p_stream, int argc, char *p_argv[]) {
+    if (shell_interface_is_reset(argc, p_argv)) {
+        perf_reset_stages();
+        return;
+    }
+
+    const struct report_output OUTPUT = shell_interface_get_report_output(p_stream);
+
+    perf_report_stages(&OUTPUT);
+}
+#endif
+
+#if TARGET_VOLTAGE_ENABLE == TRUE
+/**
+ * @brief Show the target voltage, and whether the target is powered.
+ *
+ * @param p_stream A pointer to the shell stream.
+ * @param argc The argument count (unused).
+ * @param p_argv The list of argument string pointers (unused).
+ */
+static void shell_interface_vtarget(BaseSequentialStream *p_stream, int argc, char *p_argv[]) {
+    (void)argc;
+    (void)p_argv;
+
+    const struct report_output OUTPUT = shell_interface_get_report_output(p_stream);
+
+    target_voltage_report(&OUTPUT);
+}
+#endif
+
+#if RECORDER_ENABLE == TRUE
+/**
+ * @brief Show the state of the SD card recorder, or format the card for recording with "recorder format", which
+ * discards all data on it.
+ *
+ * @param p_stream A pointer to the shell stream.
+ * @param argc The argument count.
+ * @param p_argv The list of argument string pointers.
+ */
+static void shell_interface_recorder(BaseSequentialStream *p_stream, int argc, char *p_argv[]) {
+    if (argc == 0) {
+        const struct report_output OUTPUT = shell_interface_get_report_output(p_stream);
+
+        recorder_report(&OUTPUT);
+    } else if ((argc == 1) && (0 == strcmp(p_argv[0], "format"))) {
+        chprintf(p_stream, "%s\r\n", recorder_format() ? "Formatted." : "No card, or formatting failed.");
+    } else {
+        chprintf(p_stream, "Usage: recorder [format]\r\n");
+    }
+}
+#endif
+
+#if CONFIG_ENABLE == TRUE
+/**
+ * @brief Show the settings of the configuration store, or change one with "config <name> <value>", or reset them with
+ * "config reset [<name>]".
+ *
+ * @param p_stream A pointer to the shell stream.
+ * @param argc The argument count.
+ * @param p_argv The list of argument string pointers.
+ */
+static void shell_interface_config(BaseSequentialStream *p_stream, int argc, char *p_argv[]) {
+    enum config_key key = CONFIG_KEY_COUNT;
+
+    if (argc == 0) {
+        struct config_usage usage;
+        char                value[CONFIG_STRING_SIZE];
+
+        for (size_t key_index = 0u; key_index < CONFIG_KEY_COUNT; key_index++) {
+            config_format((enum config_key)key_index, value, ARRAY_LENGTH(value));
+            chprintf(p_stream, "%-20s %s\r\n", config_get_name((enum config_key)key_index), value);
+        }
+
+        config_get_usage(&usage);
+        chprintf(p_stream, "Store: %lu of %lu bytes used, erased %lu times.\r\n", (unsigned long)usage.used_size,
+                 (unsigned long)usage.size, (unsigned long)usage.erase_count);
+    } else if ((argc == 1) && (0 == strcmp(p_argv[0], "reset"))) {
+        chprintf(p_stream, "%s\r\n", config_get_result_message(config_reset()));
+    } else if ((argc == 2) && (0 == strcmp(p_argv[0], "reset")) && config_find_key(p_argv[1], &key)) {
+        chprintf(p_stream, "%s\r\n", config_get_result_message(config_set(key, NULL)));
+    } else if ((argc == 2) && config_find_key(p_argv[0], &key)) {
+        chprintf(p_stream, "%s\r\n", config_get_result_message(config_set(key, p_argv[1])));
+    } else {
+        chprintf(p_stream, "Usage: config [<name> <value> | reset [<name>]]\r\n");
+    }
+}
+
+/**
+ * @brief Show the SWD clock frequency, or change it with "swd <frequency in Hz>". The setting is stored, and applies
+ * to the next target attach.
+ *
+ * @param p_stream A pointer to the shell stream.
+ * @param argc The argument count.
+ * @param p_argv The list of argument string pointers.
+ */
+static void shell_interface_swd(BaseSequentialStream *p_stream, int argc, char *p_argv[]) {
+    if (argc == 0) {
+        chprintf(p_stream, "SWD frequency %lu Hz\r\n", (unsigned long)config_get_u32(CONFIG_KEY_SWD_FREQUENCY_HZ));
+    } else if (argc == 1) {
+        chprintf(p_stream, "%s\r\n", config_get_result_message(config_set(CONFIG_KEY_SWD_FREQUENCY_HZ, p_argv[0])));
+    } else {
+        chprintf(p_stream, "Usage: swd [<frequency in Hz>]\r\n");
+    }
+}
+#endif
+
 /**
  * @brief Commands that can be called over the shell.
  */
-static const ShellCommand COMMANDS[] = {{NULL, NULL}};
+static const ShellCommand COMMANDS[] = {
+#if CONFIG_ENABLE == TRUE
+    {"config", shell_interface_config},
+    {"swd", shell_interface_swd},
+#endif
+#if STATS_ENABLE == TRUE
+    {"net", shell_interface_net},
+    {"lwip", shell_interface_lwip},
+    {"threads", shell_interface_threads},
+#endif
+#if PERF_ENABLE == TRUE
+    {"perf", shell_interface_perf},
+    {"latency", shell_interface_latency},
+#endif
+#if TARGET_VOLTAGE_ENABLE == TRUE
+    {"vtarget", shell_interface_vtarget},
+#endif
+#if RECORDER_ENABLE == TRUE
+    {"recorder", shell_interface_recorder},
+#endif
+    {NULL, NULL}};
 
-static THD_WORKING_AREA(wa_shell_interface_thread, 1024);
-static THD_WORKING_AREA(wa_shell_thread, 4096);
+static MEMORY_CCM_NOINIT THD_WORKING_AREA(wa_shell_interface_thread, 1024);
+static MEMORY_CCM_NOINIT THD_WORKING_AREA(wa_shell_thread, SHELL_INTERFACE_SHELL_STACK_SIZE);
 
 /**
  * @brief The shell interface thread.
@@ -0,0 +1,196 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The USB GDB transport module.
+ * @details Serves a GDB session on the USB CDC interface (e.g. "target extended-remote /dev/ttyACM0"), for probes that
+ * sit next to the host. The session engine is the same as for the network transports.
+ *
+ * Input is taken from the receive buffer queue of the CDC driver one USB transfer at a time, and handed to the session
+ * without copying it byte by byte. Output is collected in the transmit buffer queue, which is sent as full 64 byte
+ * packets, and pushed at the end of each reply. The CDC driver terminates transfers of a multiple of the packet size
+ * with a zero length packet, such that the host does not hold back the end of a reply.
+ *
+ * The first data locks the session. It is released, when the host drops DTR (closes the serial port), or the USB
+ * connection is reset or suspended.
+ *
+ * @addtogroup usb_gdb
+ * @{
+ */
+
+#include "usb_gdb.h"
+
+#include "common/memory.h"
+#include "gdb/gdb_session.h"
+#include "perf/perf.h"
+#include "trace/trace.h"
+#include "usbcfg.h"
+
+#if USB_GDB_ENABLE == TRUE
+
+#define USB_GDB_STACK_SIZE 2048u
+
+/**
+ * @brief The state of the USB transport.
+ */
+static struct usb_gdb {
+    SerialUSBDriver* p_serial_usb_driver;  ///< A pointer to the USB CDC driver.
+    bool             b_active;             ///< True, if this transport owns the GDB session.
+    bool             b_dtr;                ///< True, if the host asserted DTR, when the session was locked.
+} g_usb_gdb;
+
+/**
+ * @brief Write data to the transmit buffer queue.
+ *
+ * @param p_data A pointer to the data to write.
+ * @param size The size of the data.
+ * @param b_more True, if more data follows right away. Otherwise, a partially filled buffer is sent right away, instead
+ * of on the next start-of-frame.
+ * @return size_t The size of the data that was written in time.
+ */
+static size_t usb_gdb_write(const char* p_data, size_t size, bool b_more) {
+    output_buffers_queue_t* p_obqueue = &g_usb_gdb.p_serial_usb_driver->obqueue;
+    const size_t            WRITTEN_SIZE =
+        obqWriteTimeout(p_obqueue, (const uint8_t*)p_data, size, TIME_MS2I(USB_GDB_WRITE_TIMEOUT_MS));
+
+    if (!b_more) {
+        obqFlush(p_obqueue);
+    }
+
+    return WRITTEN_SIZE;
+}
+
+/**
+ * @brief Write GDB output to the host.
+ * @details Data that is followed by more right away stays in the transmit buffer queue, and is sent with the rest.
+ *
+ * @param p_data A pointer to the data to write.
+ * @param size The size of the data.
+ * @param b_more True, if more data follows right away.
+ * @return bool True, if all data was written in time.
+ */
+static bool usb_gdb_write_cb(char* p_data, size_t size, bool b_more) {
+    size_t written_size = 0u;
+
+    TRACE(TRACE_ID_USB_WRITE, size, 0u);
+    PERF_TRANSMIT(written_size = usb_gdb_write(p_data, size, b_more));
+    TRACE(TRACE_ID_USB_WRITTEN, size, written_size);
+
+    return (written_size == size) ? true : false;
+}
+
+/**
+ * @brief Release the GDB session, if this transport owns it.
+ */
+static void usb_gdb_release(void) {
+    if (!g_usb_gdb.b_active) {
+        return;
+    }
+
+    gdb_session_release();
+    g_usb_gdb.b_active = false;
+}
+
+/**
+ * @brief Lock the GDB session for this transport, if it does not own it yet.
+ *
+ * @return bool True, if this transport owns the session.
+ */
+static bool usb_gdb_lock(void) {
+    if (!g_usb_gdb.b_active) {
+        g_usb_gdb.b_active = gdb_session_lock(GDB_SESSION_TRANSPORT_USB_CDC, usb_gdb_write_cb);
+        g_usb_gdb.b_dtr    = usbcfg_is_dtr_set();
+    }
+
+    return g_usb_gdb.b_active;
+}
+
+/**
+ * @brief Serve GDB with the data of a received USB transfer, which is at the head of the receive buffer queue.
+ *
+ * @param p_ibqueue A pointer to the receive buffer queue.
+ */
+static void usb_gdb_serve(input_buffers_queue_t* p_ibqueue) {
+    const char*  p_data    = (const char*)p_ibqueue->ptr;
+    const size_t DATA_SIZE = (size_t)(p_ibqueue->top - p_ibqueue->ptr);
+
+    PERF_MARK(PERF_MARK_RECEIVED);
+    TRACE(TRACE_ID_USB_RECEIVE, DATA_SIZE, 0u);
+
+    if (!usb_gdb_lock()) {
+        // Session is already locked by another transport.
+        return;
+    }
+
+    size_t total_consumed_size = 0u;
+    while ((total_consumed_size < DATA_SIZE) && (gdb_session_get_state() == GDB_SESSION_STATE_ACTIVE)) {
+        total_consumed_size += gdb_session_handle(&p_data[total_consumed_size], DATA_SIZE - total_consumed_size);
+    }
+
+    if (gdb_session_get_state() == GDB_SESSION_STATE_ABORTED) {
+        usb_gdb_release();
+    }
+}
+
+/**
+ * @brief Poll a running target, and release the session, if the host closed the serial port. Hosts that never assert
+ * DTR keep the session until the USB connection goes down.
+ */
+static void usb_gdb_idle(void) {
+    if (!g_usb_gdb.b_active) {
+        return;
+    }
+
+    gdb_session_poll();
+
+    if ((gdb_session_get_state() == GDB_SESSION_STATE_ABORTED) || (g_usb_gdb.b_dtr && !usbcfg_is_dtr_set())) {
+        usb_gdb_release();
+    }
+}
+
+static MEMORY_CCM_NOINIT THD_WORKING_AREA(wa_usb_gdb_thread, USB_GDB_STACK_SIZE);
+
+/**
+ * @brief The USB GDB transport thread.
+ */
+static THD_FUNCTION(usb_gdb_thread, arg) {
+    (void)arg;
+    chRegSetThreadName("usb gdb");
+    usbcfg_init();
+
+    g_usb_gdb.p_serial_usb_driver    = get_serial_usb_driver();
+    input_buffers_queue_t* p_ibqueue = &g_usb_gdb.p_serial_usb_driver->ibqueue;
+
+    while (true) {
+        // Wake up regularly, for polling a running target.
+        const msg_t MSG = ibqGetFullBufferTimeout(p_ibqueue, TIME_MS2I(GDB_SESSION_POLL_INTERVAL_MS));
+
+        if (MSG == MSG_TIMEOUT) {
+            usb_gdb_idle();
+            continue;
+        }
+
+        if (MSG != MSG_OK) {
+            // The USB connection was reset or suspended, and the queue refuses data until it is configured again.
+            usb_gdb_release();
+            chThdSleepMilliseconds(GDB_SESSION_POLL_INTERVAL_MS);
+            continue;
+        }
+
+        usb_gdb_serve(p_ibqueue);
+        ibqReleaseEmptyBuffer(p_ibqueue);
+    }
+}
+
+/**
+ * @brief Starts the USB GDB transport thread, which also connects the USB device.
+ */
+void usb_gdb_start_thread(void) {
+    chThdCreateStatic(&wa_usb_gdb_thread, sizeof(wa_usb_gdb_thread), LOWPRIO + 2, usb_gdb_thread, NULL);
+}
+
+#endif  // USB_GDB_ENABLE == TRUE
+
+/**
+ * @}
+ */
@@ -0,0 +1,34 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The USB GDB transport module headers.
+ *
+ * @addtogroup usb_gdb
+ * @{
+ */
+
+#ifndef SOURCE_USB_CDC_USB_GDB_H_
+#define SOURCE_USB_CDC_USB_GDB_H_
+
+#include "common/common.h"
+
+/**
+ * @brief Enables the GDB transport on the USB CDC interface, which then no longer serves the shell.
+ */
+#ifndef USB_GDB_ENABLE
+#define USB_GDB_ENABLE FALSE
+#endif
+
+/**
+ * @brief The time, after which a write is given up, if the host does not read the serial port.
+ */
+#define USB_GDB_WRITE_TIMEOUT_MS 100u
+
+void usb_gdb_start_thread(void);
+
+#endif  // SOURCE_USB_CDC_USB_GDB_H_
+
+/**
+ * @}
+ */
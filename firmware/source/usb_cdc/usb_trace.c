@@ -0,0 +1,246 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The USB trace drain module.
+ * @details Streams the event trace on the bulk endpoint of the trace capture interface, next to the CDC interface, in
+ * the same format as the network trace drain (see network/network_trace.h and tools/trace_decode.py).
+ *
+ * A stream starts with the vendor request \a USB_TRACE_REQUEST_START, and ends with \a USB_TRACE_REQUEST_STOP, or when
+ * the USB connection goes down. A host that starts a new stream first stops the old one, and reads the endpoint until
+ * it runs dry. The transfer in progress is then the last one of the old stream, and the next one starts with a header.
+ *
+ * Events are sent in batches of full packets. Transfers of a multiple of the packet size are terminated with a zero
+ * length packet, such that the host returns the data right away.
+ *
+ * @addtogroup usb_trace
+ * @{
+ */
+
+#include "usb_trace.h"
+
+#include <string.h>
+
+#include "common/common.h"
+#include "common/memory.h"
+#include "network/network_trace.h"
+
+#if TRACE_ENABLE == TRUE
+
+#define USB_TRACE_STACK_SIZE       1024u
+#define USB_TRACE_BATCH_COUNT      64u
+#define USB_TRACE_POLL_INTERVAL_MS 10u
+
+/**
+ * @brief The state of the trace drain.
+ */
+static struct {
+    binary_semaphore_t start;        ///< Signaled, when the host starts a stream.
+    volatile uint32_t  generation;   ///< Counts the started streams, such that a restart ends the previous one.
+    volatile bool      b_streaming;  ///< True, if the host wants the stream.
+} g_usb_trace;
+
+/**
+ * @brief A section of the stream, for events.
+ */
+static struct __attribute__((packed)) {
+    struct network_trace_section section;                         ///< The section header.
+    struct trace_event           events[USB_TRACE_BATCH_COUNT];  ///< The events.
+} g_usb_trace_batch;
+
+/**
+ * @brief Check, if a stream is still wanted by the host.
+ *
+ * @param generation The generation of the stream.
+ * @return bool True, if the stream is still wanted.
+ */
+static bool usb_trace_is_current(uint32_t generation) {
+    return g_usb_trace.b_streaming && (generation == g_usb_trace.generation);
+}
+
+/**
+ * @brief Send data on the trace endpoint, and wait for its completion.
+ *
+ * @param generation The generation of the stream.
+ * @param p_data A pointer to the data to send.
+ * @param size The size of the data.
+ * @return bool True, if the data was sent, and the stream is still wanted.
+ */
+static bool usb_trace_transmit(uint32_t generation, const void* p_data, size_t size) {
+    if (!usb_trace_is_current(generation) || (size == 0u)) {
+        return usb_trace_is_current(generation);
+    }
+
+    if (usbTransmit(&USBD1, USB_TRACE_EP, (const uint8_t*)p_data, size) != MSG_OK) {
+        return false;
+    }
+
+    if ((size % USB_TRACE_PACKET_SIZE) == 0u) {
+        // Terminate the transfer, which would otherwise look like it continues.
+        return (usbTransmit(&USBD1, USB_TRACE_EP, (const uint8_t*)p_data, 0u) == MSG_OK) ? true : false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Send a section.
+ *
+ * @param generation The generation of the stream.
+ * @param type The section type.
+ * @param p_content A pointer to the section content.
+ * @param length The length of the section content.
+ * @return bool True, if the section was sent, and the stream is still wanted.
+ */
+static bool usb_trace_transmit_section(uint32_t generation, enum network_trace_section_type type, const void* p_content,
+                                       size_t length) {
+    const struct network_trace_section SECTION = {.type = (uint32_t)type, .length = (uint32_t)length};
+
+    return usb_trace_transmit(generation, &SECTION, sizeof(SECTION)) &&
+           usb_trace_transmit(generation, p_content, length);
+}
+
+/**
+ * @brief Send the stream header, and the post-mortem trace, if there is one.
+ *
+ * @param generation The generation of the stream.
+ * @return bool True, if the preamble was sent, and the stream is still wanted.
+ */
+static bool usb_trace_transmit_preamble(uint32_t generation) {
+    const struct network_trace_header HEADER = {
+        .magic             = NETWORK_TRACE_MAGIC,
+        .version           = NETWORK_TRACE_VERSION,
+        .event_size        = sizeof(struct trace_event),
+        .counter_frequency = STM32_SYSCLK,
+    };
+
+    if (!usb_trace_transmit(generation, &HEADER, sizeof(HEADER))) {
+        return false;
+    }
+
+    const struct trace_post_mortem* p_post_mortem = trace_get_post_mortem();
+
+    if (p_post_mortem == NULL) {
+        return true;
+    }
+
+    return usb_trace_transmit_section(generation, NETWORK_TRACE_SECTION_POST_MORTEM_REASON, p_post_mortem->reason,
+                                      strnlen(p_post_mortem->reason, sizeof(p_post_mortem->reason))) &&
+           usb_trace_transmit_section(generation, NETWORK_TRACE_SECTION_POST_MORTEM_EVENTS, p_post_mortem->events,
+                                      p_post_mortem->event_count * sizeof(struct trace_event));
+}
+
+/**
+ * @brief Stream the trace to the host, until it stops the stream, or the USB connection goes down.
+ *
+ * @param generation The generation of the stream.
+ */
+static void usb_trace_serve(uint32_t generation) {
+    if (!usb_trace_transmit_preamble(generation)) {
+        return;
+    }
+
+    // Start with the backlog that the ring still holds.
+    const uint32_t HEAD            = g_trace_ring.head;
+    uint32_t       tail            = (HEAD > TRACE_EVENT_COUNT) ? (HEAD - TRACE_EVENT_COUNT) : 0u;
+    uint32_t       lost_count      = 0u;
+    uint32_t       sent_lost_count = 0u;
+
+    while (usb_trace_is_current(generation)) {
+        size_t count = trace_read(&tail, g_usb_trace_batch.events, USB_TRACE_BATCH_COUNT, &lost_count);
+
+        if (lost_count != sent_lost_count) {
+            const uint32_t NEWLY_LOST_COUNT = lost_count - sent_lost_count;
+
+            if (!usb_trace_transmit_section(generation, NETWORK_TRACE_SECTION_LOST, &NEWLY_LOST_COUNT,
+                                            sizeof(NEWLY_LOST_COUNT))) {
+                return;
+            }
+
+            sent_lost_count = lost_count;
+        }
+
+        if (count == 0u) {
+            chThdSleepMilliseconds(USB_TRACE_POLL_INTERVAL_MS);
+            continue;
+        }
+
+        const size_t LENGTH = count * sizeof(struct trace_event);
+
+        g_usb_trace_batch.section.type   = NETWORK_TRACE_SECTION_EVENTS;
+        g_usb_trace_batch.section.length = LENGTH;
+
+        if (!usb_trace_transmit(generation, &g_usb_trace_batch, sizeof(g_usb_trace_batch.section) + LENGTH)) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Handle the vendor requests to the trace capture interface. Called from the USB interrupt.
+ *
+ * @param usbp A pointer to the USB driver structure.
+ * @return bool True, if the request was handled.
+ */
+bool usb_trace_requests_hook(USBDriver* usbp) {
+    const uint8_t REQUEST_TYPE = usbp->setup[0];
+    const uint8_t REQUEST      = usbp->setup[1];
+    const uint8_t INTERFACE    = usbp->setup[4];
+
+    if (((REQUEST_TYPE & USB_RTYPE_TYPE_MASK) != USB_RTYPE_TYPE_VENDOR) ||
+        ((REQUEST_TYPE & USB_RTYPE_RECIPIENT_MASK) != USB_RTYPE_RECIPIENT_INTERFACE) ||
+        (INTERFACE != USB_TRACE_INTERFACE)) {
+        return false;
+    }
+
+    switch (REQUEST) {
+        case USB_TRACE_REQUEST_START:
+            osalSysLockFromISR();
+            g_usb_trace.generation++;
+            g_usb_trace.b_streaming = true;
+            chBSemSignalI(&g_usb_trace.start);
+            osalSysUnlockFromISR();
+            break;
+
+        case USB_TRACE_REQUEST_STOP:
+            g_usb_trace.b_streaming = false;
+            break;
+
+        default:
+            return false;
+    }
+
+    usbSetupTransfer(usbp, NULL, 0u, NULL);
+    return true;
+}
+
+static MEMORY_CCM_NOINIT THD_WORKING_AREA(wa_usb_trace, USB_TRACE_STACK_SIZE);
+
+/**
+ * @brief The USB trace drain thread.
+ *
+ * @param p_arg A pointer to arguments to the trace drain, unused.
+ */
+static THD_FUNCTION(usb_trace, p_arg) {
+    (void)p_arg;
+    chRegSetThreadName("usb_trace");
+
+    while (true) {
+        chBSemWait(&g_usb_trace.start);
+        usb_trace_serve(g_usb_trace.generation);
+    }
+}
+
+/**
+ * @brief Start the USB trace drain thread.
+ */
+void usb_trace_init(void) {
+    chBSemObjectInit(&g_usb_trace.start, true);
+    chThdCreateStatic(wa_usb_trace, sizeof(wa_usb_trace), LOWPRIO + 1, usb_trace, NULL);
+}
+
+#endif  // TRACE_ENABLE == TRUE
+
+/**
+ * @}
+ */
@@ -0,0 +1,50 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   The USB trace drain module headers.
+ *
+ * @addtogroup usb_trace
+ * @{
+ */
+
+#ifndef SOURCE_USB_CDC_USB_TRACE_H_
+#define SOURCE_USB_CDC_USB_TRACE_H_
+
+#include "ch.h"
+#include "hal.h"
+#include "trace/trace.h"
+
+/**
+ * @brief The vendor specific interface of the trace capture.
+ */
+#define USB_TRACE_INTERFACE 2
+
+/**
+ * @brief The bulk IN endpoint of the trace capture.
+ */
+#define USB_TRACE_EP 3
+
+/**
+ * @brief The packet size of the trace capture endpoint.
+ */
+#define USB_TRACE_PACKET_SIZE 0x0040
+
+/**
+ * @brief The vendor requests to the trace capture interface, which carry no data.
+ */
+enum usb_trace_request {
+    USB_TRACE_REQUEST_START = 0x01,  ///< Start a new stream, beginning with its header.
+    USB_TRACE_REQUEST_STOP  = 0x02,  ///< Stop the stream, after the transfer in progress.
+};
+
+#if TRACE_ENABLE == TRUE
+bool usb_trace_requests_hook(USBDriver* usbp);
+void usb_trace_init(void);
+#endif
+
+#endif  // SOURCE_USB_CDC_USB_TRACE_H_
+
+/**
+ * @}
+ */
@@ -10,20 +10,36 @@
 
 #include "usbcfg.h"
 
-// Endpoints to be used for USBD1.
+#include "usb_trace.h"
+
+// Endpoints to be used for USBD1. The map follows the one of the blackmagic firmware (see usb_serial._c), as far as the
+// OTG FS peripheral allows - it has three endpoints besides the control endpoint. There is no target UART interface,
+// and the trace capture moves from endpoint 5 to 3.
+//
+//     0 Control Endpoint
+// IN  1 CDC DATA (shell or GDB)
+// OUT 1 CDC DATA (shell or GDB)
+// IN  2 CDC CTRL
+// IN  3 Trace Capture
 #define USB1_DATA_REQUEST_EP      1
 #define USB1_DATA_AVAILABLE_EP    1
 #define USB1_INTERRUPT_REQUEST_EP 2
 
+// The size of a CDC notification (e.g. SERIAL_STATE, 10 bytes), rounded up to a valid packet size.
+#define USB1_INTERRUPT_PACKET_SIZE 0x0010
+
 // Virtual serial port over USB.
 SerialUSBDriver g_serial_usb_driver;
 
+// True, if the host asserts DTR, i.e. a program on the host has the serial port open.
+static volatile bool g_serial_usb_dtr;
+
 // USB Device Descriptor.
 static const uint8_t vcom_device_descriptor_data[18] = {
-    USB_DESC_DEVICE(0x0110,  // bcdUSB (1.1).
-                    0x02,    // bDeviceClass (CDC).
-                    0x00,    // bDeviceSubClass.
-                    0x00,    // bDeviceProtocol.
+    USB_DESC_DEVICE(0x0200,  // bcdUSB (2.0).
+                    0xEF,    // bDeviceClass (Miscellaneous, for interface association descriptors).
+                    0x02,    // bDeviceSubClass (Common Class).
+                    0x01,    // bDeviceProtocol (Interface Association Descriptor).
                     0x40,    // bMaxPacketSize.
                     0x0483,  // idVendor (ST).
                     0x5740,  // idProduct.
@@ -37,15 +53,22 @@ static const uint8_t vcom_device_descriptor_data[18] = {
 // Device Descriptor wrapper.
 static const USBDescriptor vcom_device_descriptor = {sizeof vcom_device_descriptor_data, vcom_device_descriptor_data};
 
-// Configuration Descriptor tree for a CDC.
-static const uint8_t vcom_configuration_descriptor_data[67] = {
+// Configuration Descriptor tree for a composite device: a CDC and the trace capture interface.
+static const uint8_t vcom_configuration_descriptor_data[91] = {
     // Configuration Descriptor.
-    USB_DESC_CONFIGURATION(67,    // wTotalLength.
-                           0x02,  // bNumInterfaces.
+    USB_DESC_CONFIGURATION(91,    // wTotalLength.
+                           0x03,  // bNumInterfaces.
                            0x01,  // bConfigurationValue.
                            0,     // iConfiguration.
                            0xC0,  // bmAttributes (self powered).
                            50),   // bMaxPower (100mA).
+    // Interface Association Descriptor of the CDC.
+    USB_DESC_INTERFACE_ASSOCIATION(0x00,  // bFirstInterface.
+                                   0x02,  // bInterfaceCount.
+                                   0x02,  // bFunctionClass (CDC).
+                                   0x02,  // bFunctionSubClass (Abstract Control Model).
+                                   0x01,  // bFunctionProtocol (AT commands).
+                                   0),    // iFunction.
     // Interface Descriptor.
     USB_DESC_INTERFACE(0x00,  // bInterfaceNumber.
                        0x00,  // bAlternateSetting.
@@ -74,7 +97,7 @@ static const uint8_t vcom_configuration_descriptor_data[67] = {
     USB_DESC_BYTE(0x01),      // bSlaveInterface0 (Data Class Interface).
     // Endpoint 2 Descriptor.
     USB_DESC_ENDPOINT(USB1_INTERRUPT_REQUEST_EP | 0x80, 0x03,  // bmAttributes (Interrupt).
-                      0x0008,                                  // wMaxPacketSize.
+                      USB1_INTERRUPT_PACKET_SIZE,              // wMaxPacketSize.
                       0xFF),                                   // bInterval.
     // Interface Descriptor.
     USB_DESC_INTERFACE(0x01,   // bInterfaceNumber.
@@ -84,16 +107,29 @@ static const uint8_t vcom_configuration_descriptor_data[67] = {
                        0x00,   // bInterfaceSubClass (CDC section 4.6).
                        0x00,   // bInterfaceProtocol (CDC section 4.7).
                        0x00),  // iInterface.
-    // Endpoint 3 Descriptor.
+    // Endpoint 1 Descriptor (OUT).
     USB_DESC_ENDPOINT(USB1_DATA_AVAILABLE_EP,  // bEndpointAddress.
                       0x02,                    // bmAttributes (Bulk).
                       0x0040,                  // wMaxPacketSize.
                       0x00),                   // bInterval.
-    // Endpoint 1 Descriptor.
+    // Endpoint 1 Descriptor (IN).
     USB_DESC_ENDPOINT(USB1_DATA_REQUEST_EP | 0x80,  // bEndpointAddress.
                       0x02,                         // bmAttributes (Bulk).
                       0x0040,                       // wMaxPacketSize.
-                      0x00)                         // bInterval.
+                      0x00),                        // bInterval.
+    // Interface Descriptor of the trace capture.
+    USB_DESC_INTERFACE(USB_TRACE_INTERFACE,  // bInterfaceNumber.
+                       0x00,                 // bAlternateSetting.
+                       0x01,                 // bNumEndpoints.
+                       0xFF,                 // bInterfaceClass (Vendor Specific).
+                       0x00,                 // bInterfaceSubClass.
+                       0x00,                 // bInterfaceProtocol.
+                       4),                   // iInterface.
+    // Endpoint 3 Descriptor.
+    USB_DESC_ENDPOINT(USB_TRACE_EP | 0x80,    // bEndpointAddress.
+                      0x02,                   // bmAttributes (Bulk).
+                      USB_TRACE_PACKET_SIZE,  // wMaxPacketSize.
+                      0x00)                   // bInterval.
 };
 
 // Configuration Descriptor wrapper.
@@ -215,11 +251,42 @@ static const uint8_t vcom_string3[] = {USB_DESC_BYTE(8),                      //
                                        '0' + CH_KERNEL_PATCH,
                                        0};
 
+// Trace Capture interface string.
+static const uint8_t vcom_string4[] = {USB_DESC_BYTE(28),                     // bLength.
+                                       USB_DESC_BYTE(USB_DESCRIPTOR_STRING),  // bDescriptorType.
+                                       'T',
+                                       0,
+                                       'r',
+                                       0,
+                                       'a',
+                                       0,
+                                       'c',
+                                       0,
+                                       'e',
+                                       0,
+                                       ' ',
+                                       0,
+                                       'C',
+                                       0,
+                                       'a',
+                                       0,
+                                       'p',
+                                       0,
+                                       't',
+                                       0,
+                                       'u',
+                                       0,
+                                       'r',
+                                       0,
+                                       'e',
+                                       0};
+
 // Strings wrappers array.
 static const USBDescriptor vcom_strings[] = {{sizeof vcom_string0, vcom_string0},
                                              {sizeof vcom_string1, vcom_string1},
                                              {sizeof vcom_string2, vcom_string2},
-                                             {sizeof vcom_string3, vcom_string3}};
+                                             {sizeof vcom_string3, vcom_string3},
+                                             {sizeof vcom_string4, vcom_string4}};
 
 //
 
@@ -241,7 +308,7 @@ static const USBDescriptor *get_descriptor(USBDriver *usbp, uint8_t dtype, uint8
         case USB_DESCRIPTOR_CONFIGURATION:
             return &vcom_configuration_descriptor;
         case USB_DESCRIPTOR_STRING:
-            if (dindex < 4) return &vcom_strings[dindex];
+            if (dindex < (sizeof vcom_strings / sizeof vcom_strings[0])) return &vcom_strings[dindex];
     }
     return NULL;
 }
@@ -250,7 +317,7 @@ static USBInEndpointState  ep1instate;
 static USBOutEndpointState ep1outstate;
 
 /**
- *@brief EP1 initialization structure(both IN and OUT) .
+ *@brief EP1 initialization structure(both IN and OUT). The IN FIFO holds two packets (double buffered).
  */
 static const USBEndpointConfig ep1config = {USB_EP_MODE_TYPE_BULK,
                                             NULL,
@@ -268,8 +335,33 @@ static USBInEndpointState ep2instate;
 /**
  * @brief EP2 initialization structure(IN only).
  */
-static const USBEndpointConfig ep2config = {
-    USB_EP_MODE_TYPE_INTR, NULL, sduInterruptTransmitted, NULL, 0x0010, 0x0000, &ep2instate, NULL, 1, NULL};
+static const USBEndpointConfig ep2config = {USB_EP_MODE_TYPE_INTR,
+                                            NULL,
+                                            sduInterruptTransmitted,
+                                            NULL,
+                                            USB1_INTERRUPT_PACKET_SIZE,
+                                            0x0000,
+                                            &ep2instate,
+                                            NULL,
+                                            1,
+                                            NULL};
+
+static USBInEndpointState ep3instate;
+
+/**
+ * @brief EP3 initialization structure(IN only). The FIFO holds two packets (double buffered), such that the next one is
+ * filled, while the previous one is sent.
+ */
+static const USBEndpointConfig ep3config = {USB_EP_MODE_TYPE_BULK,
+                                            NULL,
+                                            NULL,
+                                            NULL,
+                                            USB_TRACE_PACKET_SIZE,
+                                            0x0000,
+                                            &ep3instate,
+                                            NULL,
+                                            2,
+                                            NULL};
 
 /**
  * @brief Handles the USB driver global events.
@@ -288,6 +380,7 @@ static void usb_event(USBDriver *usbp, usbevent_t event) {
             // Class functions must be used.
             usbInitEndpointI(usbp, USB1_DATA_REQUEST_EP, &ep1config);
             usbInitEndpointI(usbp, USB1_INTERRUPT_REQUEST_EP, &ep2config);
+            usbInitEndpointI(usbp, USB_TRACE_EP, &ep3config);
 
             // Resetting the state of the CDC subsystem.
             sduConfigureHookI(&g_serial_usb_driver);
@@ -301,7 +394,8 @@ static void usb_event(USBDriver *usbp, usbevent_t event) {
         case USB_EVENT_SUSPEND:
             chSysLockFromISR();
 
-            // Disconnection event on suspend.
+            // Disconnection event on suspend. The host asserts DTR again, when it reopens the port.
+            g_serial_usb_dtr = false;
             sduSuspendHookI(&g_serial_usb_driver);
 
             chSysUnlockFromISR();
@@ -320,6 +414,29 @@ static void usb_event(USBDriver *usbp, usbevent_t event) {
     return;
 }
 
+/**
+ * @brief Handles the class and vendor specific requests. Tracks the DTR line, before handing over to the CDC
+ * subsystem.
+ *
+ * @param usbp A pointer to the USB driver structure.
+ * @return bool True, if the request was handled.
+ */
+static bool requests_hook(USBDriver *usbp) {
+#if TRACE_ENABLE == TRUE
+    if (usb_trace_requests_hook(usbp)) {
+        return true;
+    }
+#endif
+
+    if (((usbp->setup[0] & USB_RTYPE_TYPE_MASK) == USB_RTYPE_TYPE_CLASS) &&
+        (usbp->setup[1] == CDC_SET_CONTROL_LINE_STATE)) {
+        // The low byte of wValue holds the control signal bitmap, with DTR in bit 0.
+        g_serial_usb_dtr = ((usbp->setup[2] & 0x01u) != 0u);
+    }
+
+    return sduRequestsHook(usbp);
+}
+
 /**
  * @brief Handles the USB start-of-frame package.
  *
@@ -333,7 +450,7 @@ static void sof_handler(USBDriver *usbp) {
     osalSysUnlockFromISR();
 }
 
-const USBConfig       usbcfg    = {usb_event, get_descriptor, sduRequestsHook, sof_handler};
+const USBConfig       usbcfg    = {usb_event, get_descriptor, requests_hook, sof_handler};
 const SerialUSBConfig serusbcfg = {&USBD1, USB1_DATA_REQUEST_EP, USB1_DATA_AVAILABLE_EP, USB1_INTERRUPT_REQUEST_EP};
 
 /**
@@ -356,6 +473,18 @@ void usbcfg_init(void) {
  */
 BaseSequentialStream *get_serial_usb_stream(void) { return (BaseSequentialStream *)&g_serial_usb_driver; }
 
+/**
+ * @brief Get the serial USB-CDC driver, e.g. for accessing its buffer queues directly.
+ * @return SerialUSBDriver * The pointer to the USB-CDC driver.
+ */
+SerialUSBDriver *get_serial_usb_driver(void) { return &g_serial_usb_driver; }
+
+/**
+ * @brief Check, if the host asserts DTR. Terminal programs and GDB assert it while they have the serial port open.
+ * @return bool True, if DTR is asserted.
+ */
+bool usbcfg_is_dtr_set(void) { return g_serial_usb_dtr; }
+
 /**
  * @}
  */
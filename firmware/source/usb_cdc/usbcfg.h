@@ -16,6 +16,8 @@
 
 void                  usbcfg_init(void);
 BaseSequentialStream *get_serial_usb_stream(void);
+SerialUSBDriver      *get_serial_usb_driver(void);
+bool                  usbcfg_is_dtr_set(void);
 
 #endif  // SOURCE_USB_CDC_USBCFG_H_
 
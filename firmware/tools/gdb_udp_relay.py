@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""Relay a GDB TCP connection to the UDP transport of the probe.
+
+Stock GDB only speaks the remote serial protocol (RSP) over TCP or serial lines. This relay accepts GDB on a local TCP
+port, and forwards the byte stream to the GDB UDP port of the probe (build with "make USE_NETWORK_GDB_UDP=yes"), and
+back. Lost datagrams are recovered by the acknowledgements of the RSP itself - GDB sends an unacknowledged packet
+again, and rejects ('-') a reply that does not arrive in time, which the probe then sends again.
+
+The relay keeps a quiet session alive (e.g. while the target runs) with empty datagrams, and ends it with an EOT
+character, when GDB disconnects.
+
+Examples:
+    ./gdb_udp_relay.py --host net-bmp
+    ./gdb_udp_relay.py --host net-bmp --listen-port 3333
+
+    (gdb) set remotetimeout 1
+    (gdb) target extended-remote localhost:2000
+"""
+
+import argparse
+import select
+import socket
+import sys
+import time
+
+DEFAULT_HOST = "net-bmp"
+DEFAULT_PORT = 2004
+DEFAULT_LISTEN_PORT = 2000
+
+# The probe reassembles datagrams of up to a packet, and its acknowledgement.
+DATAGRAM_LENGTH = 2048
+
+KEEPALIVE_INTERVAL_S = 1.0
+
+# Ends the session. It is not acknowledged, so it is sent a few times, against loss.
+END_OF_SESSION = b"\x04"
+END_OF_SESSION_COUNT = 3
+
+
+def relay(client: socket.socket, probe: tuple, verbose: bool) -> dict:
+    """Relay one GDB connection, until either side closes it. Return the traffic counts."""
+    counts = {"to_probe": 0, "from_probe": 0}
+
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as udp:
+        udp.connect(probe)
+        last_send = time.monotonic()
+
+        try:
+            while True:
+                timeout = max(0.0, KEEPALIVE_INTERVAL_S - (time.monotonic() - last_send))
+                readable, _, _ = select.select([client, udp], [], [], timeout)
+
+                if client in readable:
+                    data = client.recv(DATAGRAM_LENGTH)
+
+                    if not data:
+                        break
+
+                    udp.send(data)
+                    last_send = time.monotonic()
+                    counts["to_probe"] += 1
+
+                    if verbose:
+                        print(f"-> {data[:64]!r}")
+
+                if udp in readable:
+                    try:
+                        data = udp.recv(65536)
+                    except ConnectionRefusedError:
+                        # An ICMP port unreachable - the probe may still be booting. GDB retries.
+                        continue
+
+                    client.sendall(data)
+                    counts["from_probe"] += 1
+
+                    if verbose:
+                        print(f"<- {data[:64]!r}")
+
+                if (time.monotonic() - last_send) >= KEEPALIVE_INTERVAL_S:
+                    udp.send(b"")
+                    last_send = time.monotonic()
+
+        except ConnectionResetError:
+            pass
+
+        for _ in range(END_OF_SESSION_COUNT):
+            udp.send(END_OF_SESSION)
+
+    return counts
+
+
+def parse_arguments():
+    """Parse the command line arguments."""
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default=DEFAULT_HOST, help="The probe host name or address.")
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT, help="The GDB UDP port of the probe.")
+    parser.add_argument("--listen-address", default="127.0.0.1", help="The address, on which GDB is accepted.")
+    parser.add_argument("--listen-port", type=int, default=DEFAULT_LISTEN_PORT, help="The port for GDB to connect to.")
+    parser.add_argument("--verbose", action="store_true", help="Print the relayed data.")
+
+    return parser.parse_args()
+
+
+def main() -> int:
+    arguments = parse_arguments()
+
+    try:
+        probe = (socket.gethostbyname(arguments.host), arguments.port)
+    except OSError as error:
+        print(f"Failed to resolve {arguments.host}: {error}", file=sys.stderr)
+        return 1
+
+    with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as server:
+        server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        server.bind((arguments.listen_address, arguments.listen_port))
+        server.listen(1)
+
+        print(f"Relaying {arguments.listen_address}:{arguments.listen_port} to UDP {probe[0]}:{probe[1]}.")
+
+        try:
+            while True:
+                client, address = server.accept()
+
+                with client:
+                    client.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+                    print(f"GDB connected from {address[0]}:{address[1]}.")
+
+                    counts = relay(client, probe, arguments.verbose)
+                    print(
+                        f"GDB disconnected ({counts['to_probe']} datagrams to, "
+                        f"{counts['from_probe']} from the probe)."
+                    )
+
+        except KeyboardInterrupt:
+            pass
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+"""Report the memory usage per region from the linker map file of the firmware.
+
+Output sections are assigned to the memory regions of the linker script by their address. Initialized data also
+occupies flash, at its load address. With --top, the largest input sections (variables, stacks, functions) per region
+are listed as well, which shows what to move, when a region runs full.
+
+Examples:
+    ./memory_report.py ../build/ch.map
+    ./memory_report.py ../build/ch.map --top 10
+    ./memory_report.py ../build/ch.map --json
+"""
+
+import argparse
+import json
+import pathlib
+import re
+import sys
+
+# Regions that overlap others, and are only used in alternative configurations.
+IGNORED_REGIONS = {"*default*", "ram1", "ram2"}
+
+REGION_PATTERN = re.compile(r"^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+\S+)?\s*$")
+SECTION_PATTERN = re.compile(
+    r"^(?P<input> ?)(?P<name>[.\w][^\s]*)?\s+0x(?P<address>[0-9a-fA-F]+)\s+0x(?P<size>[0-9a-fA-F]+)"
+    r"(?:\s+load address 0x(?P<load>[0-9a-fA-F]+))?(?:\s+(?P<file>\S.*))?$"
+)
+
+
+class Region:
+    """A memory region of the linker script."""
+
+    def __init__(self, name: str, origin: int, length: int):
+        self.name = name
+        self.origin = origin
+        self.length = length
+        self.used = 0
+        self.sections = {}
+        self.input_sections = []
+
+    def contains(self, address: int) -> bool:
+        return self.origin <= address < self.origin + self.length
+
+
+def parse_map(path: pathlib.Path) -> list:
+    """Parse the memory configuration and the output and input sections of a GNU ld map file."""
+    lines = path.read_text(errors="replace").splitlines()
+    regions = []
+    index = 0
+
+    # The memory configuration table.
+    while (index < len(lines)) and not lines[index].startswith("Memory Configuration"):
+        index += 1
+
+    while (index < len(lines)) and not lines[index].startswith("Linker script and memory map"):
+        match = REGION_PATTERN.match(lines[index])
+        index += 1
+
+        if match is None:
+            continue
+
+        name, origin, length = match.group(1), int(match.group(2), 16), int(match.group(3), 16)
+
+        if (length > 0) and (name not in IGNORED_REGIONS):
+            regions.append(Region(name, origin, length))
+
+    if not regions:
+        raise ValueError(f"No memory configuration in {path}.")
+
+    def find_region(address: int):
+        return next((region for region in regions if region.contains(address)), None)
+
+    # The memory map. Long section names are followed by a line break, before the address and size.
+    pending_name = None
+    pending_input = False
+
+    for line in lines[index:]:
+        if line.startswith("/DISCARD/"):
+            break
+
+        stripped = line.strip()
+
+        if stripped and (" " not in stripped) and stripped.startswith(".") and not line.startswith("  "):
+            pending_name = stripped
+            pending_input = line.startswith(" ")
+            continue
+
+        match = SECTION_PATTERN.match(line)
+
+        if match is None:
+            pending_name = None
+            continue
+
+        name = match.group("name") or pending_name
+        is_input = bool(match.group("input")) if match.group("name") else pending_input
+        pending_name = None
+
+        if name is None:
+            continue
+
+        address, size = int(match.group("address"), 16), int(match.group("size"), 16)
+        region = find_region(address)
+
+        if (size == 0) or (region is None):
+            continue
+
+        if is_input:
+            region.input_sections.append((size, name, (match.group("file") or "").strip()))
+            continue
+
+        region.used += size
+        region.sections[name] = region.sections.get(name, 0) + size
+
+        if match.group("load") is not None:
+            load_region = find_region(int(match.group("load"), 16))
+
+            if (load_region is not None) and (load_region is not region):
+                load_region.used += size
+                load_region.sections[f"{name} (load)"] = size
+
+    return regions
+
+
+def print_report(regions: list, top: int):
+    """Print the usage per region as a table."""
+    print(f"{'region':<8} {'origin':>10} {'used':>9} {'size':>9} {'usage':>7}")
+
+    for region in regions:
+        print(
+            f"{region.name:<8} {region.origin:#010x} {region.used:>9} {region.length:>9} "
+            f"{100.0 * region.used / region.length:>6.1f}%"
+        )
+
+        for name, size in sorted(region.sections.items(), key=lambda item: -item[1]):
+            print(f"    {name:<30} {size:>9}")
+
+        for size, name, file in sorted(region.input_sections, reverse=True)[:top]:
+            print(f"        {size:>9}  {name}  {pathlib.Path(file).name}")
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("map", type=pathlib.Path, help="The linker map file.")
+    parser.add_argument("--top", type=int, default=0, help="List the largest input sections per region.")
+    parser.add_argument("--json", action="store_true", help="Print machine-readable results.")
+    arguments = parser.parse_args()
+
+    try:
+        regions = parse_map(arguments.map)
+    except (OSError, ValueError) as error:
+        print(f"Failed to read the map file: {error}", file=sys.stderr)
+        return 1
+
+    if arguments.json:
+        print(
+            json.dumps(
+                {
+                    region.name: {
+                        "origin": region.origin,
+                        "size": region.length,
+                        "used": region.used,
+                        "sections": region.sections,
+                    }
+                    for region in regions
+                }
+            )
+        )
+    else:
+        print_report(regions, arguments.top)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""Fetch and print the request latency telemetry of the probe.
+
+The probe answers every datagram on its telemetry port with a snapshot of its request latency histograms, per stage
+(receive, parse, execute, transmit, total). See source/network/network_telemetry.h for the packet layout.
+
+Examples:
+    ./perf_telemetry.py --host net-bmp
+    ./perf_telemetry.py --host net-bmp --interval 1 --json
+"""
+
+import argparse
+import json
+import socket
+import struct
+import sys
+import time
+
+DEFAULT_HOST = "net-bmp"
+DEFAULT_PORT = 2001
+
+TELEMETRY_MAGIC = 0x4D4C4554  # "TELM"
+TELEMETRY_VERSION = 1
+
+HEADER_FORMAT = "<IHBBII"
+STAGE_NAMES = ["receive", "parse", "execute", "transmit", "total"]
+
+
+def decode(packet: bytes) -> dict:
+    """Decode a telemetry packet."""
+    header_length = struct.calcsize(HEADER_FORMAT)
+
+    if len(packet) < header_length:
+        raise ValueError("Telemetry packet too short.")
+
+    magic, version, stage_count, bucket_count, frequency, uptime_ms = struct.unpack_from(HEADER_FORMAT, packet)
+
+    if (magic != TELEMETRY_MAGIC) or (version != TELEMETRY_VERSION):
+        raise ValueError(f"Unsupported telemetry packet (magic {magic:#x}, version {version}).")
+
+    stage_format = f"<III{bucket_count}I"
+    stage_length = struct.calcsize(stage_format)
+
+    if len(packet) != header_length + stage_count * stage_length:
+        raise ValueError("Telemetry packet length mismatch.")
+
+    stages = {}
+
+    for stage_index in range(stage_count):
+        values = struct.unpack_from(stage_format, packet, header_length + stage_index * stage_length)
+        name = STAGE_NAMES[stage_index] if stage_index < len(STAGE_NAMES) else f"stage{stage_index}"
+        count, minimum, maximum = values[:3]
+
+        stages[name] = {
+            "count": count,
+            "min_us": (minimum * 1e6 / frequency) if count else 0.0,
+            "max_us": maximum * 1e6 / frequency,
+            "buckets": list(values[3:]),
+        }
+
+    return {"uptime_ms": uptime_ms, "counter_frequency": frequency, "stages": stages}
+
+
+def percentile_us(stage: dict, frequency: int, percentile: float) -> float:
+    """Estimate a percentile from the logarithmic buckets, as the upper bound of the bucket that contains it."""
+    target = percentile / 100.0 * stage["count"]
+    accumulated = 0
+
+    for bucket_index, count in enumerate(stage["buckets"]):
+        accumulated += count
+
+        if (count > 0) and (accumulated >= target):
+            return min(2 ** (bucket_index + 1), stage["max_us"] * frequency / 1e6) * 1e6 / frequency
+
+    return 0.0
+
+
+def print_telemetry(telemetry: dict):
+    """Print a telemetry snapshot as a table."""
+    frequency = telemetry["counter_frequency"]
+
+    print(f"uptime {telemetry['uptime_ms'] / 1000.0:.1f} s")
+    print(f"{'stage':<10} {'count':>10} {'min us':>10} {'~p50 us':>10} {'~p99 us':>10} {'max us':>10}")
+
+    for name, stage in telemetry["stages"].items():
+        print(
+            f"{name:<10} {stage['count']:>10} {stage['min_us']:>10.1f} {percentile_us(stage, frequency, 50):>10.1f} "
+            f"{percentile_us(stage, frequency, 99):>10.1f} {stage['max_us']:>10.1f}"
+        )
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default=DEFAULT_HOST, help="The probe host name or address.")
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT, help="The telemetry UDP port.")
+    parser.add_argument("--timeout", type=float, default=1.0, help="The reply timeout in seconds.")
+    parser.add_argument("--interval", type=float, default=0.0, help="Poll repeatedly with this interval in seconds.")
+    parser.add_argument("--json", action="store_true", help="Print machine-readable results.")
+    arguments = parser.parse_args()
+
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as telemetry_socket:
+        telemetry_socket.settimeout(arguments.timeout)
+
+        while True:
+            try:
+                telemetry_socket.sendto(b"?", (arguments.host, arguments.port))
+                telemetry = decode(telemetry_socket.recv(4096))
+            except (OSError, ValueError) as error:
+                print(f"Failed to get telemetry: {error}", file=sys.stderr)
+                return 1
+
+            if arguments.json:
+                print(json.dumps(telemetry))
+            else:
+                print_telemetry(telemetry)
+
+            if arguments.interval <= 0.0:
+                return 0
+
+            time.sleep(arguments.interval)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
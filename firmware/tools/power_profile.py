@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""Record the target voltage profile of the probe as CSV.
+
+The probe samples the target voltage while a client is connected to its power port (see
+source/network/network_power.h for the stream layout), and sends records of the mean, minimum and maximum voltage. The
+time stamp counter of each record is the same as that of the event trace (see trace_decode.py), for correlating the
+profile with target activity. Gaps in the record sequence (blocks that the probe could not send in time) are reported.
+Streams that the SD card recorder captured (see recorder_fetch.py) are read with --file.
+
+Examples:
+    ./power_profile.py --host net-bmp --output profile.csv
+    ./power_profile.py --host net-bmp --duration 10 --output profile.csv
+    ./power_profile.py --file session-1-power.bin --output profile.csv
+"""
+
+import argparse
+import csv
+import socket
+import struct
+import sys
+import time
+
+DEFAULT_HOST = "net-bmp"
+DEFAULT_PORT = 2005
+
+POWER_MAGIC = 0x50525750  # "PWRP"
+POWER_VERSION = 1
+
+HEADER_FORMAT = "<IHHIIHH"
+BLOCK_HEADER_FORMAT = "<II"
+RECORD_FORMAT = "<HHH"
+
+COUNTER_MODULO = 1 << 32
+
+
+def read_exactly(stream, length: int) -> bytes:
+    """Read a number of bytes, or raise EOFError, if the stream ends before."""
+    data = stream.read(length)
+
+    if len(data) < length:
+        raise EOFError
+
+    return data
+
+
+def record(stream, writer, duration_s: float) -> dict:
+    """Write records to CSV, until the duration elapsed, or the stream ends. Return the record counts."""
+    magic, version, block_size, counter_frequency, sample_rate, decimation, record_count = struct.unpack(
+        HEADER_FORMAT, read_exactly(stream, struct.calcsize(HEADER_FORMAT))
+    )
+
+    if magic != POWER_MAGIC or version != POWER_VERSION:
+        raise ValueError(f"Unsupported stream (magic 0x{magic:08X}, version {version}).")
+
+    record_size = struct.calcsize(RECORD_FORMAT)
+
+    if block_size != struct.calcsize(BLOCK_HEADER_FORMAT) + record_count * record_size:
+        raise ValueError(f"Unexpected block size {block_size}.")
+
+    record_period_s = decimation / sample_rate
+    record_period_counts = round(counter_frequency * record_period_s)
+    counts = {"records": 0, "lost": 0}
+    first_sequence = None
+    next_sequence = None
+    start = time.monotonic()
+
+    writer.writerow(["time_s", "counter", "mean_mv", "min_mv", "max_mv"])
+
+    while duration_s <= 0.0 or (time.monotonic() - start) < duration_s:
+        try:
+            block = read_exactly(stream, block_size)
+        except EOFError:
+            break
+
+        sequence, timestamp = struct.unpack_from(BLOCK_HEADER_FORMAT, block)
+
+        # Sampling may already run for another reader, so the sequence starts anywhere.
+        if first_sequence is None:
+            first_sequence = sequence
+            next_sequence = sequence
+
+        counts["lost"] += sequence - next_sequence
+        next_sequence = sequence + record_count
+
+        for index, (mean_mv, min_mv, max_mv) in enumerate(
+            struct.iter_unpack(RECORD_FORMAT, block[struct.calcsize(BLOCK_HEADER_FORMAT) :])
+        ):
+            # The block is stamped, when its last record completes.
+            counter = (timestamp - (record_count - 1 - index) * record_period_counts) % COUNTER_MODULO
+            time_s = (sequence + index - first_sequence) * record_period_s
+            writer.writerow([f"{time_s:.6f}", counter, mean_mv, min_mv, max_mv])
+
+        counts["records"] += record_count
+
+    return counts
+
+
+def parse_arguments():
+    """Parse the command line arguments."""
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default=DEFAULT_HOST, help="The probe host name or address.")
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT, help="The power port of the probe.")
+    parser.add_argument("--file", help="Read a captured stream from a file, instead of the probe.")
+    parser.add_argument("--duration", type=float, default=0.0, help="The recording time in s (0 records until ^C).")
+    parser.add_argument("--output", help="The CSV file to write (standard output by default).")
+
+    return parser.parse_args()
+
+
+def main() -> int:
+    arguments = parse_arguments()
+    output = open(arguments.output, "w", newline="") if arguments.output else sys.stdout
+
+    try:
+        if arguments.file:
+            with open(arguments.file, "rb") as stream:
+                counts = record(stream, csv.writer(output), 0.0)
+        else:
+            with socket.create_connection((arguments.host, arguments.port)) as connection:
+                counts = record(connection.makefile("rb"), csv.writer(output), arguments.duration)
+
+    except KeyboardInterrupt:
+        return 0
+
+    except (OSError, ValueError, EOFError) as error:
+        print(f"Recording failed: {error}", file=sys.stderr)
+        return 1
+
+    finally:
+        if output is not sys.stdout:
+            output.close()
+
+    print(f"{counts['records']} records, {counts['lost']} lost.", file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
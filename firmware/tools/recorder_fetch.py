@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""Fetch sessions that the SD card recorder of the probe took, and split them into their streams.
+
+The probe records the event trace, the power profile and the target serial port to an SD card (format the card with
+the shell command "recorder format" first), and serves the recording on a TCP port. See source/recorder/recorder.h for
+the container format, and source/network/network_recorder.c for the commands.
+
+A session is split into files next to each other: <prefix>-trace.bin (decode with trace_decode.py --file),
+<prefix>-power.bin (convert with power_profile.py --file), and <prefix>-uart.bin (the raw bytes from the target).
+
+Examples:
+    ./recorder_fetch.py --host net-bmp
+    ./recorder_fetch.py --host net-bmp --session 3 --prefix soak
+    ./recorder_fetch.py --host net-bmp --session 3 --prefix soak --save soak.chunks
+    ./recorder_fetch.py --file soak.chunks --prefix soak
+"""
+
+import argparse
+import socket
+import struct
+import sys
+import zlib
+
+DEFAULT_HOST = "net-bmp"
+DEFAULT_PORT = 2006
+
+CHUNK_MAGIC = 0x43504D42  # "BMPC"
+CHUNK_SIZE = 16 * 512
+
+CHUNK_HEADER_FORMAT = "<IIIIIII"
+CHUNK_HEADER_CRC_OFFSET = 24
+RECORD_HEADER_FORMAT = "<HH"
+
+STREAM_NAMES = {1: "trace", 2: "power", 3: "uart"}
+
+
+def read_exactly(stream, length: int) -> bytes:
+    """Read a number of bytes, or raise EOFError, if the stream ends before."""
+    data = stream.read(length)
+
+    if len(data) < length:
+        raise EOFError
+
+    return data
+
+
+def list_sessions(stream, connection: socket.socket) -> list:
+    """Return the sessions on the card, as tuples of session number, first chunk and chunk count."""
+    connection.sendall(b"list\n")
+    sessions = []
+
+    while True:
+        line = stream.readline().decode("ascii").strip()
+
+        if not line:
+            return sessions
+
+        sessions.append(tuple(int(field) for field in line.split()))
+
+
+def fetch_chunks(stream, connection: socket.socket, session: int) -> bytes:
+    """Return the raw chunks of a session."""
+    connection.sendall(f"read {session}\n".encode("ascii"))
+    (chunk_count,) = struct.unpack("<I", read_exactly(stream, 4))
+
+    return read_exactly(stream, chunk_count * CHUNK_SIZE)
+
+
+def split_streams(chunks: bytes) -> tuple:
+    """Split raw chunks into their streams. Return the stream data by name, and the number of invalid chunks."""
+    streams = {name: bytearray() for name in STREAM_NAMES.values()}
+    invalid_count = 0
+
+    for offset in range(0, len(chunks), CHUNK_SIZE):
+        chunk = bytearray(chunks[offset : offset + CHUNK_SIZE])
+        magic, _, _, _, _, payload_length, crc = struct.unpack_from(CHUNK_HEADER_FORMAT, chunk)
+        chunk[CHUNK_HEADER_CRC_OFFSET : CHUNK_HEADER_CRC_OFFSET + 4] = bytes(4)
+
+        if magic != CHUNK_MAGIC or zlib.crc32(chunk) != crc:
+            invalid_count += 1
+            continue
+
+        position = struct.calcsize(CHUNK_HEADER_FORMAT)
+        end = position + payload_length
+
+        while position < end:
+            stream_id, length = struct.unpack_from(RECORD_HEADER_FORMAT, chunk, position)
+            position += struct.calcsize(RECORD_HEADER_FORMAT)
+
+            if stream_id in STREAM_NAMES:
+                streams[STREAM_NAMES[stream_id]].extend(chunk[position : position + length])
+
+            position += length
+
+    return streams, invalid_count
+
+
+def parse_arguments():
+    """Parse the command line arguments."""
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default=DEFAULT_HOST, help="The probe host name or address.")
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT, help="The recorder port of the probe.")
+    parser.add_argument("--session", type=int, help="The session to fetch. Sessions are listed without it.")
+    parser.add_argument("--file", help="Split raw chunks from a file, instead of fetching them.")
+    parser.add_argument("--save", help="Also save the raw chunks to a file.")
+    parser.add_argument("--prefix", default="session", help="The prefix of the stream files.")
+
+    return parser.parse_args()
+
+
+def main() -> int:
+    arguments = parse_arguments()
+
+    try:
+        if arguments.file:
+            with open(arguments.file, "rb") as file:
+                chunks = file.read()
+        else:
+            with socket.create_connection((arguments.host, arguments.port)) as connection:
+                stream = connection.makefile("rb")
+
+                if arguments.session is None:
+                    for session, first_index, chunk_count in list_sessions(stream, connection):
+                        print(f"Session {session}: {chunk_count} chunks from chunk {first_index}.")
+
+                    return 0
+
+                chunks = fetch_chunks(stream, connection, arguments.session)
+
+    except (OSError, EOFError, ValueError) as error:
+        print(f"Fetching failed: {error}", file=sys.stderr)
+        return 1
+
+    if not chunks:
+        print("The session was not found.", file=sys.stderr)
+        return 1
+
+    if arguments.save:
+        with open(arguments.save, "wb") as file:
+            file.write(chunks)
+
+    streams, invalid_count = split_streams(chunks)
+
+    for name, data in streams.items():
+        if data:
+            with open(f"{arguments.prefix}-{name}.bin", "wb") as file:
+                file.write(data)
+
+        print(f"{name}: {len(data)} bytes.")
+
+    if invalid_count:
+        print(f"{invalid_count} of {len(chunks) // CHUNK_SIZE} chunks were invalid, and skipped.", file=sys.stderr)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,611 @@
+#!/usr/bin/env python3
+"""A GDB remote serial protocol (RSP) load generator and latency benchmark.
+
+Runs scenarios against a GDB server - the probe, or the host-built simulated target (see firmware/host) - and
+reports throughput, latency percentiles and retransmissions for each.
+
+Results of two builds (e.g. with and without USE_CHECKSUM_OFFLOAD) are compared by saving the results of the first
+run with --json, and passing them to the second run with --compare. The same works for the TCP and UDP transports
+(--udp, see USE_NETWORK_GDB_UDP), where the client recovers lost datagrams with the acknowledgements of the RSP, and
+for the USB CDC interface (--serial, see USE_USB_CDC_FUNCTION).
+
+Examples:
+    ./rsp_bench.py --host net-bmp
+    ./rsp_bench.py --host localhost --no-ack --scenario read --scenario write
+    ./rsp_bench.py --no-ack --scenario dump --json > baseline.json
+    ./rsp_bench.py --no-ack --scenario dump --compare baseline.json
+    ./rsp_bench.py --scenario step --json > tcp.json
+    ./rsp_bench.py --scenario step --udp --port 2004 --compare tcp.json
+    ./rsp_bench.py --no-ack --scenario dump --serial /dev/ttyACM0 --compare baseline.json
+"""
+
+import argparse
+import json
+import os
+import select
+import socket
+import sys
+import termios
+import time
+import tty
+from dataclasses import dataclass, field
+
+DEFAULT_HOST = "net-bmp"
+DEFAULT_PORT = 2000
+
+ALL_SCENARIOS = ["read", "write", "dump", "flash", "rcmd", "step", "churn"]
+
+ESCAPED_CHARACTERS = b"#$}*"
+ESCAPE_CHARACTER = ord("}")
+ESCAPE_XOR = 0x20
+
+# Ends a session on the UDP transport. It is not acknowledged, so it is sent a few times, against loss.
+UDP_END_OF_SESSION = b"\x04"
+UDP_END_OF_SESSION_COUNT = 3
+
+
+class RspError(Exception):
+    """An error in the RSP exchange, e.g. an error reply or a timeout."""
+
+
+def checksum(payload: bytes) -> int:
+    """Calculate the RSP checksum of a payload."""
+    return sum(payload) & 0xFF
+
+
+def escape(data: bytes) -> bytes:
+    """Escape binary data for 'X' and 'vFlashWrite' packets."""
+    escaped = bytearray()
+
+    for byte in data:
+        if byte in ESCAPED_CHARACTERS:
+            escaped += bytes([ESCAPE_CHARACTER, byte ^ ESCAPE_XOR])
+        else:
+            escaped.append(byte)
+
+    return bytes(escaped)
+
+
+@dataclass
+class Statistics:
+    """Results of a scenario."""
+
+    name: str
+    latencies_ns: list = field(default_factory=list)
+    bytes: int = 0
+    duration_ns: int = 0
+    retransmits: int = 0
+
+    def percentile_ms(self, percentile: float) -> float:
+        """Get a latency percentile (nearest rank) in milliseconds."""
+        if not self.latencies_ns:
+            return 0.0
+
+        ordered = sorted(self.latencies_ns)
+        index = min(len(ordered) - 1, max(0, int(round(percentile / 100.0 * len(ordered) + 0.5)) - 1))
+        return ordered[index] / 1e6
+
+    def throughput_kib_s(self) -> float:
+        """Get the payload throughput in KiB/s."""
+        if self.duration_ns == 0:
+            return 0.0
+
+        return (self.bytes / 1024.0) / (self.duration_ns / 1e9)
+
+    def as_dict(self) -> dict:
+        """Get the results as a dictionary, for machine-readable output."""
+        return {
+            "scenario": self.name,
+            "requests": len(self.latencies_ns),
+            "bytes": self.bytes,
+            "duration_s": self.duration_ns / 1e9,
+            "throughput_kib_s": self.throughput_kib_s(),
+            "p50_ms": self.percentile_ms(50),
+            "p99_ms": self.percentile_ms(99),
+            "retransmits": self.retransmits,
+        }
+
+
+class RetransmitTimeout(Exception):
+    """Nothing was received within the retransmission timeout of the UDP transport."""
+
+
+class SerialPort:
+    """A serial port in raw mode, with the socket methods that the client uses."""
+
+    def __init__(self, device: str, timeout: float):
+        self.timeout = timeout
+        self.fd = os.open(device, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(self.fd)
+
+        # Closing the port drops DTR, which ends the session on the probe.
+        attributes = termios.tcgetattr(self.fd)
+        attributes[2] |= termios.HUPCL
+        termios.tcsetattr(self.fd, termios.TCSANOW, attributes)
+        termios.tcflush(self.fd, termios.TCIOFLUSH)
+
+    def recv(self, size: int) -> bytes:
+        readable, _, _ = select.select([self.fd], [], [], self.timeout)
+
+        if not readable:
+            raise socket.timeout("No data within the timeout.")
+
+        return os.read(self.fd, size)
+
+    def sendall(self, data: bytes):
+        view = memoryview(data)
+
+        while view:
+            view = view[os.write(self.fd, view) :]
+
+    def send(self, data: bytes):
+        self.sendall(data)
+
+    def close(self):
+        os.close(self.fd)
+
+
+class RspClient:
+    """A minimal RSP client, with and without acknowledgements, over TCP, UDP or a serial port.
+
+    Over UDP, a request that is not acknowledged in time is sent again, and a reply that does not arrive in time is
+    rejected ('-'), such that the server sends it again - just like GDB does on a serial line.
+    """
+
+    def __init__(
+        self,
+        host: str,
+        port: int,
+        timeout: float,
+        no_ack: bool,
+        udp: bool = False,
+        retransmit_timeout=0.2,
+        serial: str = None,
+    ):
+        self.udp = udp
+        self.timeout = timeout
+        self.retransmit_timeout = retransmit_timeout
+
+        if serial:
+            self.socket = SerialPort(serial, timeout)
+        elif udp:
+            self.socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+            self.socket.connect((host, port))
+            self.socket.settimeout(retransmit_timeout)
+        else:
+            self.socket = socket.create_connection((host, port), timeout=timeout)
+            self.socket.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+
+        self.buffer = bytearray()
+        self.ack_mode = True
+        self.retransmits = 0
+
+        if no_ack:
+            # The UDP transport refuses the no-ACK mode with an empty reply.
+            self.ack_mode = self.request(b"QStartNoAckMode") != b"OK"
+
+    def close(self):
+        """Close the connection."""
+        if self.udp:
+            for _ in range(UDP_END_OF_SESSION_COUNT):
+                self.socket.send(UDP_END_OF_SESSION)
+
+        self.socket.close()
+
+    def _receive(self):
+        try:
+            data = self.socket.recv(65536)
+        except socket.timeout as error:
+            if self.udp:
+                raise RetransmitTimeout() from error
+
+            raise
+
+        if not data and not self.udp:
+            raise RspError("Connection closed by the server.")
+
+        self.buffer += data
+
+    def _retry(self, started: float):
+        """Count a retransmission, and give up after the reply timeout."""
+        self.retransmits += 1
+
+        if (time.monotonic() - started) > self.timeout:
+            raise RspError("No reply within the timeout.")
+
+    def _read_character(self) -> int:
+        while not self.buffer:
+            self._receive()
+
+        return self.buffer.pop(0)
+
+    def _skip_packet(self):
+        while self._read_character() != ord("#"):
+            pass
+
+        self._read_character()
+        self._read_character()
+        self.socket.sendall(b"+")
+
+    def _send_packet(self, payload: bytes):
+        packet = b"$" + payload + b"#%02x" % checksum(payload)
+        started = time.monotonic()
+
+        while True:
+            self.socket.sendall(packet)
+
+            if not self.ack_mode:
+                return
+
+            # Wait for the acknowledgement - anything else before it is dropped.
+            try:
+                while True:
+                    character = self._read_character()
+
+                    if character == ord("+"):
+                        return
+
+                    if character == ord("-"):
+                        self.retransmits += 1
+                        break
+
+                    if character == ord("$"):
+                        # An old reply, sent again because its acknowledgement was lost. Acknowledge and skip it.
+                        self._skip_packet()
+
+            except RetransmitTimeout:
+                self._retry(started)
+
+    def read_packet(self) -> bytes:
+        """Read a reply packet, and acknowledge it, if required."""
+        started = time.monotonic()
+
+        while True:
+            while True:
+                start = self.buffer.find(b"$")
+                stop = self.buffer.find(b"#", start + 1) if start >= 0 else -1
+
+                if (start >= 0) and (stop >= 0) and (len(self.buffer) >= stop + 3):
+                    break
+
+                try:
+                    self._receive()
+                except RetransmitTimeout:
+                    # The reply, or the rest of it, was lost - reject it, to have it sent again.
+                    self._retry(started)
+                    self.buffer.clear()
+                    self.socket.send(b"-")
+
+            payload = bytes(self.buffer[start + 1 : stop])
+            reference = int(self.buffer[stop + 1 : stop + 3], 16)
+            del self.buffer[: stop + 3]
+
+            if checksum(payload) == reference:
+                if self.ack_mode:
+                    self.socket.sendall(b"+")
+
+                return payload
+
+            self.retransmits += 1
+
+            if self.ack_mode:
+                self.socket.sendall(b"-")
+
+    def request(self, payload: bytes, expected: bytes = None) -> bytes:
+        """Send a packet, and read its reply. Raise on error replies, or a mismatch with the expected reply."""
+        self._send_packet(payload)
+        reply = self.read_packet()
+
+        if (expected is not None) and (reply != expected):
+            raise RspError(f"Unexpected reply to {payload[:32]!r}: {reply[:32]!r}")
+
+        if reply.startswith(b"E") and (len(reply) == 3):
+            raise RspError(f"Error reply to {payload[:32]!r}: {reply!r}")
+
+        return reply
+
+    def monitor(self, command: str) -> bytes:
+        """Run a monitor command, and collect its output."""
+        self._send_packet(b"qRcmd," + command.encode().hex().encode())
+        output = bytearray()
+
+        while True:
+            reply = self.read_packet()
+
+            if reply.startswith(b"O") and (reply != b"OK"):
+                # Console output - more follows.
+                output += bytes.fromhex(reply[1:].decode())
+                continue
+
+            if reply != b"OK":
+                output += bytes.fromhex(reply.decode())
+
+            return bytes(output)
+
+
+def timed(statistics: Statistics, function, *arguments):
+    """Run a function, and record its latency."""
+    start = time.perf_counter_ns()
+    result = function(*arguments)
+    statistics.latencies_ns.append(time.perf_counter_ns() - start)
+    return result
+
+
+def connect(arguments) -> RspClient:
+    """Connect to the server, and attach to the target, if requested."""
+    client = RspClient(
+        arguments.host,
+        arguments.port,
+        arguments.timeout,
+        arguments.no_ack,
+        arguments.udp,
+        arguments.retransmit_timeout,
+        arguments.serial,
+    )
+    client.request(b"qSupported:multiprocess+;swbreak+;hwbreak+;qRelocInsn+")
+
+    if arguments.attach is not None:
+        reply = client.request(b"vAttach;%x" % arguments.attach)
+
+        if not reply.startswith(b"T"):
+            raise RspError(f"Failed to attach: {reply!r}")
+
+    return client
+
+
+def scenario_read(client: RspClient, arguments) -> list:
+    """Burst 'm' reads of varying sizes."""
+    results = []
+
+    for size in arguments.sizes:
+        statistics = Statistics(f"read {size} B")
+        request = b"m%x,%x" % (arguments.ram_address, size)
+        start = time.perf_counter_ns()
+
+        for _ in range(arguments.count):
+            reply = timed(statistics, client.request, request)
+            statistics.bytes += len(reply) // 2
+
+        statistics.duration_ns = time.perf_counter_ns() - start
+        results.append(statistics)
+
+    return results
+
+
+def scenario_write(client: RspClient, arguments) -> list:
+    """Burst binary 'X' writes of varying sizes."""
+    results = []
+
+    for size in arguments.sizes:
+        statistics = Statistics(f"write {size} B")
+        request = b"X%x,%x:" % (arguments.ram_address, size) + escape(os.urandom(size))
+        start = time.perf_counter_ns()
+
+        for _ in range(arguments.count):
+            timed(statistics, client.request, request, b"OK")
+            statistics.bytes += size
+
+        statistics.duration_ns = time.perf_counter_ns() - start
+        results.append(statistics)
+
+    return results
+
+
+def scenario_dump(client: RspClient, arguments) -> list:
+    """A bulk memory dump, as by GDB's dump command - back-to-back 'm' reads of the maximum size."""
+    statistics = Statistics(f"dump {arguments.dump_length // 1024} KiB")
+    start = time.perf_counter_ns()
+
+    for offset in range(0, arguments.dump_length, arguments.dump_chunk):
+        size = min(arguments.dump_chunk, arguments.dump_length - offset)
+        reply = timed(statistics, client.request, b"m%x,%x" % (arguments.dump_address + offset, size))
+        statistics.bytes += len(reply) // 2
+
+    statistics.duration_ns = time.perf_counter_ns() - start
+    return [statistics]
+
+
+def scenario_flash(client: RspClient, arguments) -> list:
+    """A 'vFlashWrite' stream, as sent by GDB's load command."""
+    statistics = Statistics(f"flash {arguments.flash_length // 1024} KiB")
+    image = os.urandom(arguments.flash_length)
+    start = time.perf_counter_ns()
+
+    timed(statistics, client.request, b"vFlashErase:%x,%x" % (arguments.flash_address, len(image)), b"OK")
+
+    for offset in range(0, len(image), arguments.flash_chunk):
+        chunk = image[offset : offset + arguments.flash_chunk]
+        request = b"vFlashWrite:%x:" % (arguments.flash_address + offset) + escape(chunk)
+        timed(statistics, client.request, request, b"OK")
+        statistics.bytes += len(chunk)
+
+    timed(statistics, client.request, b"vFlashDone", b"OK")
+    statistics.duration_ns = time.perf_counter_ns() - start
+
+    return [statistics]
+
+
+def scenario_rcmd(client: RspClient, arguments) -> list:
+    """'qRcmd' (monitor command) round trips."""
+    statistics = Statistics(f"rcmd '{arguments.monitor_command}'")
+    start = time.perf_counter_ns()
+
+    for _ in range(arguments.count):
+        output = timed(statistics, client.monitor, arguments.monitor_command)
+        statistics.bytes += len(output)
+
+    statistics.duration_ns = time.perf_counter_ns() - start
+    return [statistics]
+
+
+def scenario_step(client: RspClient, arguments) -> list:
+    """Single steps ('s'), each until its stop reply, as by GDB's stepi command."""
+    statistics = Statistics("step")
+    start = time.perf_counter_ns()
+
+    for _ in range(arguments.count):
+        reply = timed(statistics, client.request, b"s")
+
+        if not reply.startswith((b"T", b"S")):
+            raise RspError(f"Unexpected reply to a step: {reply!r}")
+
+    statistics.duration_ns = time.perf_counter_ns() - start
+    return [statistics]
+
+
+def scenario_churn(arguments) -> list:
+    """Connect/disconnect churn - each iteration connects, negotiates (and attaches), and disconnects."""
+    statistics = Statistics("connect/disconnect")
+    start = time.perf_counter_ns()
+
+    for _ in range(arguments.churn_count):
+        connection_start = time.perf_counter_ns()
+        client = connect(arguments)
+        statistics.latencies_ns.append(time.perf_counter_ns() - connection_start)
+        statistics.retransmits += client.retransmits
+
+        if arguments.attach is not None:
+            client.request(b"D", b"OK")
+
+        client.close()
+
+        # The server handles one session at a time - give it time to release the previous one.
+        time.sleep(arguments.churn_delay)
+
+    statistics.duration_ns = time.perf_counter_ns() - start
+    return [statistics]
+
+
+def print_results(results: list):
+    """Print a results table."""
+    print(f"{'scenario':<24} {'requests':>9} {'KiB/s':>10} {'p50 ms':>9} {'p99 ms':>9} {'retrans':>8}")
+
+    for statistics in results:
+        print(
+            f"{statistics.name:<24} {len(statistics.latencies_ns):>9} {statistics.throughput_kib_s():>10.1f} "
+            f"{statistics.percentile_ms(50):>9.3f} {statistics.percentile_ms(99):>9.3f} {statistics.retransmits:>8}"
+        )
+
+
+def print_comparison(results: list, baseline: list):
+    """Print the throughput and latency of the results next to those of a baseline run."""
+    baseline_by_name = {entry["scenario"]: entry for entry in baseline}
+
+    print(
+        f"{'scenario':<24} {'base KiB/s':>11} {'KiB/s':>10} {'change':>8} {'base p50':>9} {'p50 ms':>9} {'change':>8}"
+    )
+
+    def change(current: float, base: float) -> str:
+        return f"{100.0 * (current - base) / base:>+7.1f}%" if base else f"{'-':>8}"
+
+    for statistics in results:
+        entry = baseline_by_name.get(statistics.name)
+
+        if entry is None:
+            continue
+
+        throughput = statistics.throughput_kib_s()
+        p50 = statistics.percentile_ms(50)
+
+        print(
+            f"{statistics.name:<24} {entry['throughput_kib_s']:>11.1f} {throughput:>10.1f} "
+            f"{change(throughput, entry['throughput_kib_s'])} {entry['p50_ms']:>9.3f} {p50:>9.3f} "
+            f"{change(p50, entry['p50_ms'])}"
+        )
+
+
+def parse_arguments():
+    """Parse the command line arguments."""
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default=DEFAULT_HOST, help="The GDB server host name or address.")
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT, help="The GDB server port.")
+    parser.add_argument("--timeout", type=float, default=5.0, help="The reply timeout in seconds.")
+    parser.add_argument("--no-ack", action="store_true", help="Use the no-acknowledgement mode.")
+    parser.add_argument("--udp", action="store_true", help="Use the UDP transport (see USE_NETWORK_GDB_UDP).")
+    parser.add_argument("--serial", help="Use a serial port instead, e.g. the USB CDC interface of the probe.")
+    parser.add_argument(
+        "--retransmit-timeout", type=float, default=0.2, help="The UDP retransmission timeout in seconds."
+    )
+    parser.add_argument(
+        "--scenario", action="append", choices=ALL_SCENARIOS, help="A scenario to run. Default: all of them."
+    )
+    parser.add_argument("--attach", type=int, default=1, help="The target number to attach to. Negative: none.")
+    parser.add_argument("--count", type=int, default=200, help="The number of requests per scenario and size.")
+    parser.add_argument("--sizes", type=int, nargs="+", default=[4, 64, 256, 1024], help="Read/write sizes in bytes.")
+    parser.add_argument("--ram-address", type=lambda x: int(x, 0), default=0x20000000, help="Target RAM address.")
+    parser.add_argument("--dump-address", type=lambda x: int(x, 0), default=0x08000000, help="The dump address.")
+    parser.add_argument("--dump-length", type=int, default=256 * 1024, help="The dump length in bytes.")
+    parser.add_argument("--dump-chunk", type=int, default=1024, help="The 'm' read length of the dump in bytes.")
+    parser.add_argument("--flash-address", type=lambda x: int(x, 0), default=0x08000000, help="Target flash address.")
+    parser.add_argument("--flash-length", type=int, default=64 * 1024, help="The flash image length in bytes.")
+    parser.add_argument("--flash-chunk", type=int, default=1024, help="The 'vFlashWrite' payload length in bytes.")
+    parser.add_argument("--monitor-command", default="version", help="The monitor command for the rcmd scenario.")
+    parser.add_argument("--churn-count", type=int, default=20, help="The number of connections to churn through.")
+    parser.add_argument("--churn-delay", type=float, default=0.05, help="The delay between connections in seconds.")
+    parser.add_argument("--json", action="store_true", help="Print machine-readable results.")
+    parser.add_argument("--compare", type=argparse.FileType("r"), help="Compare to results saved with --json.")
+
+    arguments = parser.parse_args()
+
+    if arguments.attach < 0:
+        arguments.attach = None
+
+    if not arguments.scenario:
+        arguments.scenario = ALL_SCENARIOS
+
+    return arguments
+
+
+def main() -> int:
+    arguments = parse_arguments()
+    results = []
+
+    try:
+        client = connect(arguments)
+
+        for scenario in arguments.scenario:
+            if scenario == "read":
+                results += scenario_read(client, arguments)
+            elif scenario == "write":
+                results += scenario_write(client, arguments)
+            elif scenario == "dump":
+                results += scenario_dump(client, arguments)
+            elif scenario == "flash":
+                results += scenario_flash(client, arguments)
+            elif scenario == "rcmd":
+                results += scenario_rcmd(client, arguments)
+            elif scenario == "step":
+                results += scenario_step(client, arguments)
+
+            if results:
+                results[-1].retransmits = client.retransmits
+                client.retransmits = 0
+
+        if arguments.attach is not None:
+            client.request(b"D", b"OK")
+
+        client.close()
+
+        if "churn" in arguments.scenario:
+            # Give the server time to release the session.
+            time.sleep(arguments.churn_delay)
+            results += scenario_churn(arguments)
+
+    except (OSError, RspError) as error:
+        print(f"Benchmark failed: {error}", file=sys.stderr)
+        return 1
+
+    if arguments.json:
+        print(json.dumps([statistics.as_dict() for statistics in results], indent=2))
+    else:
+        print_results(results)
+
+    if arguments.compare:
+        print()
+        print_comparison(results, json.load(arguments.compare))
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
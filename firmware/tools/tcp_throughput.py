@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""Measure the sustained TCP throughput of the probe's network stack.
+
+Talks to the benchmark service of the probe (build with "make USE_NETWORK_BENCHMARK=yes"), which sends data until
+the client disconnects (download), or discards everything that it receives (upload). Use it to compare network
+profiles ("make USE_NETWORK_PROFILE=bulk") and build options, with --json and --compare.
+
+Examples:
+    ./tcp_throughput.py --host net-bmp
+    ./tcp_throughput.py --host net-bmp --direction up --duration 10
+    ./tcp_throughput.py --json > default.json
+    ./tcp_throughput.py --compare default.json
+"""
+
+import argparse
+import json
+import socket
+import sys
+import time
+
+DEFAULT_HOST = "net-bmp"
+DEFAULT_PORT = 2003
+
+MODE_SOURCE = b"S"
+MODE_DISCARD = b"D"
+
+CHUNK_LENGTH = 65536
+
+
+def measure(host: str, port: int, direction: str, duration: float, timeout: float) -> dict:
+    """Transfer data in one direction for a duration, and return the throughput."""
+    with socket.create_connection((host, port), timeout=timeout) as connection:
+        connection.sendall(MODE_SOURCE if direction == "down" else MODE_DISCARD)
+
+        data = bytes(CHUNK_LENGTH)
+        transferred = 0
+        start = time.perf_counter()
+        stop = start + duration
+
+        while time.perf_counter() < stop:
+            if direction == "down":
+                chunk = connection.recv(CHUNK_LENGTH)
+
+                if not chunk:
+                    raise ConnectionError("Connection closed by the probe.")
+
+                transferred += len(chunk)
+            else:
+                transferred += connection.send(data)
+
+        elapsed = time.perf_counter() - start
+
+    return {
+        "direction": direction,
+        "bytes": transferred,
+        "duration_s": elapsed,
+        "throughput_kib_s": transferred / 1024.0 / elapsed,
+    }
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default=DEFAULT_HOST, help="The probe host name or address.")
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT, help="The benchmark TCP port.")
+    parser.add_argument(
+        "--direction", choices=["down", "up", "both"], default="both", help="down: probe to host, up: host to probe."
+    )
+    parser.add_argument("--duration", type=float, default=5.0, help="The duration per direction in seconds.")
+    parser.add_argument("--timeout", type=float, default=5.0, help="The connection timeout in seconds.")
+    parser.add_argument("--json", action="store_true", help="Print machine-readable results.")
+    parser.add_argument("--compare", type=argparse.FileType("r"), help="Compare to results saved with --json.")
+    arguments = parser.parse_args()
+
+    directions = ["down", "up"] if arguments.direction == "both" else [arguments.direction]
+    results = []
+
+    try:
+        for direction in directions:
+            results.append(measure(arguments.host, arguments.port, direction, arguments.duration, arguments.timeout))
+    except OSError as error:
+        print(f"Benchmark failed: {error}", file=sys.stderr)
+        return 1
+
+    if arguments.json:
+        print(json.dumps(results, indent=2))
+        return 0
+
+    baseline = {entry["direction"]: entry for entry in json.load(arguments.compare)} if arguments.compare else {}
+
+    print(f"{'direction':<10} {'KiB/s':>10} {'base KiB/s':>11} {'change':>8}")
+
+    for result in results:
+        entry = baseline.get(result["direction"])
+        line = f"{result['direction']:<10} {result['throughput_kib_s']:>10.1f}"
+
+        if entry:
+            change = 100.0 * (result["throughput_kib_s"] - entry["throughput_kib_s"]) / entry["throughput_kib_s"]
+            line += f" {entry['throughput_kib_s']:>11.1f} {change:>+7.1f}%"
+
+        print(line)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
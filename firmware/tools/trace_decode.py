@@ -0,0 +1,236 @@
+#!/usr/bin/env python3
+"""Receive and decode the event trace of the probe.
+
+The probe streams its event trace on a TCP port, and on the trace capture interface of its USB device (--usb, which
+requires pyusb): a header, followed by the post-mortem trace of the last halt (if any), and then live events. See
+source/network/network_trace.h for the stream layout. Event names are read from source/trace/trace.h, so that they
+always match the firmware.
+
+Examples:
+    ./trace_decode.py --host net-bmp
+    ./trace_decode.py --host net-bmp --save capture.bin
+    ./trace_decode.py --file capture.bin
+    ./trace_decode.py --usb
+"""
+
+import argparse
+import pathlib
+import re
+import socket
+import struct
+import sys
+
+DEFAULT_HOST = "net-bmp"
+DEFAULT_PORT = 2002
+
+TRACE_MAGIC = 0x45435254  # "TRCE"
+TRACE_VERSION = 1
+
+HEADER_FORMAT = "<IHHI"
+SECTION_FORMAT = "<II"
+EVENT_FORMAT = "<IIIII"
+
+# The USB device, and its trace capture interface (see source/usb_cdc/usb_trace.h).
+USB_VENDOR_ID = 0x0483
+USB_PRODUCT_ID = 0x5740
+USB_TRACE_INTERFACE = 2
+USB_TRACE_ENDPOINT = 0x83
+USB_TRACE_REQUEST_START = 0x01
+USB_TRACE_REQUEST_STOP = 0x02
+USB_TRACE_READ_LENGTH = 16384
+USB_TRACE_DRAIN_TIMEOUT_MS = 100
+
+SECTION_EVENTS = 1
+SECTION_LOST = 2
+SECTION_POST_MORTEM_REASON = 3
+SECTION_POST_MORTEM_EVENTS = 4
+
+TRACE_HEADER_PATH = pathlib.Path(__file__).resolve().parent.parent / "source" / "trace" / "trace.h"
+
+
+def load_event_names(path: pathlib.Path) -> list:
+    """Read the event names from the trace_id enumeration of the firmware."""
+    match = re.search(r"enum\s+trace_id\s*\{(.*?)\};", path.read_text(), re.DOTALL)
+
+    if match is None:
+        raise ValueError(f"No trace_id enumeration in {path}.")
+
+    return [name.lower() for name in re.findall(r"^\s*TRACE_ID_(\w+)\s*,", match.group(1), re.MULTILINE)]
+
+
+class UsbSource:
+    """Reads the trace stream from the trace capture interface of the USB device."""
+
+    def __init__(self):
+        import usb.core  # pylint: disable=import-outside-toplevel
+        import usb.util  # pylint: disable=import-outside-toplevel
+
+        self.usb = usb
+        self.buffer = bytearray()
+        self.device = usb.core.find(idVendor=USB_VENDOR_ID, idProduct=USB_PRODUCT_ID)
+
+        if self.device is None:
+            raise OSError("No probe found on USB.")
+
+        usb.util.claim_interface(self.device, USB_TRACE_INTERFACE)
+
+        # Drop the rest of an earlier stream, such that the new one starts with its header.
+        self._request(USB_TRACE_REQUEST_STOP)
+
+        try:
+            while True:
+                self.device.read(USB_TRACE_ENDPOINT, USB_TRACE_READ_LENGTH, USB_TRACE_DRAIN_TIMEOUT_MS)
+        except usb.core.USBTimeoutError:
+            pass
+
+        self._request(USB_TRACE_REQUEST_START)
+
+    def _request(self, request: int):
+        # Vendor request to the interface, without data.
+        self.device.ctrl_transfer(0x41, request, 0, USB_TRACE_INTERFACE)
+
+    def read(self, length: int) -> bytes:
+        # Transfers do not follow the section boundaries, so they are buffered.
+        while not self.buffer:
+            self.buffer += self.device.read(USB_TRACE_ENDPOINT, USB_TRACE_READ_LENGTH, 0)
+
+        data = bytes(self.buffer[:length])
+        del self.buffer[:length]
+        return data
+
+    def close(self):
+        self._request(USB_TRACE_REQUEST_STOP)
+        self.usb.util.release_interface(self.device, USB_TRACE_INTERFACE)
+
+
+class Stream:
+    """Reads exact amounts of data from a socket or file, and optionally saves all of it."""
+
+    def __init__(self, source, save_file=None):
+        self.source = source
+        self.save_file = save_file
+
+    def read(self, length: int) -> bytes:
+        data = b""
+
+        while len(data) < length:
+            if isinstance(self.source, socket.socket):
+                chunk = self.source.recv(length - len(data))
+            else:
+                chunk = self.source.read(length - len(data))
+
+            if not chunk:
+                raise EOFError
+
+            data += chunk
+
+        if self.save_file is not None:
+            self.save_file.write(data)
+            self.save_file.flush()
+
+        return data
+
+
+class Decoder:
+    """Prints trace events with time stamps relative to the first one."""
+
+    def __init__(self, event_names: list, frequency: int):
+        self.event_names = event_names
+        self.frequency = frequency
+        self.first_timestamp = None
+        self.previous_timestamp = None
+
+    def print_events(self, data: bytes, event_size: int):
+        for offset in range(0, len(data) - event_size + 1, event_size):
+            sequence, timestamp, event_id, arg0, arg1 = struct.unpack_from(EVENT_FORMAT, data, offset)
+
+            if self.first_timestamp is None:
+                self.first_timestamp = timestamp
+                self.previous_timestamp = timestamp
+
+            # The counter wraps after 2^32 cycles.
+            time_us = ((timestamp - self.first_timestamp) & 0xFFFFFFFF) * 1e6 / self.frequency
+            delta_us = ((timestamp - self.previous_timestamp) & 0xFFFFFFFF) * 1e6 / self.frequency
+            self.previous_timestamp = timestamp
+
+            name = self.event_names[event_id] if event_id < len(self.event_names) else f"id{event_id}"
+            print(f"{sequence - 1:>10} {time_us:>14.2f} {delta_us:>+12.2f}  {name:<18} {arg0:#010x} {arg1:#010x}")
+
+    def restart(self):
+        """Start relative time stamps anew, e.g. after the post-mortem trace."""
+        self.first_timestamp = None
+        self.previous_timestamp = None
+
+
+def decode(stream: Stream, event_names: list):
+    """Decode a trace stream until it ends."""
+    magic, version, event_size, frequency = struct.unpack(HEADER_FORMAT, stream.read(struct.calcsize(HEADER_FORMAT)))
+
+    if (magic != TRACE_MAGIC) or (version != TRACE_VERSION) or (event_size < struct.calcsize(EVENT_FORMAT)):
+        raise ValueError(f"Unsupported trace stream (magic {magic:#x}, version {version}).")
+
+    decoder = Decoder(event_names, frequency)
+
+    print(f"{'index':>10} {'time us':>14} {'delta us':>12}  {'event':<18} {'arg0':>10} {'arg1':>10}")
+
+    while True:
+        section_type, length = struct.unpack(SECTION_FORMAT, stream.read(struct.calcsize(SECTION_FORMAT)))
+        content = stream.read(length)
+
+        if section_type == SECTION_EVENTS:
+            decoder.print_events(content, event_size)
+        elif section_type == SECTION_LOST:
+            print(f"--- {struct.unpack('<I', content)[0]} events lost")
+        elif section_type == SECTION_POST_MORTEM_REASON:
+            print(f"--- post-mortem trace, halt reason: {content.decode(errors='replace')}")
+        elif section_type == SECTION_POST_MORTEM_EVENTS:
+            decoder.print_events(content, event_size)
+            decoder.restart()
+            print("--- live trace")
+        else:
+            print(f"--- unknown section type {section_type}, {length} bytes")
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default=DEFAULT_HOST, help="The probe host name or address.")
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT, help="The trace TCP port.")
+    parser.add_argument("--file", type=pathlib.Path, help="Decode a saved capture, instead of connecting.")
+    parser.add_argument("--usb", action="store_true", help="Read the trace from the USB device of the probe.")
+    parser.add_argument("--save", type=pathlib.Path, help="Save the raw stream to this file.")
+    parser.add_argument("--header", type=pathlib.Path, default=TRACE_HEADER_PATH, help="The firmware trace header.")
+    arguments = parser.parse_args()
+
+    event_names = load_event_names(arguments.header)
+    save_file = open(arguments.save, "wb") if arguments.save else None
+
+    try:
+        if arguments.file:
+            with open(arguments.file, "rb") as capture_file:
+                decode(Stream(capture_file), event_names)
+        elif arguments.usb:
+            usb_source = UsbSource()
+
+            try:
+                decode(Stream(usb_source, save_file), event_names)
+            finally:
+                usb_source.close()
+        else:
+            with socket.create_connection((arguments.host, arguments.port)) as trace_socket:
+                decode(Stream(trace_socket, save_file), event_names)
+    except EOFError:
+        return 0
+    except KeyboardInterrupt:
+        return 0
+    except (ImportError, OSError, ValueError) as error:
+        print(f"Failed to decode the trace: {error}", file=sys.stderr)
+        return 1
+    finally:
+        if save_file is not None:
+            save_file.close()
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())